@@ -23,6 +23,9 @@ Data Stack size         : 256
 
 // #define SENDER 1
 #define RECEIVER 1
+// #define LATENCY 1 //receiver that compares latency of interrupt and polled RX paths, use with SENDER
+// #define BENCH 1 //sweep of nRF24L01p_bench.c, one result line per case on the uart, use with REFLECTOR
+// #define REFLECTOR 1 //other side of BENCH
 
 #include <mega88a.h>
 #include <stdio.h>
@@ -30,18 +33,47 @@ Data Stack size         : 256
 #include <delay.h>
 #include "nRF24L01p.h"
 #include <string.h>
+#if defined BENCH || defined REFLECTOR
+#include "nRF24L01p_bench.h" //add nRF24L01p_bench.c to the project
+#endif
 
 char data[32] = {0};
 char receiveData[32] = {0};
 int i=0;
 char t1;
 unsigned char receiveCounter = 0;
+unsigned int lastCount = 0;
+
+void onReceive(NRF24_Event *event);
+
+#ifdef LATENCY
+#define LATENCY_SAMPLES 1000 //number of packets measured on each path
+#define LATENCY_BUCKETS 64 //histogram buckets of 4us, last one counts everything above
+unsigned int irqHistogram[LATENCY_BUCKETS] = {0};
+unsigned int pollHistogram[LATENCY_BUCKETS] = {0};
+unsigned int latencyCount = 0;
+
+void onLatencyReceive(NRF24_Event *event);
+void addLatencySample(unsigned int ticks, unsigned int *histogram);
+void printHistogram(char *name, unsigned int *histogram);
+#endif
+
+#if defined BENCH || defined REFLECTOR
+unsigned int clockHigh = 0; //Timer1 overflows, high word of us clock
+NRF24_BenchCase benchCase;
+NRF24_BenchResult benchResult;
+NRF24_BenchReflector reflector;
+char line[NRF24_BENCH_LINE];
+unsigned char benchIndex;
+
+void startClock();
+unsigned long microseconds();
+#endif
 
 void main(void)
 {
 // Declare your local variables here
 unsigned int count = 0;
-unsigned int lastCount = 0;
 // Crystal Oscillator division factor: 1
 #pragma optsize-
 CLKPR=(1<<CLKPCE);
@@ -117,52 +149,191 @@ SPSR=(1<<SPI2X);
 		data[0] = count;
 		data[1] = count>>8;
 		
-		//send the packet over the air
-		sendData(data, 32);
+		//queue the packet, TX queue is full while txEnqueue returns 0
+		if(txEnqueue(data, 32)==0)
+			continue;
 		
 		PORTD.2=~PORTD.2;
 		
-		//wait till every thing is stable
-		delay_us(600);
-		
 		//increment counter
 		count++;
 	}
 #elif RECEIVER
 	nRF_Config(NRF24_RECEIVER); //set module as receiver
+	setEventCallback(NRF24_EVENT_RX_READY, onReceive); //onReceive is called for every received packet
 	#asm("sei")
 	while (1)
 	{
-		//how many bytes are available?
-		t1 = bytesAvailable(); 
+		//sleep till IRQ of nrf24 wakes the MCU up
+		#asm("cli")
+		if(eventsPending()==0){
+			SMCR=(0<<SM2) | (0<<SM1) | (0<<SM0) | (1<<SE); //idle mode, UART keeps running
+			#asm("sei")
+			#asm("sleep")
+			SMCR=0;
+		}
+		#asm("sei")
 		
-		if(t1 > 0) //is there any data?
+		//dispatch received packets to onReceive
+		serviceEvents();
+	}
+#elif LATENCY
+	// Timer/Counter 1 initialization
+	// Clock value: 8000.000 kHz
+	// Input Capture on Falling Edge of ICP1 (PB0), that is IRQ of nrf24
+	// Input Capture Noise Canceler: Off
+	TCCR1A=(0<<COM1A1) | (0<<COM1A0) | (0<<COM1B1) | (0<<COM1B0) | (0<<WGM11) | (0<<WGM10);
+	TCCR1B=(0<<ICNC1) | (0<<ICES1) | (0<<WGM13) | (0<<WGM12) | (0<<CS12) | (0<<CS11) | (1<<CS10);
+	
+	nRF_Config(NRF24_RECEIVER); //set module as receiver
+	setEventCallback(NRF24_EVENT_RX_READY, onLatencyReceive);
+	#asm("sei")
+	
+	//interrupt path: ISR reads the packet, callback gets it from serviceEvents
+	while(latencyCount<LATENCY_SAMPLES)
+		serviceEvents();
+	
+	//polled path: packet is read straight into receiveData
+	setPolledMode(1);
+	latencyCount = 0;
+	while(latencyCount<LATENCY_SAMPLES)
+	{
+		if(pollReceive(receiveData, NULL)>0)
+			addLatencySample(TCNT1-ICR1, pollHistogram);
+	}
+	
+	//send both distributions to the uart, one "path,us,count" line per bucket
+	printHistogram("irq", irqHistogram);
+	printHistogram("poll", pollHistogram);
+	while (1);
+#elif BENCH
+	startClock();
+	nRF_Config(NRF24_TRANSMITTER); //set module as initiator
+	benchInit(NRF24_TRANSMITTER);
+	#asm("sei")
+	
+	//header, one "bench,..." line per case ("failed,case" if reflector has not answered) and "done"
+	putsf(NRF24_BENCH_HEADER "\r");
+	for(benchIndex=0;benchIndex<benchCaseCount();benchIndex++)
+	{
+		benchGetCase(benchIndex, &benchCase);
+		if(benchRun(&benchCase, &benchResult)==1)
+		{
+			benchFormat(&benchResult, line);
+			printf("%s\r\n", line);
+		}
+		else
+		{
+			printf("failed,%u\r\n", benchIndex);
+			PORTD.2 = 1;
+		}
+	}
+	putsf("done\r");
+	while (1);
+#elif REFLECTOR
+	startClock();
+	nRF_Config(NRF24_RECEIVER); //set module as reflector
+	benchInit(NRF24_RECEIVER);
+	#asm("sei")
+	while (1)
+		benchReflect(&reflector);
+#endif
+
+}
+
+#ifdef RECEIVER
+void onReceive(NRF24_Event *event)
+{
+	unsigned int count = 0;
+	
+	//read data from buffer and copy into receiveData
+	readRxFIFO(receiveData, event->length);
+	
+	//what is the count value that is sent
+	count = ((unsigned int)receiveData[0])+( ((unsigned int)receiveData[1])<<8);
+	
+	//if any packet is not lost, lastCount = count-1
+	if(count-lastCount != 1){
+		PORTD.2 = ~PORTD.2;
+	}
+	
+	//store current count value
+	lastCount=count; 
+	
+	//send count value to the uart
+	sprintf(data, "%d\r",count);
+	puts(data);
+	
+	//number of bytes received over the air
+	receiveCounter++;
+	if(receiveCounter==0) //overflow of receive packet counter
+		PORTD.4=~PORTD.4;
+}
+#endif
+
+#ifdef LATENCY
+void onLatencyReceive(NRF24_Event *event)
+{
+	unsigned int ticks = TCNT1-ICR1; //time since falling edge of IRQ, 0.125us per tick
+	
+	readRxFIFO(receiveData, event->length);
+	addLatencySample(ticks, irqHistogram);
+}
+
+void addLatencySample(unsigned int ticks, unsigned int *histogram)
+{
+	unsigned int bucket = ticks/32; //4us per bucket
+	
+	if(bucket>=LATENCY_BUCKETS)
+		bucket = LATENCY_BUCKETS-1;
+	histogram[bucket]++;
+	latencyCount++;
+}
+
+void printHistogram(char *name, unsigned int *histogram)
+{
+	unsigned char b;
+	
+	for(b=0;b<LATENCY_BUCKETS;b++)
+	{
+		if(histogram[b]>0)
 		{
-			//read data from buffer and copy into receiveData
-			readRxFIFO(receiveData, t1);
-			
-			//what is the count value that is sent
-			count = ((unsigned int)receiveData[0])+( ((unsigned int)receiveData[1])<<8);
-			
-			//if any packet is not lost, lastCount = count-1
-			if(count-lastCount != 1){
-				PORTD.2 = ~PORTD.2;
-			}
-			
-			//store current count value
-			lastCount=count; 
-			
-			//send count value to the uart
-			sprintf(data, "%d\r",count);
+			sprintf(data, "%s,%u,%u\r", name, b*4, histogram[b]);
 			puts(data);
-			
-			//number of bytes received over the air
-			receiveCounter++;
-			if(receiveCounter==0) //overflow of receive packet counter
-				PORTD.4=~PORTD.4;
-			
 		}
 	}
+}
 #endif
 
+#if defined BENCH || defined REFLECTOR
+void startClock()
+{
+	// Timer/Counter 1 initialization
+	// Clock value: 1000.000 kHz, 1us per tick
+	// Timer1 Overflow Interrupt: On, counts high word of the clock
+	TCCR1A=(0<<COM1A1) | (0<<COM1A0) | (0<<COM1B1) | (0<<COM1B0) | (0<<WGM11) | (0<<WGM10);
+	TCCR1B=(0<<ICNC1) | (0<<ICES1) | (0<<WGM13) | (0<<WGM12) | (0<<CS12) | (1<<CS11) | (0<<CS10);
+	TIMSK1=(0<<ICIE1) | (0<<OCIE1B) | (0<<OCIE1A) | (1<<TOIE1);
+	setTimestampSource(microseconds); //nRF24L01p_bench.c measures time by getTimestamp()
 }
+
+interrupt [TIM1_OVF] void timer1_ovf_isr(void)
+{
+	clockHigh++;
+}
+
+unsigned long microseconds()
+{
+	unsigned char sreg = SREG;
+	unsigned int high;
+	unsigned int low;
+	
+	#asm("cli")
+	low = TCNT1;
+	high = clockHigh;
+	if((TIFR1 & (1<<TOV1)) && low<0x8000) //overflow after cli, its interrupt has not run yet
+		high++;
+	SREG = sreg;
+	return ((unsigned long)high<<16) | low;
+}
+#endif
@@ -0,0 +1,74 @@
+/*******************************************************
+Host run of link benchmark (nRF24L01p_bench.c)
+
+Build   : sh nRF24L01p_host.sh TestBenchHost 2 nRF24L01p_bench.c
+Run     : ./TestBenchHost > bench.csv
+Comments: Runs the sweep of TestAtmega88.c (BENCH and
+          REFLECTOR) on two simulated nodes, each one with
+          its own copy of nRF24L01p.c and nRF24L01p_bench.c
+          on a radio of nRF24L01p_sim.c. 1% of frames are
+          lost on top of collisions. Lines have the same
+          format as on the UART, so a change of the driver
+          can be compared with the results before it.
+*******************************************************/
+
+#include <stdio.h>
+#include "nRF24L01p_sim.h"
+
+#ifdef HOST_NODE
+#include "nRF24L01p_bench.h"
+
+NRF24_BenchCase benchCase;
+NRF24_BenchResult benchResult;
+NRF24_BenchReflector reflector;
+char line[NRF24_BENCH_LINE];
+
+/*
+ * main() of TestAtmega88.c, BENCH on node 0 and REFLECTOR on node 1
+ */
+void hostMain(int arg)
+{
+	unsigned char index;
+
+	setTimestampSource(hostMicros); //startClock()
+	if(arg==0)
+	{
+		nRF_Config(NRF24_TRANSMITTER);
+		benchInit(NRF24_TRANSMITTER);
+		hostSei();
+
+		puts(NRF24_BENCH_HEADER);
+		for(index=0;index<benchCaseCount();index++)
+		{
+			benchGetCase(index, &benchCase);
+			if(benchRun(&benchCase, &benchResult)==1)
+			{
+				benchFormat(&benchResult, line);
+				puts(line);
+			}
+			else
+				printf("failed,%u\n", index);
+		}
+		puts("done");
+		simStop();
+	}
+	else
+	{
+		nRF_Config(NRF24_RECEIVER);
+		benchInit(NRF24_RECEIVER);
+		hostSei();
+		while(1)
+			benchReflect(&reflector);
+	}
+}
+#else
+int main(void)
+{
+	simInit(1);
+	simSetLoss(0.01);
+	simAddNode(simEntries[0], 0);
+	simAddNode(simEntries[1], 1);
+	simRun(NRF24_SIM_NEVER);
+	return 0;
+}
+#endif
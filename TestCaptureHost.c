@@ -0,0 +1,292 @@
+/*******************************************************
+Host check and benchmark of packet capture (nRF24L01p_capture.c)
+
+Build   : gcc -O2 -I. -o TestCaptureHost TestCaptureHost.c nRF24L01p_capture.c nRF24L01p_spidev.c nRF24L01p_emu.c -lpthread
+Run     : ./TestCaptureHost [name]
+Comments: Captures packets injected into an emulated chip,
+          as receiver and in promiscuous mode, reads each pcap
+          file back and checks every record. Then keeps RX
+          FIFO full for one second and prints records/s
+          written to /dev/null against line rate of 2Mbps.
+          With name the checked captures are kept in
+          name.pcap and name-raw.pcap, e.g. for tcpdump -r.
+*******************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include "nRF24L01p_capture.h"
+#include "nRF24L01p_emu.h"
+
+#define CHECK_PACKETS 1000
+#define RUN_TIME 1 //seconds of benchmark
+
+NRF24_EmuChip chip;
+NRF24_Spidev radio;
+bool feeding;
+
+int check(char *path, bool promiscuous);
+unsigned long capturePackets(char *path, bool promiscuous);
+int verify(char *path, bool promiscuous);
+void makePacket(unsigned long count, unsigned char *data, unsigned char *size, unsigned char *pipe);
+void benchmark(void);
+void *feed(void *arg);
+unsigned long get32(unsigned char *in);
+
+int main(int argc, char **argv)
+{
+	char path[2][256] = {"/tmp/TestCaptureHostXXXXXX", "/tmp/TestCaptureHostXXXXXX"};
+	int result;
+
+	emuStart(&chip);
+	spidevAttach(&radio, emuSpiFd(&chip), emuIrqFd(&chip));
+
+	if(argc>1)
+	{
+		snprintf(path[0], sizeof(path[0]), "%s.pcap", argv[1]);
+		snprintf(path[1], sizeof(path[1]), "%s-raw.pcap", argv[1]);
+	}
+	else
+	{
+		close(mkstemp(path[0]));
+		close(mkstemp(path[1]));
+	}
+	result = check(path[0], 0) || check(path[1], 1);
+	if(argc<=1)
+	{
+		unlink(path[0]);
+		unlink(path[1]);
+	}
+	if(result==0)
+		benchmark();
+
+	spidevClose(&radio);
+	emuStop(&chip);
+	return result;
+}
+
+/*
+ * captures CHECK_PACKETS into path and checks the file
+ */
+int check(char *path, bool promiscuous)
+{
+	unsigned long written = capturePackets(path, promiscuous);
+
+	if(written!=CHECK_PACKETS)
+		return 1;
+	return verify(path, promiscuous);
+}
+
+/*
+ * receiver at 2Mbps without RPD, or promiscuous at 250Kbps with RPD
+ */
+unsigned long capturePackets(char *path, bool promiscuous)
+{
+	NRF24_Capture capture;
+	NRF24_CaptureStats stats;
+	unsigned char data[32];
+	unsigned char size;
+	unsigned char pipe;
+	unsigned long i;
+	int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	if(fd<0)
+	{
+		printf("cannot open %s\n", path);
+		return 0;
+	}
+	if(promiscuous)
+		spidevConfigPromiscuous(&radio, 2, NRF24_250Kbps);
+	else
+		spidevConfig(&radio, NRF24_RECEIVER, 76, NRF24_2Mbps);
+	pthread_mutex_lock(&chip.lock);
+	chip.reg[0x09] = promiscuous; //RPD
+	pthread_mutex_unlock(&chip.lock);
+
+	captureStart(&capture, &radio, fd);
+	for(i=0;i<CHECK_PACKETS;i++)
+	{
+		makePacket(i, data, &size, &pipe);
+		if(promiscuous)
+		{
+			size = 32; //static width
+			pipe %= 2;
+		}
+		while(emuInject(&chip, pipe, data, size)==0)
+			sched_yield(); //RX FIFO is full
+	}
+	do
+	{
+		sched_yield();
+		captureGetStats(&capture, &stats);
+	}
+	while(stats.captured<CHECK_PACKETS);
+	captureStop(&capture);
+	close(fd);
+
+	captureGetStats(&capture, &stats);
+	printf("%s: captured %lu, dropped %lu, written %lu, %llu bytes\n", promiscuous ? "promiscuous" : "receiver",
+		stats.captured, stats.dropped, stats.written, stats.bytes);
+	return stats.written;
+}
+
+/*
+ * reads the pcap file and compares every record with the packet it was made from
+ */
+int verify(char *path, bool promiscuous)
+{
+	FILE *file = fopen(path, "rb");
+	unsigned char *buffer = malloc(NRF24_CAPTURE_FILE_HEADER + CHECK_PACKETS*NRF24_CAPTURE_RECORD_MAX);
+	unsigned char data[32];
+	unsigned char size;
+	unsigned char pipe;
+	unsigned char flags;
+	unsigned char i;
+	unsigned long long time;
+	unsigned long long last = 0;
+	unsigned long length;
+	unsigned long position = 0;
+	unsigned long record;
+	bool raw = promiscuous;
+	int errors = 0;
+
+	length = fread(buffer, 1, NRF24_CAPTURE_FILE_HEADER + CHECK_PACKETS*NRF24_CAPTURE_RECORD_MAX, file);
+	fclose(file);
+
+	if(length<NRF24_CAPTURE_FILE_HEADER || get32(&buffer[0])!=0xA1B23C4DUL || buffer[4]!=2 || buffer[6]!=4 ||
+		get32(&buffer[16])!=NRF24_CAPTURE_HEADER+32 || get32(&buffer[20])!=NRF24_CAPTURE_LINKTYPE)
+	{
+		printf("bad file header\n");
+		free(buffer);
+		return 1;
+	}
+	position = NRF24_CAPTURE_FILE_HEADER;
+
+	for(record=0;record<CHECK_PACKETS;record++)
+	{
+		makePacket(record, data, &size, &pipe);
+		if(raw)
+		{
+			size = 32;
+			pipe %= 2;
+		}
+		flags = raw ? (NRF24_CAPTURE_RAW | NRF24_CAPTURE_RPD | NRF24_250Kbps) : NRF24_2Mbps;
+		if(position+NRF24_CAPTURE_RECORD_HEADER+NRF24_CAPTURE_HEADER+size>length)
+		{
+			printf("file ends at record %lu\n", record);
+			errors++;
+			break;
+		}
+
+		time = get32(&buffer[position])*1000000000ULL + get32(&buffer[position+4]);
+		if(time<last || get32(&buffer[position+4])>=1000000000UL)
+			errors++;
+		last = time;
+		if(get32(&buffer[position+8])!=(unsigned long)NRF24_CAPTURE_HEADER+size || get32(&buffer[position+12])!=(unsigned long)NRF24_CAPTURE_HEADER+size)
+		{
+			printf("record %lu: length %lu, expected %d\n", record, get32(&buffer[position+8]), NRF24_CAPTURE_HEADER+size);
+			errors++;
+			break;
+		}
+		position += NRF24_CAPTURE_RECORD_HEADER;
+		if(buffer[position]!=NRF24_CAPTURE_VERSION || buffer[position+1]!=(raw ? 2 : 76) || buffer[position+2]!=pipe ||
+			buffer[position+3]!=flags)
+		{
+			printf("record %lu: pseudo header %02X %02X %02X %02X\n", record, buffer[position], buffer[position+1],
+				buffer[position+2], buffer[position+3]);
+			errors++;
+		}
+		position += NRF24_CAPTURE_HEADER;
+		for(i=0;i<size;i++) //raw records in the order on air, others in the order of sendData()
+			if(buffer[position+i]!=(raw ? data[i] : data[size-1-i]))
+				break;
+		if(i<size)
+		{
+			printf("record %lu: payload differs at byte %d\n", record, i);
+			errors++;
+		}
+		position += size;
+	}
+	if(position!=length)
+		errors++;
+	free(buffer);
+
+	printf("checked %lu records, %lu bytes, errors %d\n", record, length, errors);
+	return errors!=0;
+}
+
+/*
+ * packet count: 1 to 32 byte on pipes 0 to 5, bytes in the order read by R_RX_PAYLOAD
+ */
+void makePacket(unsigned long count, unsigned char *data, unsigned char *size, unsigned char *pipe)
+{
+	unsigned char i;
+
+	*size = count%32 + 1;
+	*pipe = count%6;
+	for(i=0;i<32;i++)
+		data[i] = (unsigned char)(count*7 + i);
+}
+
+/*
+ * records/s with RX FIFO always full, written to /dev/null
+ */
+void benchmark(void)
+{
+	NRF24_Capture capture;
+	NRF24_CaptureStats stats;
+	pthread_t feeder;
+	struct timespec wait;
+	int fd = open("/dev/null", O_WRONLY);
+
+	spidevConfig(&radio, NRF24_RECEIVER, 76, NRF24_2Mbps);
+	__atomic_store_n(&feeding, 1, __ATOMIC_RELAXED);
+	pthread_create(&feeder, NULL, feed, NULL);
+	captureStart(&capture, &radio, fd);
+
+	wait.tv_sec = RUN_TIME;
+	wait.tv_nsec = 0;
+	nanosleep(&wait, NULL);
+	captureGetStats(&capture, &stats);
+
+	__atomic_store_n(&feeding, 0, __ATOMIC_RELAXED);
+	captureStop(&capture);
+	pthread_join(feeder, NULL);
+	close(fd);
+
+	//shortest frame at 2Mbps: preamble, 5 byte address, 9 bit control field, 1 byte payload, 2 byte CRC
+	printf("cpus %ld: %lu records/s, dropped %lu, line rate of 2Mbps is at most %lu frames/s\n",
+		sysconf(_SC_NPROCESSORS_ONLN), stats.written/RUN_TIME, stats.dropped, 2000000UL/((1+5+1+2)*8+9));
+}
+
+/*
+ * keeps RX FIFO full
+ */
+void *feed(void *arg)
+{
+	unsigned char data[32];
+	unsigned long count = 0;
+
+	memset(data, 0x5A, sizeof(data));
+	while(__atomic_load_n(&feeding, __ATOMIC_RELAXED))
+	{
+		memcpy(data, &count, sizeof(count));
+		if(emuInject(&chip, 0, data, 32))
+			count++;
+		else
+			sched_yield();
+	}
+	return NULL;
+}
+
+/*
+ * reads 32 bit little endian
+ */
+unsigned long get32(unsigned char *in)
+{
+	return in[0] | (in[1]<<8) | ((unsigned long)in[2]<<16) | ((unsigned long)in[3]<<24);
+}
@@ -0,0 +1,218 @@
+/*******************************************************
+Host test of telemetry codec (nRF24L01p_codec.c)
+
+Build   : gcc -O2 -I. -o TestCodecHost TestCodecHost.c nRF24L01p_codec.c
+Run     : ./TestCodecHost
+Comments: Sends a random walk of sensor samples over a
+          link that loses packets and ACKs, at random and in
+          bursts longer than the 4 bit sequence, checks every
+          decoded record against the sent one, then prints
+          samples per payload of raw struct, text as
+          sprintf'd by TestAtmega88.c and the codec.
+*******************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <time.h>
+#include "nRF24L01p_codec.h"
+
+#define SAMPLES 100000
+#define MAX_RECORDS 64
+
+typedef struct {
+    unsigned long time; //ms
+    short temperature; //0.1 C
+    unsigned short humidity; //0.1 %
+    unsigned char battery; //%
+    unsigned char flags;
+    signed char rssi;
+} Sample;
+
+typedef struct {
+    unsigned int time;
+    short temperature;
+    unsigned short humidity;
+    unsigned char battery;
+    unsigned char flags;
+    signed char rssi;
+} __attribute__((packed)) RawSample; //what a sensor sends today, fields as on AVR
+
+flash NRF24_CodecField sampleSchema[] = {
+    {offsetof(Sample, time), NRF24_CODEC_U32 | NRF24_CODEC_DELTA, 32, 7},
+    {offsetof(Sample, temperature), NRF24_CODEC_S16 | NRF24_CODEC_DELTA, 12, 3},
+    {offsetof(Sample, humidity), NRF24_CODEC_U16 | NRF24_CODEC_DELTA, 10, 3},
+    {offsetof(Sample, battery), NRF24_CODEC_U8 | NRF24_CODEC_DELTA, 7, 1},
+    {offsetof(Sample, flags), NRF24_CODEC_U8, 4, 0},
+    {offsetof(Sample, rssi), NRF24_CODEC_S8 | NRF24_CODEC_VARINT, 0, 3}
+};
+
+Sample samples[SAMPLES];
+Sample decoded[MAX_RECORDS];
+
+void makeSamples();
+int checkLink(unsigned int packetLoss, unsigned int ackLoss, unsigned int burst);
+void compareSizes();
+double nanoseconds();
+
+int main(void)
+{
+	int failed = 0;
+
+	srand(1);
+	makeSamples();
+	printf("packet loss %%,ack loss %%,burst,packets,key packets,samples/packet,decoded,lost or not decodable,mismatches\n");
+	failed += checkLink(0, 0, 0);
+	failed += checkLink(10, 0, 0);
+	failed += checkLink(0, 10, 0);
+	failed += checkLink(10, 10, 0);
+	failed += checkLink(30, 30, 0);
+	failed += checkLink(0, 0, 16);
+	failed += checkLink(0, 0, 20);
+	failed += checkLink(10, 10, 33);
+	if(failed>0)
+	{
+		printf("%d decoded records differ from sent ones\n", failed);
+		return 1;
+	}
+	compareSizes();
+	return 0;
+}
+
+/*
+ * a sensor sampled every second
+ */
+void makeSamples()
+{
+	unsigned long i;
+	Sample s = {1000000, 215, 450, 97, 0, -60};
+
+	for(i=0;i<SAMPLES;i++)
+	{
+		s.time += 1000 + rand()%5 - 2;
+		s.temperature += rand()%3 - 1;
+		s.humidity += rand()%5 - 2;
+		if(s.temperature<-400 || s.temperature>1250) //range of the sensor, 12 bit in key packets
+			s.temperature = 215;
+		if(s.humidity>1000) //10 bit in key packets
+			s.humidity = 450;
+		if(rand()%500==0 && s.battery>0)
+			s.battery--;
+		s.flags = rand()%50==0 ? rand()%16 : 0;
+		s.rssi = -60 + rand()%9 - 4;
+		if(rand()%2000==0) //jumps, e.g. after a sensor reset
+		{
+			s.temperature = -400 + rand()%1600;
+			s.time += 3600000;
+		}
+		samples[i] = s;
+	}
+}
+
+/*
+ * sends all samples, a packet is lost with packetLoss %, its ACK with ackLoss %,
+ * every 100th packet starts burst lost packets in a row
+ */
+int checkLink(unsigned int packetLoss, unsigned int ackLoss, unsigned int burst)
+{
+	NRF24_Codec tx;
+	NRF24_Codec rx;
+	Sample txHistory[NRF24_CODEC_HISTORY];
+	Sample rxHistory[NRF24_CODEC_HISTORY];
+	char packet[32];
+	unsigned char length;
+	unsigned long sent = 0;
+	unsigned long good = 0;
+	unsigned long lost = 0;
+	int mismatches = 0;
+	unsigned char taken;
+	unsigned char count;
+	unsigned char i;
+
+	codecInit(&tx, sampleSchema, sizeof(sampleSchema)/sizeof(NRF24_CodecField), sizeof(Sample), (char*)txHistory);
+	codecInit(&rx, sampleSchema, sizeof(sampleSchema)/sizeof(NRF24_CodecField), sizeof(Sample), (char*)rxHistory);
+	while(sent<SAMPLES)
+	{
+		count = SAMPLES-sent < MAX_RECORDS ? SAMPLES-sent : MAX_RECORDS;
+		taken = codecEncode(&tx, (char*)&samples[sent], count, packet, &length);
+		if(taken==0)
+			return 1;
+
+		if((unsigned int)rand()%100 >= packetLoss && (burst==0 || (tx.packets-1)%100 >= burst))
+		{
+			count = codecDecode(&rx, packet, length, (char*)decoded, MAX_RECORDS);
+			if(count==0)
+				lost += taken;
+			for(i=0;i<count;i++)
+			{
+				if(memcmp(&decoded[i], &samples[sent+i], sizeof(Sample))!=0)
+					mismatches++;
+			}
+			good += count;
+			if((unsigned int)rand()%100 >= ackLoss)
+				codecAcked(&tx, packet);
+		}
+		else
+			lost += taken;
+		sent += taken;
+	}
+	printf("%u,%u,%u,%u,%u,%.2f,%lu,%lu,%d\n", packetLoss, ackLoss, burst, tx.packets, tx.keyPackets,
+		(double)SAMPLES/tx.packets, good, lost, mismatches);
+	return mismatches;
+}
+
+/*
+ * samples per payload and cost per sample of each format
+ */
+void compareSizes()
+{
+	NRF24_Codec tx;
+	NRF24_Codec rx;
+	Sample txHistory[NRF24_CODEC_HISTORY];
+	Sample rxHistory[NRF24_CODEC_HISTORY];
+	char packet[32];
+	char text[40];
+	unsigned char length;
+	unsigned long sent = 0;
+	unsigned long bytes = 0;
+	unsigned long textBytes = 0;
+	unsigned long i;
+	double encodeTime = 0;
+	double decodeTime = 0;
+	double start;
+	unsigned char taken;
+
+	codecInit(&tx, sampleSchema, sizeof(sampleSchema)/sizeof(NRF24_CodecField), sizeof(Sample), (char*)txHistory);
+	codecInit(&rx, sampleSchema, sizeof(sampleSchema)/sizeof(NRF24_CodecField), sizeof(Sample), (char*)rxHistory);
+	while(sent<SAMPLES)
+	{
+		start = nanoseconds();
+		taken = codecEncode(&tx, (char*)&samples[sent], SAMPLES-sent < MAX_RECORDS ? SAMPLES-sent : MAX_RECORDS, packet, &length);
+		encodeTime += nanoseconds()-start;
+		codecAcked(&tx, packet);
+		start = nanoseconds();
+		codecDecode(&rx, packet, length, (char*)decoded, MAX_RECORDS);
+		decodeTime += nanoseconds()-start;
+		bytes += length;
+		sent += taken;
+	}
+	for(i=0;i<SAMPLES;i++)
+		textBytes += sprintf(text, "%lu,%d,%u,%u,%u,%d\r", samples[i].time, samples[i].temperature,
+			samples[i].humidity, samples[i].battery, samples[i].flags, samples[i].rssi);
+
+	printf("\nformat,bytes/sample,samples/payload,packets for %d samples\n", SAMPLES);
+	printf("raw struct,%u,%u,%u\n", (unsigned int)sizeof(RawSample), (unsigned int)(32/sizeof(RawSample)),
+		(unsigned int)((SAMPLES+32/sizeof(RawSample)-1)/(32/sizeof(RawSample))));
+	printf("text,%.2f,1,%u\n", (double)textBytes/SAMPLES, SAMPLES);
+	printf("codec,%.2f,%.2f,%u\n", (double)bytes/SAMPLES, (double)SAMPLES/tx.packets, tx.packets);
+	printf("\nencode ns/sample,decode ns/sample (this PC)\n%.1f,%.1f\n", encodeTime/SAMPLES, decodeTime/SAMPLES);
+}
+
+double nanoseconds()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec*1e9 + now.tv_nsec;
+}
@@ -0,0 +1,141 @@
+/*******************************************************
+Host benchmark of FEC kernels (nRF24L01p_rs.c)
+
+Build   : gcc -O2 -I. -o TestFecHost TestFecHost.c nRF24L01p_rs.c
+Run     : ./TestFecHost
+Comments: Checks that every pattern of up to m lost data
+          packets is rebuilt, then measures encode and
+          decode cost per byte of data for a few block
+          sizes. 28 byte symbols, as sent by nRF24L01p_fec.c
+*******************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES() __rdtsc()
+#else
+#define CYCLES() 0ULL //no cycle counter, only ns are printed
+#endif
+#include "nRF24L01p_rs.h"
+
+#define SYMBOL 28
+#define MAX_SYMBOLS 16
+#define ROUNDS 20000
+
+unsigned char blockData[MAX_SYMBOLS][SYMBOL];
+unsigned char original[MAX_SYMBOLS][SYMBOL];
+unsigned char *symbols[MAX_SYMBOLS];
+
+int checkBlock(unsigned char k, unsigned char m);
+void benchmark(unsigned char k, unsigned char m);
+double nanoseconds();
+
+int main(void)
+{
+	unsigned char k[] = {4, 8, 8, 12};
+	unsigned char m[] = {1, 1, 2, 4};
+	unsigned char i;
+	int failed = 0;
+
+	for(i=0;i<MAX_SYMBOLS;i++)
+		symbols[i] = blockData[i];
+
+	for(i=0;i<sizeof(k);i++)
+		failed += checkBlock(k[i], m[i]);
+	if(failed>0)
+	{
+		printf("%d loss patterns were not rebuilt\n", failed);
+		return 1;
+	}
+
+	printf("k,m,encode cycles/byte,encode ns/byte,decode cycles/byte,decode ns/byte\n");
+	for(i=0;i<sizeof(k);i++)
+		benchmark(k[i], m[i]);
+	return 0;
+}
+
+/*
+ * tries every set of up to m lost data symbols, returns number of failures
+ */
+int checkBlock(unsigned char k, unsigned char m)
+{
+	unsigned int lost;
+	unsigned int present;
+	unsigned int bits;
+	unsigned char i;
+	int failed = 0;
+
+	for(i=0;i<k;i++)
+		for(bits=0;bits<SYMBOL;bits++)
+			blockData[i][bits] = rand();
+	rsEncode(k, m, symbols, SYMBOL);
+	memcpy(original, blockData, sizeof(blockData));
+
+	for(lost=1;lost<(1u<<k);lost++)
+	{
+		for(bits=0,i=0;i<k;i++)
+			bits += (lost>>i) & 1;
+		if(bits>m)
+			continue;
+
+		memcpy(blockData, original, sizeof(blockData));
+		for(i=0;i<k;i++)
+			if(lost & (1u<<i))
+				memset(blockData[i], 0xEE, SYMBOL);
+		present = ((1u<<(k+m))-1) & ~lost;
+
+		if(rsDecode(k, m, symbols, &present, SYMBOL)!=bits || memcmp(blockData, original, k*SYMBOL)!=0)
+			failed++;
+	}
+	return failed;
+}
+
+/*
+ * encodes blocks and rebuilds m lost data symbols of each one
+ */
+void benchmark(unsigned char k, unsigned char m)
+{
+	unsigned long long cycles;
+	unsigned int present;
+	unsigned int lost = (1u<<m)-1; //first m data symbols
+	double start;
+	double encodeNs, decodeNs;
+	double encodeCycles, decodeCycles;
+	double bytes = (double)ROUNDS*k*SYMBOL;
+	int round;
+
+	start = nanoseconds();
+	cycles = CYCLES();
+	for(round=0;round<ROUNDS;round++)
+	{
+		blockData[0][0] = round; //data changes every round
+		rsEncode(k, m, symbols, SYMBOL);
+	}
+	encodeCycles = (CYCLES()-cycles) / bytes;
+	encodeNs = (nanoseconds()-start) / bytes;
+
+	memcpy(original, blockData, sizeof(blockData));
+	start = nanoseconds();
+	cycles = CYCLES();
+	for(round=0;round<ROUNDS;round++)
+	{
+		memcpy(blockData[k], original[k], m*SYMBOL); //parity is overwritten by decoding
+		present = ((1u<<(k+m))-1) & ~lost;
+		rsDecode(k, m, symbols, &present, SYMBOL);
+	}
+	decodeCycles = (CYCLES()-cycles) / bytes;
+	decodeNs = (nanoseconds()-start) / bytes;
+
+	printf("%u,%u,%.2f,%.2f,%.2f,%.2f\n", k, m, encodeCycles, encodeNs, decodeCycles, decodeNs);
+}
+
+double nanoseconds()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec*1e9 + now.tv_nsec;
+}
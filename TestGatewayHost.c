@@ -0,0 +1,153 @@
+/*******************************************************
+Host benchmark of gateway pipeline (nRF24L01p_gateway.c)
+
+Build   : gcc -O2 -I. -o TestGatewayHost TestGatewayHost.c nRF24L01p_gateway.c nRF24L01p_spidev.c nRF24L01p_emu.c -lpthread
+Run     : ./TestGatewayHost [work] [pin]
+Comments: Each simulated radio is an emulated chip fed by
+          its own thread as fast as RX FIFO is read. The
+          handler hashes the payload work times as decode
+          work (default 200). Throughput of every count of
+          radios and workers is printed, with pin each
+          thread is bound to its own CPU.
+*******************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sched.h>
+#include "nRF24L01p_gateway.h"
+#include "nRF24L01p_emu.h"
+
+#define RUN_TIME 1 //seconds of each measurement
+
+typedef struct {
+    NRF24_EmuChip chip;
+    NRF24_Spidev radio;
+    pthread_t feeder;
+} SimRadio;
+
+SimRadio sim[NRF24_GW_MAX_RADIOS];
+bool feeding;
+unsigned int work = 200;
+unsigned long sink; //keeps decode work from being optimized away
+
+void *feed(void *arg);
+void decode(NRF24_GwPacket *packet, void *context);
+void run(unsigned char radios, unsigned char workers, unsigned int batch, bool pin);
+
+int main(int argc, char **argv)
+{
+	unsigned char radios[] = {1, 2, 4};
+	unsigned char workers[] = {1, 2, 4};
+	unsigned char r;
+	unsigned char w;
+	bool pin = (argc>2 && strcmp(argv[2], "pin")==0);
+
+	if(argc>1)
+		work = atoi(argv[1]);
+
+	printf("cpus,radios,workers,batch,packets/s,dropped,handled by each worker\n");
+	for(r=0;r<sizeof(radios);r++)
+		for(w=0;w<sizeof(workers);w++)
+			run(radios[r], workers[w], 16, pin);
+	run(4, 4, 1, pin); //without batching
+	return 0;
+}
+
+/*
+ * one measurement: radios simulated radios, workers workers
+ */
+void run(unsigned char radios, unsigned char workers, unsigned int batch, bool pin)
+{
+	NRF24_Gateway gw;
+	NRF24_GwConfig config;
+	NRF24_GwStats stats;
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned long handled = 0;
+	unsigned long dropped = 0;
+	unsigned char i;
+	struct timespec wait;
+
+	memset(&config, 0, sizeof(config));
+	config.workers = workers;
+	config.batch = batch;
+	config.spread = 1;
+	config.handler = decode;
+	for(i=0;i<NRF24_GW_MAX_RADIOS;i++)
+		config.radioCpu[i] = pin ? i%cpus : -1;
+	for(i=0;i<NRF24_GW_MAX_WORKERS;i++)
+		config.workerCpu[i] = pin ? (radios+i)%cpus : -1;
+	gwInit(&gw, &config);
+
+	__atomic_store_n(&feeding, 1, __ATOMIC_RELAXED);
+	for(i=0;i<radios;i++)
+	{
+		emuStart(&sim[i].chip);
+		spidevAttach(&sim[i].radio, emuSpiFd(&sim[i].chip), emuIrqFd(&sim[i].chip));
+		spidevConfig(&sim[i].radio, NRF24_RECEIVER, 76, NRF24_2Mbps);
+		gwAddRadio(&gw, &sim[i].radio);
+		pthread_create(&sim[i].feeder, NULL, feed, &sim[i]);
+	}
+
+	gwStart(&gw);
+	wait.tv_sec = RUN_TIME;
+	wait.tv_nsec = 0;
+	nanosleep(&wait, NULL);
+	gwGetStats(&gw, &stats);
+
+	__atomic_store_n(&feeding, 0, __ATOMIC_RELAXED);
+	gwStop(&gw);
+	for(i=0;i<radios;i++)
+	{
+		pthread_join(sim[i].feeder, NULL);
+		spidevClose(&sim[i].radio);
+		emuStop(&sim[i].chip);
+	}
+
+	for(i=0;i<workers;i++)
+		handled += stats.handled[i];
+	for(i=0;i<radios;i++)
+		dropped += stats.dropped[i];
+	printf("%ld,%d,%d,%u,%lu,%lu,", cpus, radios, workers, batch, handled/RUN_TIME, dropped);
+	for(i=0;i<workers;i++)
+		printf("%s%lu", i>0 ? " " : "", stats.handled[i]);
+	printf("\n");
+}
+
+/*
+ * keeps RX FIFO of a simulated radio full
+ */
+void *feed(void *arg)
+{
+	SimRadio *radio = (SimRadio*)arg;
+	unsigned char data[32];
+	unsigned long count = 0;
+
+	memset(data, 0x5A, sizeof(data));
+	while(__atomic_load_n(&feeding, __ATOMIC_RELAXED))
+	{
+		memcpy(data, &count, sizeof(count));
+		if(emuInject(&radio->chip, 0, data, 32))
+			count++;
+		else
+			sched_yield(); //RX FIFO is full
+	}
+	return NULL;
+}
+
+/*
+ * decode work of a packet
+ */
+void decode(NRF24_GwPacket *packet, void *context)
+{
+	unsigned long hash = 2166136261UL;
+	unsigned int i;
+	unsigned char j;
+
+	for(i=0;i<work;i++)
+		for(j=0;j<packet->length;j++)
+			hash = (hash ^ (unsigned char)packet->data[j]) * 16777619UL;
+	__atomic_store_n(&sink, hash, __ATOMIC_RELAXED);
+}
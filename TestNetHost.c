@@ -0,0 +1,281 @@
+/*******************************************************
+Host simulation of tree network (nRF24L01p_net.c)
+
+Build   : sh nRF24L01p_host.sh TestNetHost 31 nRF24L01p_net.c -DNRF24_PEER_TABLE_SIZE=6
+Run     : ./TestNetHost
+Comments: Each node runs its own copy of nRF24L01p.c and
+          nRF24L01p_net.c on a radio of nRF24L01p_sim.c:
+          2Mbps, 500us ARD, 15 retransmits, SPI at 4MHz as
+          in TestAtmega88.c. All nodes share one channel,
+          so frames of different links collide too. Prints
+          latency per hop count of a chain, forwarding
+          throughput through 0 to 3 relays, also with 2ms
+          of other work in each main loop, and a loaded
+          tree. Packets IRQ service routine drops after
+          their ACK (RX_OVERFLOW events) are counted.
+*******************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "nRF24L01p_sim.h"
+
+#define PAYLOAD 26 //NRF24_NET_MAX_PAYLOAD, main part does not include the driver
+#define START 200000.0 //us, nodes are configured by then
+#define IDLE 10 //us a node waits when it has nothing to do
+#define WORK 2000 //us of other work in main loop of a busy node
+
+typedef struct {
+	unsigned int address; //position in tree
+	double first; //us of first frame, NRF24_SIM_NEVER if node has no traffic
+	double interval;
+	bool saturated; //next frame as soon as queue has room
+	unsigned long offered;
+	unsigned long rejected;
+	unsigned long forwarded; //counters of nRF24L01p_net.c, copied by the node
+	unsigned long failures;
+	unsigned long queueDrops;
+	unsigned long overflows; //RX_OVERFLOW events
+	double work; //us of other work in each main loop
+} TestNode;
+
+typedef struct {
+	unsigned long count;
+	double sum;
+	double min;
+	double max;
+} Latency;
+
+extern TestNode testNodes[NRF24_SIM_MAX_NODES];
+extern Latency latency[6]; //by hops
+extern unsigned long delivered;
+
+unsigned char depthOf(unsigned int address);
+
+#ifdef HOST_NODE
+#include "nRF24L01p_net.h"
+
+NRF24_NetNode net;
+TestNode *test;
+
+void onOverflow(NRF24_Event *event)
+{
+	test->overflows++;
+}
+
+/*
+ * a node of the tree: sends its frames to root, forwards the others
+ */
+void hostMain(int arg)
+{
+	char data[NRF24_NET_MAX_PAYLOAD];
+	double next;
+	unsigned long now;
+	unsigned long sent;
+	unsigned int from;
+	unsigned char hops;
+	double age;
+
+	test = &testNodes[arg];
+	next = test->first;
+	setTimestampSource(hostMicros); //startClock()
+	nRF_Config(NRF24_RECEIVER);
+	setBaudRate(NRF24_2Mbps);
+	if(netInit(&net, test->address)==0)
+		printf("address %o is not valid\n", test->address);
+	setEventCallback(NRF24_EVENT_RX_OVERFLOW, onOverflow);
+	hostSei();
+
+	while(1)
+	{
+		now = hostMicros();
+		if(test->saturated==1 && net.queueCount<NRF24_NET_QUEUE_SIZE)
+			next = now;
+		if(now>=next)
+		{
+			memset(data, 0, sizeof(data));
+			memcpy(data, &now, sizeof(now)); //time it is sent
+			if(netSend(&net, 0, 1, data, NRF24_NET_MAX_PAYLOAD)==1)
+				test->offered++;
+			else
+				test->rejected++;
+			next = (test->saturated==0) ? next+test->interval : NRF24_SIM_NEVER;
+		}
+
+		serviceEvents();
+		netService(&net);
+		while(netRead(&net, &from, NULL, data)>0)
+		{
+			memcpy(&sent, data, sizeof(sent));
+			age = hostMicros() - sent;
+			hops = depthOf(from) - depthOf(net.address);
+			if(latency[hops].count==0 || age<latency[hops].min)
+				latency[hops].min = age;
+			if(age>latency[hops].max)
+				latency[hops].max = age;
+			latency[hops].sum += age;
+			latency[hops].count++;
+			delivered++;
+		}
+		test->forwarded = net.stats.forwarded;
+		test->failures = net.stats.failures;
+		test->queueDrops = net.stats.queueDrops;
+
+		if(test->work>0)
+			delay_us(test->work);
+		else if(net.queueCount==0)
+			delay_us(IDLE);
+	}
+}
+#else
+TestNode testNodes[NRF24_SIM_MAX_NODES];
+Latency latency[6];
+unsigned long delivered;
+
+void addNode(unsigned int address);
+void chainLatency(int arg);
+void chainThroughput(int arg);
+void treeLoad(int n);
+
+int main(void)
+{
+	int failed = 0;
+	int i;
+
+	failed += !simIsolated(chainLatency, 0);
+	printf("\nhops,relays,main loop us,frames/s at root,payload kbit/s,mean latency us,relay failures,queue drops,dropped after ACK\n");
+	for(i=1;i<=4;i++)
+		failed += !simIsolated(chainThroughput, i);
+	for(i=2;i<=4;i++)
+		failed += !simIsolated(chainThroughput, 10+i);
+	printf("\nnodes,interval ms,offered frames/s,delivered frames/s,delivered %%,mean latency 1 hop us,2 hops us,failures,queue drops\n");
+	for(i=0;i<4;i++)
+		failed += !simIsolated(treeLoad, i);
+	return failed>0; //a scenario that crashed only leaves its header
+}
+
+/*
+ * one frame at a time from each node of a chain of 5 levels to root
+ */
+void chainLatency(int arg)
+{
+	unsigned int chain[] = {0, 01, 011, 0111, 01111, 011111};
+	unsigned char hops;
+	int i;
+
+	simInit(1);
+	for(i=0;i<6;i++)
+	{
+		addNode(chain[i]);
+		if(i>0)
+		{
+			testNodes[i].first = START + i*7000; //never two frames on the chain at a time
+			testNodes[i].interval = 50000;
+		}
+	}
+	simRun(10e6);
+
+	printf("hops,frames,mean latency us,min us,max us,added by last hop us\n");
+	for(hops=1;hops<=5;hops++)
+		printf("%d,%lu,%.0f,%.0f,%.0f,%.0f\n", hops, latency[hops].count, latency[hops].sum/latency[hops].count,
+			latency[hops].min, latency[hops].max,
+			hops>1 ? latency[hops].sum/latency[hops].count - latency[hops-1].sum/latency[hops-1].count : latency[1].sum/latency[1].count);
+}
+
+/*
+ * saturated source at the end of a chain, frames per second that reach root,
+ * arg is hops, plus 10 if nodes are busy with other work
+ */
+void chainThroughput(int arg)
+{
+	unsigned int chain[] = {0, 01, 011, 0111, 01111};
+	int hops = arg%10;
+	double work = (arg>=10) ? WORK : 0;
+	unsigned long failures = 0;
+	unsigned long drops = 0;
+	unsigned long overflows = 0;
+	int i;
+
+	simInit(1);
+	for(i=0;i<=hops;i++)
+	{
+		addNode(chain[i]);
+		testNodes[i].work = work;
+	}
+	testNodes[hops].first = START;
+	testNodes[hops].saturated = 1;
+	simRun(5e6);
+
+	for(i=1;i<=hops;i++)
+	{
+		failures += testNodes[i].failures;
+		drops += testNodes[i].queueDrops;
+	}
+	for(i=0;i<=hops;i++)
+		overflows += testNodes[i].overflows;
+	printf("%d,%d,%.0f,%.0f,%.1f,%.0f,%lu,%lu,%lu\n", hops, hops-1, work>0 ? work : IDLE, delivered/5.0, delivered*PAYLOAD*8/5.0/1000,
+		latency[hops].sum/latency[hops].count, failures, drops, overflows);
+}
+
+/*
+ * root, 5 children and 25 grandchildren, all of them send to root
+ */
+void treeLoad(int n)
+{
+	double intervals[] = {500000, 200000, 100000, 50000};
+	unsigned long offered = 0;
+	unsigned long failures = 0;
+	unsigned long drops = 0;
+	unsigned char c;
+	unsigned char g;
+	int i;
+
+	simInit(1);
+	addNode(0);
+	for(c=1;c<=5;c++)
+	{
+		addNode(c);
+		for(g=1;g<=5;g++)
+			addNode(c | (g<<3));
+	}
+	for(i=1;i<simNodeCount();i++)
+	{
+		testNodes[i].interval = intervals[n];
+		testNodes[i].first = START + (double)simRandom()/32768 * intervals[n];
+	}
+	simRun(10e6);
+
+	for(i=0;i<simNodeCount();i++)
+	{
+		offered += testNodes[i].offered;
+		failures += testNodes[i].failures;
+		drops += testNodes[i].queueDrops + testNodes[i].rejected;
+	}
+	printf("%d,%.0f,%.0f,%.0f,%.1f,%.0f,%.0f,%lu,%lu\n", simNodeCount(), intervals[n]/1000, offered/10.0, delivered/10.0,
+		100.0*delivered/(offered+drops), latency[1].sum/latency[1].count, latency[2].sum/latency[2].count, failures, drops);
+}
+
+/*
+ * node with no traffic of its own, it starts at power on
+ */
+void addNode(unsigned int address)
+{
+	int index = simNodeCount();
+
+	memset(&testNodes[index], 0, sizeof(TestNode));
+	testNodes[index].address = address;
+	testNodes[index].first = NRF24_SIM_NEVER;
+	simAddNode(simEntries[index], index);
+}
+#endif
+
+unsigned char depthOf(unsigned int address)
+{
+	unsigned char depth = 0;
+
+	while(address!=0)
+	{
+		address >>= 3;
+		depth++;
+	}
+	return depth;
+}
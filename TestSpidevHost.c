@@ -0,0 +1,182 @@
+/*******************************************************
+Host benchmark of Linux spidev backend (nRF24L01p_spidev.c)
+
+Build   : gcc -O2 -I. -o TestSpidevHost TestSpidevHost.c nRF24L01p_spidev.c nRF24L01p_emu.c -lpthread
+Run     : ./TestSpidevHost
+Comments: Sends packets between two emulated chips to check
+          the backend, then receives packets injected into
+          an emulated chip with batching on and off and
+          prints SPI_IOC_MESSAGE calls (syscalls on a real
+          spidev) and time per received packet.
+*******************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "nRF24L01p_spidev.h"
+#include "nRF24L01p_emu.h"
+
+#define CHECK_PACKETS 1000
+#define BENCH_PACKETS 200000
+
+int checkLoopback(void);
+void benchmark(bool batching, unsigned char size);
+void makePacket(unsigned long count, unsigned char size, unsigned char *wire);
+double nanoseconds();
+
+int main(void)
+{
+	if(checkLoopback()!=0)
+		return 1;
+
+	printf("batching,payload,packets,lost,batches/packet,transfers/packet,spi bytes/packet,ns/packet\n");
+	benchmark(0, 32);
+	benchmark(1, 32);
+	benchmark(0, 8);
+	benchmark(1, 8);
+	return 0;
+}
+
+/*
+ * transmitter and receiver on two connected chips, every packet has to arrive in order
+ */
+int checkLoopback(void)
+{
+	NRF24_EmuChip txChip;
+	NRF24_EmuChip rxChip;
+	NRF24_Spidev tx;
+	NRF24_Spidev rx;
+	char data[32];
+	char received[32];
+	unsigned char width;
+	unsigned char pipe;
+	unsigned long i;
+	unsigned char j;
+	int errors = 0;
+
+	if(emuStart(&txChip)==0 || emuStart(&rxChip)==0)
+	{
+		printf("emulator could not be started\n");
+		return 1;
+	}
+	emuConnect(&txChip, &rxChip);
+	spidevAttach(&tx, emuSpiFd(&txChip), emuIrqFd(&txChip));
+	spidevAttach(&rx, emuSpiFd(&rxChip), emuIrqFd(&rxChip));
+	spidevConfig(&rx, NRF24_RECEIVER, 76, NRF24_2Mbps);
+	spidevConfig(&tx, NRF24_TRANSMITTER, 76, NRF24_2Mbps);
+
+	for(i=0;i<CHECK_PACKETS;i++)
+	{
+		for(j=0;j<32;j++)
+			data[j] = (char)(i+j);
+		if(spidevSend(&tx, data, 1+i%32)==0 || spidevWaitIrq(&tx, 1000)==0 || spidevTxStatus(&tx)!=NRF24_TX_DELIVERED)
+		{
+			errors++;
+			continue;
+		}
+		if(spidevWaitIrq(&rx, 1000)==0)
+		{
+			errors++;
+			continue;
+		}
+		width = spidevReceive(&rx, received, &pipe);
+		if(width!=1+i%32 || pipe!=0 || memcmp(data, received, width)!=0)
+			errors++;
+	}
+
+	spidevClose(&tx);
+	spidevClose(&rx);
+	emuStop(&txChip);
+	emuStop(&rxChip);
+	if(errors>0)
+		printf("loopback: %d of %d packets were not received correctly\n", errors, CHECK_PACKETS);
+	return errors;
+}
+
+/*
+ * packets are injected 3 at a time, as many as RX FIFO holds, and read by the backend
+ */
+void benchmark(bool batching, unsigned char size)
+{
+	NRF24_EmuChip chip;
+	NRF24_Spidev radio;
+	NRF24_SpidevStats before;
+	NRF24_SpidevStats after;
+	unsigned char wire[32];
+	char data[32];
+	unsigned long injected = 0;
+	unsigned long received = 0;
+	unsigned long expected = 0;
+	unsigned long lost = 0;
+	unsigned long count;
+	unsigned char width;
+	double start;
+	double time;
+
+	emuStart(&chip);
+	spidevAttach(&radio, emuSpiFd(&chip), emuIrqFd(&chip));
+	spidevConfig(&radio, NRF24_RECEIVER, 76, NRF24_2Mbps);
+	spidevSetBatching(&radio, batching);
+	spidevGetStats(&radio, &before);
+
+	start = nanoseconds();
+	while(received+lost<BENCH_PACKETS)
+	{
+		makePacket(injected, size, wire);
+		while(injected<BENCH_PACKETS && emuInject(&chip, 0, wire, size))
+			makePacket(++injected, size, wire);
+
+		if(spidevRxPending(&radio)==0 && spidevWaitIrq(&radio, 1000)==0)
+			break; //nothing arrives any more
+		width = spidevReceive(&radio, data, NULL);
+		if(width==0)
+			continue;
+
+		//first 4 bytes are the number of the packet
+		count = (unsigned char)data[0] | ((unsigned long)(unsigned char)data[1]<<8) |
+			((unsigned long)(unsigned char)data[2]<<16) | ((unsigned long)(unsigned char)data[3]<<24);
+		if(width!=size || count<expected)
+		{
+			lost++;
+			continue;
+		}
+		lost += count-expected;
+		expected = count+1;
+		received++;
+	}
+	time = nanoseconds()-start;
+	spidevGetStats(&radio, &after);
+
+	printf("%d,%d,%lu,%lu,%.2f,%.2f,%.1f,%.0f\n", batching, size, received, lost,
+		(double)(after.batches-before.batches)/received, (double)(after.transfers-before.transfers)/received,
+		(double)(after.bytes-before.bytes)/received, time/received);
+
+	spidevClose(&radio);
+	emuStop(&chip);
+}
+
+/*
+ * packet in the order it is sent on SPI, last byte of the array first like writeCommand()
+ */
+void makePacket(unsigned long count, unsigned char size, unsigned char *wire)
+{
+	unsigned char data[32];
+	unsigned char i;
+
+	for(i=0;i<size;i++)
+		data[i] = (unsigned char)(i*7);
+	data[0] = count;
+	data[1] = count>>8;
+	data[2] = count>>16;
+	data[3] = count>>24;
+	for(i=0;i<size;i++)
+		wire[i] = data[size-1-i];
+}
+
+double nanoseconds()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec*1e9 + now.tv_nsec;
+}
@@ -21,14 +21,52 @@
    (#) Initialize and config the module by calling nRF_Config() function.
 	   the parameter sets the module as Transmitter or Receiver, In the same
 	   time, just one mode of operation is allowed.
+	   To change the mode later (request/response), use switchRole(), it
+	   takes only the 130us settling time instead of a new nRF_Config().
 
    (#) In case of Transmitter:
 	   Use sendData() function in order to send a data array of maximum 32 byte
+	   Or queue packets without waiting using txEnqueue(). It returns a ticket
+	   to query the result by getTxStatus() (delivered, max retries or
+	   dropped), and 0 while the queue is full.
+	   Urgent control frames can be queued by txEnqueueLane() in high
+	   priority lane, they are sent before any waiting bulk packet.
+	   For high rate streams, setTxCoalescing() avoids one interrupt per packet.
+	   Payloads that are sent again and again (beacons, wake-up bursts) can be
+	   loaded once by loadBeacon() and sent by fireBeacon(), repeatBeacon() or
+	   burstBeacon() without any SPI upload, until stopBeacon() is called.
+	   On a shared channel, setCSMA(1) makes sendData() check for carrier
+	   (RPD) and back off randomly while the channel is busy. Packets of
+	   txEnqueue() are not sensed, TX queue is fed from the interrupt.
+	   To talk to several nodes, store their addresses by setPeerAddress()
+	   and use sendDataTo(), TX_ADDR is only written when the destination
+	   changes and then only from the first byte that differs.
                     
    (#) In case of Receiver:
 	   Check if any new data has received using bytesAvailable().
 	   If any byte is available, read received bytes by calling readRxFIFO().
 	   Until readRxFIFO() is not called, all new received data will be droped.
+	   If a pipe always receives records of the same size, set its width by
+	   setPipePayloadWidth(), its packets are read without asking their width.
+	   For the lowest latency, disable the pin change interrupt of IRQ by
+	   setPolledMode(1) and call pollReceive() in a tight loop, it reads the
+	   packet straight into your buffer.
+
+   (#) Instead of polling, register callbacks for RX ready, TX done, MAX_RT
+	   and RX overflow events using setEventCallback(), then call
+	   serviceEvents() each time the MCU wakes up from sleep. Callbacks are
+	   called in main context, so they can use readRxFIFO() and sendData().
+
+   (#) Between bursts, call powerIdle() with the wake up latency you can
+	   accept, nrf24 goes to Power Down, Standby-I or stays in RX. Use
+	   getPowerState() and getTransitionTime() to plan duty cycles.
+
+   (#) A product with one fixed configuration can define NRF24_PROFILE and
+	   the NRF24_PROFILE_x constants of nrf24L01p.h (channel, rate, power,
+	   CRC, address, pipes, auto ACK, DPL and roles) in project settings.
+	   nRF_Config() then writes a register image made at build time, the
+	   setters of these parameters and the unused role are not compiled.
+	   Flash and RAM of each profile are shown in the compiler report.
 
      *** Defaul configuration ***    
      =================================== 
@@ -111,6 +149,7 @@
 #include <delay.h>
 #include <spi.h>
 #include <string.h>
+#include <stdlib.h>
 
 /* Private define ------------------------------------------------------------*/
 /* Instruction Memories */
@@ -155,12 +194,119 @@
 #define DYNPD 0x1C
 #define FEATURE 0x1D
 
+#define PEER_UNKNOWN 0xFE //loadedPeer when registers have to be compared with the peer
+
 /* Private variables ---------------------------------------------------------*/
+#ifdef NRF24_PROFILE
+flash unsigned char Base_Addrs[NRF24_ADDRESS_WIDTH]=NRF24_PROFILE_ADDRESS; //address of this device
+
+flash unsigned char profileImage[][2] = { //register and its value, written by nRF_Config()
+	{EN_AA, NRF24_PROFILE_AUTO_ACK},
+	{EN_RXADDR, NRF24_PROFILE_PIPES},
+	{SETUP_AW, NRF24_PROFILE_ADDRESS_WIDTH-2}, //1: 3 byte, 2: 4 byte, 3: 5 byte
+	{RF_CH, NRF24_PROFILE_CHANNEL},
+	{RF_SETUP, (NRF24_PROFILE_RATE==0 ? 0x20 : 0x00) | (NRF24_PROFILE_RATE==2 ? 0x08 : 0x00) | (NRF24_PROFILE_POWER<<1)}, //RF_DR_LOW, RF_DR_HIGH and RF_PWR
+	{RX_PW_P0, NRF24_PROFILE_DPL==1 ? 0 : 32},
+	{RX_PW_P1, NRF24_PROFILE_DPL==1 ? 0 : 32},
+	{RX_PW_P2, NRF24_PROFILE_DPL==1 ? 0 : 32},
+	{RX_PW_P3, NRF24_PROFILE_DPL==1 ? 0 : 32},
+	{RX_PW_P4, NRF24_PROFILE_DPL==1 ? 0 : 32},
+	{RX_PW_P5, NRF24_PROFILE_DPL==1 ? 0 : 32},
+	{DYNPD, NRF24_PROFILE_DPL==1 ? NRF24_PROFILE_PIPES : 0x00},
+	{FEATURE, NRF24_PROFILE_DPL==1 ? 0x04 : 0x00} //EN_DPL
+};
+
+#define PROFILE_CRC ((NRF24_PROFILE_CRC>0 ? 0x08 : 0x00) | (NRF24_PROFILE_CRC==2 ? 0x04 : 0x00)) //EN_CRC and CRCO bits of CONFIG
+#else
 unsigned char Base_Addrs[5]={0x00,0x01,0x03,0x07,0x00}; //address of this device
-unsigned char Temp_Addrs[5]={0x00,0x01,0x03,0x07,0x00};
+#endif
 unsigned char payload[33]; //stores last received bytes
 unsigned char receiveBytesAvailable = 0; //store numbers of bytes available in RX FIFO, reset when RX FIFO is read
 Mode operationMode; //which mode the device is, transmitter or receiver
+bool powerUp = 0; //PWR_UP bit of CONFIG register
+unsigned char receivePipe = 0; //data pipe number of the packet stored in payload
+unsigned char pipeWidth[6] = {0, 0, 0, 0, 0, 0}; //static payload width of every data pipe, 0 means dynamic payload length
+
+NRF24_Event eventQueue[NRF24_EVENT_QUEUE_SIZE]; //events waiting to be dispatched by serviceEvents()
+volatile unsigned char eventHead = 0; //index of the oldest event in eventQueue
+volatile unsigned char eventCount = 0; //number of events in eventQueue
+NRF24_EventCallback eventCallbacks[4] = {NULL, NULL, NULL, NULL}; //one callback per NRF24_EventType
+
+NRF24_TimestampSource timestampSource = NULL; //clock of application, used to timestamp received packets
+unsigned long rxTimestamp = 0; //time of IRQ of the packet stored in payload
+
+#if NRF24_USE_TX
+bool csmaEnabled = 0; //sendData() senses the channel before sending
+NRF24_CsmaStats csmaStats; //counters of listen before talk
+
+unsigned char peerAddress[NRF24_PEER_TABLE_SIZE][NRF24_ADDRESS_WIDTH]; //destinations of sendDataTo(), first byte is MSB like Base_Addrs
+unsigned char txAddress[NRF24_ADDRESS_WIDTH]; //what TX_ADDR holds
+unsigned char rx0Address[NRF24_ADDRESS_WIDTH]; //what RX_ADDR_P0 holds
+unsigned char loadedPeer = NRF24_PEER_BASE; //peer whose address is in TX_ADDR, PEER_UNKNOWN after a change of peer table
+bool ackEnabled = 0; //auto ACK of pipe 0, ACKs of PTX come to RX_ADDR_P0
+NRF24_AddressStats addressStats;
+#endif
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    unsigned char ticket; //identifies the packet to the application
+    unsigned char size; //number of bytes in data
+    bool noAck; //sent by W_TX_PAYLOAD_NOACK, receiver does not acknowledge it
+    char data[32];
+} TxPacket;
+
+typedef struct {
+    unsigned char ticket;
+    NRF24_TxStatus status;
+} TxResult;
+
+typedef struct {
+    unsigned char base; //index of the first slot of this lane in txQueue
+    unsigned char size; //number of slots of this lane
+    unsigned char head; //oldest packet of this lane, relative to base
+    unsigned char count; //number of packets in this lane, including the ones uploaded to TX FIFO
+    unsigned char inFlight; //number of oldest packets of this lane that are uploaded to TX FIFO
+    NRF24_LaneStats stats;
+} TxLane;
+
+#if NRF24_USE_TX
+TxPacket txQueue[NRF24_TX_HIGH_QUEUE_SIZE+NRF24_TX_QUEUE_SIZE]; //slots of all lanes, high priority lane first
+TxLane txLanes[2] = { //indexed by NRF24_TxLane
+    {0, NRF24_TX_HIGH_QUEUE_SIZE},
+    {NRF24_TX_HIGH_QUEUE_SIZE, NRF24_TX_QUEUE_SIZE}
+};
+unsigned char txFifoLane[3]; //lane of every packet in TX FIFO, in the order they are sent
+volatile unsigned char txFifoCount = 0; //number of queued packets uploaded to TX FIFO
+unsigned char txNextTicket = 1; //ticket of the next queued packet, 0 is never used
+TxResult txResults[NRF24_TX_STATUS_SIZE]; //completion status of recent tickets, indexed by ticket
+
+bool beaconActive = 0; //a beacon is in TX FIFO and REUSE_TX_PL is active
+
+unsigned char txCoalesce = 0; //0: TX_DS interrupt per packet, n: TX_DS is masked and one TX_DONE event is reported per n packets
+unsigned char txCoalesced = 0; //packets completed since last TX_DONE event in coalescing mode
+unsigned char txLastTicket = 0; //ticket of the last completed packet
+unsigned char txLastLane = 0; //lane of the last completed packet
+bool txDrainWatch = 0; //in coalescing mode, TX_DS is unmasked to catch the end of TX FIFO
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+void pushEvent(NRF24_EventType type, unsigned char pipe, unsigned char length, unsigned char ticket);
+#if NRF24_USE_TX
+unsigned char txEnqueuePacket(char *data, unsigned char size, NRF24_TxLane lane, bool preempt, bool noAck);
+void txKick();
+void txComplete(NRF24_TxStatus result);
+void txObserve(unsigned char ticket);
+void txFlushFifo();
+void txAccount(unsigned char fifoStatus);
+void txSettle(unsigned char status, unsigned char fifoStatus);
+void txCollect();
+unsigned char txFifoLeft(unsigned char fifoStatus);
+void txDrainCheck();
+bool csmaAccess();
+bool channelClear();
+void getBaseAddress(unsigned char *address);
+void writeAddress(unsigned char reg, unsigned char *address, unsigned char *loaded);
+#endif
 
 #pragma used+
 /* library function prototypes */
@@ -190,6 +336,9 @@ Mode operationMode; //which mode the device is, transmitter or receiver
 void nRF_Config(Mode mode)
 {
     char data[10];
+#ifdef NRF24_PROFILE
+	unsigned char i;
+#endif
 	
 	CSN = 1; 
     CE = 0;
@@ -205,6 +354,40 @@ void nRF_Config(Mode mode)
 	writeCommand(FLUSH_TX, NULL, 0); //flush TX FIFO
 	writeCommand(FLUSH_RX, NULL, 0); //flush TX FIFO
 	
+#ifdef NRF24_PROFILE
+	//write register image of the profile
+	for(i=0;i<sizeof(profileImage)/2;i++)
+	{
+		data[0] = profileImage[i][1];
+		writeCommand(W_REGISTER+profileImage[i][0], data, 1);
+	}
+	for(i=0;i<NRF24_ADDRESS_WIDTH;i++)
+		data[i] = Base_Addrs[i]; //from flash
+	writeCommand(W_REGISTER+RX_ADDR_P0, data, NRF24_ADDRESS_WIDTH);
+	writeCommand(W_REGISTER+TX_ADDR, data, NRF24_ADDRESS_WIDTH);
+#if NRF24_USE_TX
+	memcpy(txAddress, data, NRF24_ADDRESS_WIDTH); //address cache of selectPeer()
+	memcpy(rx0Address, data, NRF24_ADDRESS_WIDTH);
+	loadedPeer = NRF24_PEER_BASE;
+	ackEnabled = NRF24_PROFILE_AUTO_ACK & 0x01;
+#endif
+	memset(pipeWidth, (NRF24_PROFILE_DPL==1) ? 0 : 32, 6);
+	
+	//interrupt masks, CRC, PWR_UP and PRIM_RX by one CONFIG write
+	if(mode==NRF24_TRANSMITTER)
+		data[0] = 0x40 | PROFILE_CRC | 0x02; //enable TX_DS and MAX_RT, PTX
+	else
+		data[0] = 0x30 | PROFILE_CRC | 0x03; //enable RX_DR, PRX
+	writeCommand(W_REGISTER+CONFIG, data, 1);
+	powerUp = 1;
+	
+	if(mode==NRF24_TRANSMITTER){
+		delay_ms(100);
+	}else{
+		delay_ms(5);
+		CE = 1;
+	}
+#else
 	// enable auto acknowledge
 	setAutoAck(0); //disable auto ACK
     
@@ -226,6 +409,9 @@ void nRF_Config(Mode mode)
     
 	//write base address of TX in pipe 0
 	writeCommand(W_REGISTER+TX_ADDR, Base_Addrs, 5); //Command:W_REGISTER on address 10 (Transmit address. Used for a PTX device only)
+	memcpy(txAddress, Base_Addrs, 5); //address cache of selectPeer()
+	memcpy(rx0Address, Base_Addrs, 5);
+	loadedPeer = NRF24_PEER_BASE;
     
 	//enable dynamic payload lenght
 	setDynamicPayloadLength(1);
@@ -245,8 +431,10 @@ void nRF_Config(Mode mode)
 		delay_ms(5);
         CE = 1;
 	}
+#endif
 }
  
+#ifndef NRF24_PROFILE
 /**
   * @brief  Sets mode of operation, Change other configuration if this function has used.
   *         
@@ -270,7 +458,77 @@ void setMode(Mode m)
 	
 	writeCommand(W_REGISTER+CONFIG, data, 1); //write data to update CONFIG
 }
+#endif
+
+/**
+  * @brief  Switches between transmitter and receiver without configuring the module again.
+  *         PRIM_RX, interrupt masks, CE and mode of driver are changed together with interrupts disabled,
+  *         by one CONFIG write. Packets uploaded to TX FIFO stay in TX queue to be sent when transmitter again,
+  *         packets that are already sent or failed are completed before interrupt flags are cleared.
+  *         
+  * @param	m: New mode of operation.
+  * @retval NONE.
+  */
+void switchRole(Mode m)
+{
+	char data[1];
+	unsigned char sreg;
+#if NRF24_USE_TX
+	unsigned char address[NRF24_ADDRESS_WIDTH];
+#endif
+	
+	sreg = SREG; //save global interrupt state
+	#asm("cli")
+	
+	CE = 0; //go to Standby-I, PRIM_RX is changed in standby
+#if NRF24_USE_TX
+	if(m==NRF24_RECEIVER && (txFifoCount>0 || beaconActive==1))
+	{
+		txFlushFifo(); //TX FIFO of receiver holds ACK payloads, not packets of transmitter
+		beaconActive = 0;
+	}
+	else if(operationMode==NRF24_TRANSMITTER && txFifoCount>0)
+		txCollect(); //latched TX_DS and MAX_RT are not lost when flags are cleared below
+#endif
+	
+	writeCommand(R_REGISTER+CONFIG, data, 1); //read current config register
+	data[0] &= 0x8E; //keep CRC and power bits, clear mask bits and PRIM_RX
+#if NRF24_USE_TX
+	if(m==NRF24_TRANSMITTER)
+		data[0] |= (txCoalesce==0) ? 0x40 : 0x60; //mask RX_DR, mask TX_DS in coalescing mode, enable MAX_RT
+	else
+#endif
+		data[0] |= 0x30 | 0x01; //mask TX_DS and MAX_RT, enable RX_DR, set PRIM_RX
+	writeCommand(W_REGISTER+CONFIG, data, 1);
+	clearInterruptFlag(1, 1, 1); //flags of previous mode
+	
+	operationMode = m;
+#if NRF24_USE_TX
+	txDrainWatch = 0;
+	if(m==NRF24_TRANSMITTER && ackEnabled==1)
+		writeAddress(RX_ADDR_P0, txAddress, rx0Address); //ACKs of current peer
+	else if(m==NRF24_RECEIVER)
+	{
+		getBaseAddress(address);
+		writeAddress(RX_ADDR_P0, address, rx0Address); //own address, it has been a peer address in PTX
+	}
+	if(m==NRF24_TRANSMITTER)
+	{
+		txKick(); //sends queued packets, TX mode after 130us
+		if(txCoalesce>0)
+			txDrainCheck();
+	}
+	else
+#endif
+		CE = 1; //RX mode after 130us
+	
+	SREG = sreg; //restore global interrupt state
+	
+	if(m==NRF24_RECEIVER)
+		delay_us(130); //RX settling time
+}
 
+#ifndef NRF24_PROFILE
 /**
   * @brief  Sets the number of CRC bytes.
   *         
@@ -301,6 +559,7 @@ void setCRCScheme(unsigned char num)
 	
 	writeCommand(W_REGISTER+CONFIG, data, 1); //write data
 }
+#endif
 
 /**
   * @brief  Powers On the module if it is not.
@@ -315,6 +574,7 @@ void setPowerUp()
 	writeCommand(R_REGISTER+CONFIG, data, 1); //read current config register
 	data[0] |= 0x02; //set bit 2 (power up)
 	writeCommand(W_REGISTER+CONFIG, data, 1); //write data
+	powerUp = 1;
 }
 
 /**
@@ -330,6 +590,7 @@ void setPowerDown()
 	writeCommand(R_REGISTER+CONFIG, data, 1); //read current config register
 	data[0] &= 0xFD; //clear bit 2 (power down)
 	writeCommand(W_REGISTER+CONFIG, data, 1); //write data
+	powerUp = 0;
 }
 
 /**
@@ -374,6 +635,9 @@ void setBaudRate(NRF24_BaudRate br)
 void setAutoAck(bool param)
 {
 	char data[1];
+#if NRF24_USE_TX
+	unsigned char sreg;
+#endif
 	
 	writeCommand(R_REGISTER+EN_AA, data, 1); //read current EN_AA register
 	
@@ -382,9 +646,35 @@ void setAutoAck(bool param)
 	else //disable
 		data[0] &= 0xFE; //clear bit 0, disable auto ACK
 		
+#if NRF24_USE_TX
+	ackEnabled = param;
+	if(param==1 && operationMode==NRF24_TRANSMITTER)
+	{
+		sreg = SREG; //save global interrupt state
+		#asm("cli")
+		writeAddress(RX_ADDR_P0, txAddress, rx0Address); //ACKs of current peer, selectPeer() skips a loaded peer
+		SREG = sreg; //restore global interrupt state
+	}
+#endif
 	writeCommand(W_REGISTER+EN_AA, data, 1); //Command:W_REGISTER on address 01 (EN_AA, Enable ‘Auto Acknowledgment’ Function)
 }
 
+/**
+  * @brief  Sets delay and count of automatic retransmission, used when auto acknowledge is enabled.
+  *         
+  * @param	delay: Time to wait for ACK, (delay+1)*250us, 0 to 15.
+  * @param	count: Number of retransmits before MAX_RT, 0 to 15.
+  * @retval NONE.
+  */
+void setRetransmit(unsigned char delay, unsigned char count)
+{
+	char data[1];
+	
+	data[0] = ((delay&0x0F)<<4) | (count&0x0F); //ARD is bits 7:4, ARC is bits 3:0
+	writeCommand(W_REGISTER+SETUP_RETR, data, 1);
+}
+
+#ifndef NRF24_PROFILE
 /**
   * @brief  Enables or Disables data pipe 0 to receive data.
   *         
@@ -451,6 +741,7 @@ void serRFChannel(unsigned char ch)
 		writeCommand(W_REGISTER+RF_CH, data, 1); //Command:W_REGISTER on address 05 (RF_CH, RF Channel)
 	}
 }
+#endif
 
 /**
   * @brief  Sets the TX power level.
@@ -487,6 +778,7 @@ void setTXPower(NRF24_TXPower power)
 	writeCommand(W_REGISTER+RF_SETUP, data, 1); //Command:W_REGISTER on address 06 (RF_SETUP, RF Setup Register)   
 }
 
+#ifndef NRF24_PROFILE
 /**
   * @brief  Enable or Disable dynamic payload lenghth, If disabled, Transmitter have to send 32 bytes of data at any transmission.
   *         
@@ -516,6 +808,84 @@ void setDynamicPayloadLength(bool param)
 		data[0] &= 0xFB; //clear bit 2, disable dynamic payload length
 	data[0] &= 0x07;
 	writeCommand(W_REGISTER+FEATURE, data, 1); //Command:W_REGISTER on address 1D (FEATURE, Feature Register)
+	
+	//without dynamic payload length, pipe 0 receives 32 byte packets
+	data[0] = (param==1) ? 0 : 32;
+	writeCommand(W_REGISTER+RX_PW_P0, data, 1); //Command:W_REGISTER on address 11 (RX_PW_P0, Number of bytes in RX payload in data pipe 0)
+	pipeWidth[0] = data[0];
+}
+#endif
+
+/**
+  * @brief  Enables or Disables payload with ACK, receiver loads it by loadAckPayload(). Needs dynamic payload length.
+  *         
+  * @param	param: 1:Enabled, 0:Disabled.
+  * @retval NONE.
+  */
+void setAckPayload(bool param)
+{
+	char data[1];
+	
+	writeCommand(R_REGISTER+FEATURE, data, 1); //read current FEATURE register
+	if(param==1)
+		data[0] |= 0x02; //set bit 1, EN_ACK_PAY
+	else
+		data[0] &= 0xFD; //clear bit 1
+	writeCommand(W_REGISTER+FEATURE, data, 1);
+}
+
+/**
+  * @brief  Enables or Disables W_TX_PAYLOAD_NOACK command, used by txEnqueueNoAck().
+  *         
+  * @param	param: 1:Enabled, 0:Disabled.
+  * @retval NONE.
+  */
+void setDynamicAck(bool param)
+{
+	char data[1];
+	
+	writeCommand(R_REGISTER+FEATURE, data, 1); //read current FEATURE register
+	if(param==1)
+		data[0] |= 0x01; //set bit 0, EN_DYN_ACK
+	else
+		data[0] &= 0xFE; //clear bit 0
+	writeCommand(W_REGISTER+FEATURE, data, 1);
+}
+
+/**
+  * @brief  Sets the payload width of a data pipe. Packets of a pipe with static width are read without
+  *         asking their width (R_RX_PL_WID), so it saves one SPI transaction per received packet.
+  *         
+  * @param	pipe: Data pipe number, 0 to 5.
+  * @param	width: 1 to 32: static payload width, transmitter have to send exactly this number of bytes.
+  *         0: dynamic payload length.
+  * @retval NONE.
+  */
+void setPipePayloadWidth(unsigned char pipe, unsigned char width)
+{
+	char data[1];
+	
+	if(pipe>5 || width>32)
+		return;
+	
+	data[0] = width;
+	writeCommand(W_REGISTER+RX_PW_P0+pipe, data, 1); //RX_PW_Px, ignored by nrf24 if dynamic payload length is enabled on this pipe
+	
+	writeCommand(R_REGISTER+DYNPD, data, 1); //read current DYNPD register
+	if(width==0)
+		data[0] |= (1<<pipe); //set DPL_Px, enable dynamic payload length
+	else
+		data[0] &= ~(1<<pipe); //clear DPL_Px, disable dynamic payload length
+	writeCommand(W_REGISTER+DYNPD, data, 1);
+	
+	if(width==0)
+	{
+		writeCommand(R_REGISTER+FEATURE, data, 1); //read current FEATURE register
+		data[0] |= 0x04; //set bit 2, EN_DPL is needed by any pipe with dynamic payload length
+		writeCommand(W_REGISTER+FEATURE, data, 1);
+	}
+	
+	pipeWidth[pipe] = width;
 }
 
 /** @defgroup nrf24L01p Initialization and configuration functions
@@ -541,6 +911,28 @@ void setDynamicPayloadLength(bool param)
   * @param	size: size of data, 0 if no data is used.
   * @retval status register of nrf24 and error code if any else OK
   */
+#ifdef NRF24_PROFILE
+WriteAnswer writeCommand(unsigned char ins, char* data, int size)
+{
+	WriteAnswer returnValue;
+	bool isRead = (ins<W_REGISTER || ins==R_RX_PAYLOAD || ins==R_RX_PL_WID); //driver passes only valid commands and sizes in a profile
+	int i=0;
+	
+	CSN=0; //select the chip to send spi command
+	returnValue.status = spi(ins); //write command
+	for(i=size-1;i>=0;i--) //LSByte first
+	{
+		if(isRead)
+			data[i] = spi(NOP); //read data
+		else
+			spi(data[i]); //write data
+	}
+	CSN=1;  //deselect the chip
+	
+	returnValue.error = OK;
+	return returnValue;
+}
+#else
 WriteAnswer writeCommand(unsigned char ins, char* data, int size)
 {
 	WriteAnswer returnValue;
@@ -657,7 +1049,7 @@ WriteAnswer writeCommand(unsigned char ins, char* data, int size)
 			default:
 				error = UNKNOWN_COMMAND; //command is not supported on this version
 		} //end of switch
-	}else if( (ins&0xE0) == W_ACK_PAYLOAD ){ //Used in RX mode, Write Payload to be transmitted together with ACK
+	}else if( (ins&0xF8) == W_ACK_PAYLOAD ){ //Used in RX mode, Write Payload to be transmitted together with ACK, 3 LSB are data pipe
 		if(size<=32){ //the maximim size is 32
 			CSN=0; //select the chip to send spi command
 			answer = spi(ins); //command to read RX Payload
@@ -737,9 +1129,12 @@ WriteAnswer writeCommand(unsigned char ins, char* data, int size)
 	returnValue.status = answer;
 	return returnValue;
 }
+#endif
 
+#if NRF24_USE_TX
 /**
-  * @brief  Sends data over air when configured as trasmitter.
+  * @brief  Sends data over air when configured as trasmitter, to the address loaded by selectPeer() (base address after nRF_Config()).
+  *         In CSMA mode the channel is sensed first and data is dropped if it stays busy.
   *         
   * @param	data: data to be sent.
   * @param	size: size of data.
@@ -747,17 +1142,15 @@ WriteAnswer writeCommand(unsigned char ins, char* data, int size)
   */
 void sendData(char *data, int size)
 {
-	int counter = 0; 
-    
-	if((Temp_Addrs[4]==Base_Addrs[4]) && (Temp_Addrs[3]==Base_Addrs[3]) && (Temp_Addrs[2]==Base_Addrs[2]) && (Temp_Addrs[1]==Base_Addrs[1]) && (Temp_Addrs[0]==Base_Addrs[0]))
-	{
-		writeCommand(FLUSH_TX, NULL, 0);
-		writeCommand(W_TX_PAYLOAD, data, size);        
-		CE = 1;
-		delay_us(15+130); //SE is 1 for more than 10us and 130us for TX settling time
-		CE = 0;
-	}
+	if(csmaEnabled==1 && csmaAccess()==0)
+		return; //channel stayed busy, packet is dropped
+	writeCommand(FLUSH_TX, NULL, 0);
+	writeCommand(W_TX_PAYLOAD, data, size);        
+	CE = 1;
+	delay_us(15+130); //SE is 1 for more than 10us and 130us for TX settling time
+	CE = 0;
 }
+#endif
 
 /**
   * @brief  Indicate number of bytes available to be read.
@@ -784,6 +1177,54 @@ void readRxFIFO(char* data, unsigned char size)
 
 }
 
+#if NRF24_USE_RX
+/**
+  * @brief  Replaces the payload that receiver sends with next ACK of a data pipe.
+  *         
+  * @param	pipe: Data pipe number, 0 to 5.
+  * @param	data: Payload to be sent with ACK.
+  * @param	size: size of data, 1 to 32.
+  * @retval NONE.
+  */
+void loadAckPayload(unsigned char pipe, char *data, unsigned char size)
+{
+	if(pipe>5 || size==0 || size>32)
+		return;
+	
+	writeCommand(FLUSH_TX, NULL, 0); //older ACK payloads would be sent first
+	writeCommand(W_ACK_PAYLOAD+pipe, data, size);
+}
+#endif
+
+/**
+  * @brief  Indicates if a signal stronger than -64dBm is received on current channel, valid after 170us in RX mode.
+  *         
+  * @param	NONE
+  * @retval 1: carrier is detected, 0: channel is quiet.
+  */
+bool getCarrierDetect()
+{
+	char data[1];
+	
+	writeCommand(R_REGISTER+RPD, data, 1); //read Received Power Detector
+	return (data[0]&0x01)!=0;
+}
+
+/**
+  * @brief  Reads transmit observe register, PLOS_CNT (bits 7:4) counts lost packets up to 15 and
+  *         is reset by serRFChannel(), ARC_CNT (bits 3:0) is the number of retransmits of last packet.
+  *         
+  * @param	NONE
+  * @retval OBSERVE_TX register value.
+  */
+unsigned char getObserveTx()
+{
+	char data[1];
+	
+	writeCommand(R_REGISTER+OBSERVE_TX, data, 1);
+	return data[0];
+}
+
 /**
   * @brief  Reads status register of nrf24l01p.
   *         
@@ -795,127 +1236,1510 @@ unsigned char getStatus()
 	return writeCommand(NOP, NULL, 0).status;
 }
 
-/** @defgroup nrf24L01p Initialization and configuration functions
- *  @brief   Initialization and configuration functions 
+#if NRF24_USE_TX
+/** @defgroup nrf24L01p TX queue functions
+ *  @brief   TX queue functions
  *
-@verbatim   
+@verbatim
+ ===============================================================================
+							##### TX queue functions  #####
  ===============================================================================
-							##### Interrupt functions  #####
- ===============================================================================  
     [..]
-    This section provides functions needed to send and receive data using nrf24l01p
-    [..] 
+    Packets are queued in RAM and uploaded to the 3 level TX FIFO of nrf24 as
+    soon as there is room, CE is kept high while there is anything to send. The
+    IRQ service routine completes packets in order and reports the result as
+    TX_DONE or MAX_RT event with the ticket returned by txEnqueue().
+    There are two lanes: packets of high priority lane (control frames) take
+    the next free place of TX FIFO before any packet of bulk lane, so their
+    latency does not depend on how many bulk packets are waiting.
+    For high rate streams, setTxCoalescing(n) masks TX_DS: sent packets are
+    counted from FIFO_STATUS and one TX_DONE event is reported per n packets.
+    sendData() must not be used while TX queue is not empty.
+    [..]
 
 @endverbatim
   * @{
   */
 
-// Pin change 0-7 interrupt service routine
 /**
-  * @brief  IRQ signal interrupt service routine
-  *         
-  * @param  NONE
-  * @retval NONE
+  * @brief  Queues a packet in bulk lane to be sent without waiting.
+  *
+  * @param	data: data to be sent.
+  * @param	size: size of data, 1 to 32.
+  * @retval Ticket of the packet, 0 if queue is full or size is not valid.
   */
-interrupt [PC_INT0] void pin_change_isr0(void)
+unsigned char txEnqueue(char *data, unsigned char size)
 {
-	char dataTemp[32] = {0};
-	unsigned char status = 0; 
-	
-	if(IRQ==0){ //if IRQ is falling edge
-		if(operationMode==NRF24_TRANSMITTER) //if it is transmitter
-		{
-			status = getStatus();
-			if(status & W_REGISTER) //Data Sent TX FIFO interrupt
-			{
-				writeCommand(R_REGISTER+FIFO_STATUS, dataTemp, 1); //read FIFO_STATUS
-				if((dataTemp[0] & 0x01)==0) //check RX FIFO empty flag, 0 means some data in RX FIFO
-				{
-					writeCommand(R_RX_PL_WID, dataTemp, 1); //Read RX-payload width
-					if(dataTemp[0]<=32) //if answer is less than 32 byte
-					{
-						receiveBytesAvailable = dataTemp[0]; //number of bytes available in RX FIFO
-					}
-					else{
-						writeCommand(FLUSH_RX, NULL, 0); //flush RX FIFO
-						receiveBytesAvailable = 0; //there is no data available in FIFO
-					}
-				}          
-			}else{ //it is not TX FIFO interrupt
-				;
-			}
-		}                                                     
-		else if(operationMode==NRF24_RECEIVER) //it is receiver
+	return txEnqueueLane(data, size, NRF24_LANE_BULK, 0);
+}
+
+/**
+  * @brief  Queues a packet in a priority lane to be sent without waiting.
+  *         Packets of high priority lane are uploaded to TX FIFO before any bulk packet.
+  *
+  * @param	data: data to be sent.
+  * @param	size: size of data, 1 to 32.
+  * @param	lane: Priority lane of the packet.
+  * @param	preempt: 1: flush bulk packets that are already in TX FIFO, so this packet is the next one
+  *         on air (they are uploaded again later, one of them may be sent twice), 0: wait for TX FIFO.
+  * @retval Ticket of the packet, 0 if lane is full or a parameter is not valid.
+  */
+unsigned char txEnqueueLane(char *data, unsigned char size, NRF24_TxLane lane, bool preempt)
+{
+	return txEnqueuePacket(data, size, lane, preempt, 0);
+}
+
+/**
+  * @brief  Queues a packet in bulk lane that receiver does not acknowledge, even if auto acknowledge is enabled.
+  *         Dynamic ACK has to be enabled by setDynamicAck().
+  *
+  * @param	data: data to be sent.
+  * @param	size: size of data, 1 to 32.
+  * @retval Ticket of the packet, 0 if queue is full or size is not valid.
+  */
+unsigned char txEnqueueNoAck(char *data, unsigned char size)
+{
+	return txEnqueuePacket(data, size, NRF24_LANE_BULK, 0, 1);
+}
+
+/**
+  * @brief  Copies a packet into its lane, used by txEnqueueLane() and txEnqueueNoAck().
+  *
+  * @param	data: data to be sent.
+  * @param	size: size of data, 1 to 32.
+  * @param	lane: Priority lane of the packet.
+  * @param	preempt: 1: flush bulk packets that are already in TX FIFO, 0: wait for TX FIFO.
+  * @param	noAck: 1: packet is not acknowledged, 0: normal packet.
+  * @retval Ticket of the packet, 0 if lane is full or a parameter is not valid.
+  */
+unsigned char txEnqueuePacket(char *data, unsigned char size, NRF24_TxLane lane, bool preempt, bool noAck)
+{
+	unsigned char sreg;
+	unsigned char index;
+	unsigned char ticket = 0;
+	unsigned char flight;
+	unsigned char count;
+	TxLane *txLane;
+
+	if(size==0 || size>32 || lane>NRF24_LANE_BULK)
+		return 0;
+	txLane = &txLanes[lane];
+
+	sreg = SREG; //save global interrupt state
+	#asm("cli")
+	if(txLane->count<txLane->size)
+	{
+		index = txLane->base + (txLane->head+txLane->count) % txLane->size;
+		ticket = txNextTicket;
+		txNextTicket = (txNextTicket==255) ? 1 : txNextTicket+1; //ticket 0 is never used
+
+		txQueue[index].ticket = ticket;
+		txQueue[index].size = size;
+		txQueue[index].noAck = noAck;
+		memcpy(txQueue[index].data, data, size);
+		txResults[ticket % NRF24_TX_STATUS_SIZE].ticket = ticket;
+		txResults[ticket % NRF24_TX_STATUS_SIZE].status = NRF24_TX_PENDING;
+		txLane->count++;
+		txLane->stats.queued++;
+
+		if(preempt==1 && lane==NRF24_LANE_HIGH && txLanes[NRF24_LANE_BULK].inFlight>0)
 		{
-			writeCommand(R_RX_PL_WID, dataTemp, 1); //Read RX-payload width
-			if(dataTemp[0]<=32 && receiveBytesAvailable==0) //if answer is equal or less than 32 byte (maximum valid size)
-			{
-				receiveBytesAvailable = dataTemp[0]; //number of bytes available in RX FIFO
-				writeCommand(R_RX_PAYLOAD, payload, receiveBytesAvailable); //read RX FIFO
-			}
-			else
-			{
-				writeCommand(FLUSH_RX, NULL, 0); //flush RX FIFO
-				receiveBytesAvailable = 0; //there is no data available in FIFO
-			}
+			flight = txLanes[NRF24_LANE_BULK].inFlight;
+			count = txLanes[NRF24_LANE_BULK].count;
+			txFlushFifo();
+			txLanes[NRF24_LANE_BULK].stats.preempted += flight - (count-txLanes[NRF24_LANE_BULK].count); //the ones txFlushFifo has not completed
 		}
 
-		//clear all interupt flags
-		clearInterruptFlag(1,1,1);
-		writeCommand(FLUSH_TX, NULL, 0); //flush TX FIFO
-	}		
+		txKick(); //upload it now if TX FIFO has room
+	}
+	else
+	{
+		txLane->stats.rejected++; //backpressure, producer has to retry
+	}
+	SREG = sreg; //restore global interrupt state
+
+	return ticket;
 }
 
 /**
-  * @brief  Enable Interrupts of nrf24l01p module.
-  *         
-  * @param	RX_DR: if 1: Enable RX_DR interrupt, 0 Disable RX_DR interrupt.
-  * @param	TX_DS: if 1: Enable TX_DS interrupt, 0 Disable TX_DS interrupt.
-  * @param	MAX_RT: if 1: Enable MAX_RT interrupt, 0 Disable MAX_RT interrupt.
-  * @retval NONE.
+  * @brief  Completion status of a queued packet.
+  *
+  * @param	ticket: Ticket returned by txEnqueue().
+  * @retval Status of the packet, NRF24_TX_UNKNOWN if ticket is too old.
   */
-void setInterruptMask(bool RX_DR, bool TX_DS, bool MAX_RT)
+NRF24_TxStatus getTxStatus(unsigned char ticket)
 {
-	char data[1];
-	
-	writeCommand(R_REGISTER+CONFIG, data, 1); //read current config register
-	
-	if(RX_DR==1)
-		data[0] &= 0xBF; //clear bit 6 (enable RX_DR)
-	else
-		data[0] |= 0x40; //set bit 6 (disable RX_DR)
-	
-	if(TX_DS==1)
-		data[0] &= 0xDF; //clear bit 5 (enable TX_DS)
-	else
-		data[0] |= 0x20; //set bit 5 (disable TX_DS)
-	
-	if(MAX_RT==1)
-		data[0] &= 0xEF; //clear bit 4 (enable MAX_RT)
-	else
-		data[0] |= 0x10; //set bit 4 (disable MAX_RT)
-	
-	writeCommand(W_REGISTER+CONFIG, data, 1); //write data
+	if(ticket!=0 && txResults[ticket % NRF24_TX_STATUS_SIZE].ticket==ticket)
+		return txResults[ticket % NRF24_TX_STATUS_SIZE].status;
+
+	return NRF24_TX_UNKNOWN;
 }
 
 /**
-  * @brief  Clears pending interrupt flag if any.
-  *         
-  * @param	RX_DR: clear RX_DR interrupt pending flag.
-  * @param	TX_DS: clear TX_DS interrupt pending flag.
-  * @param	MAX_RT: clear MAX_RT interrupt pending flag.
-  * @retval NONE.
+  * @brief  Indicates how many packets can be queued in bulk lane before txEnqueue() fails.
+  *
+  * @param	NONE.
+  * @retval Number of free places in bulk lane.
   */
-void clearInterruptFlag(bool RX_DR, bool TX_DS, bool MAX_RT)
+unsigned char txQueueFree()
 {
-	char data[1] = {0};
-	
-	if(RX_DR==1)
-		data[0] |= 0x40;
-	if(TX_DS==1)
+	return txLaneFree(NRF24_LANE_BULK);
+}
+
+/**
+  * @brief  Indicates how many packets can be queued in a lane before txEnqueueLane() fails.
+  *
+  * @param	lane: Priority lane.
+  * @retval Number of free places in the lane.
+  */
+unsigned char txLaneFree(NRF24_TxLane lane)
+{
+	return txLanes[lane].size - txLanes[lane].count;
+}
+
+/**
+  * @brief  Copies the counters of a lane.
+  *
+  * @param	lane: Priority lane.
+  * @param	stats: Where to copy the counters.
+  * @retval NONE.
+  */
+void getLaneStats(NRF24_TxLane lane, NRF24_LaneStats *stats)
+{
+	unsigned char sreg;
+
+	sreg = SREG; //save global interrupt state
+	#asm("cli")
+	*stats = txLanes[lane].stats;
+	SREG = sreg; //restore global interrupt state
+}
+
+/**
+  * @brief  Drops every queued packet of all lanes, including the ones uploaded to TX FIFO.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void flushTxQueue()
+{
+	unsigned char sreg;
+	unsigned char lane;
+	TxLane *txLane;
+
+	sreg = SREG; //save global interrupt state
+	#asm("cli")
+	if(txFifoCount>0)
+		txFlushFifo();
+	for(lane=NRF24_LANE_HIGH;lane<=NRF24_LANE_BULK;lane++)
+	{
+		txLane = &txLanes[lane];
+		while(txLane->count>0)
+		{
+			txResults[txQueue[txLane->base+txLane->head].ticket % NRF24_TX_STATUS_SIZE].status = NRF24_TX_DROPPED;
+			txLane->head = (txLane->head+1) % txLane->size;
+			txLane->count--;
+			txLane->stats.dropped++;
+		}
+		txLane->inFlight = 0;
+	}
+	SREG = sreg; //restore global interrupt state
+}
+
+/**
+  * @brief  Uploads queued packets to TX FIFO while it has room, high priority lane first.
+  *         Keeps CE high if anything is uploaded. Must be called with interrupts disabled or from IRQ service routine.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void txKick()
+{
+	unsigned char index;
+	unsigned char lane;
+	TxLane *txLane;
+
+	if(operationMode!=NRF24_TRANSMITTER || beaconActive==1) //queued packets wait for stopBeacon()
+		return;
+
+	while(txFifoCount<3) //TX FIFO is 3 level deep
+	{
+		if(txLanes[NRF24_LANE_HIGH].inFlight<txLanes[NRF24_LANE_HIGH].count)
+			lane = NRF24_LANE_HIGH;
+		else if(txLanes[NRF24_LANE_BULK].inFlight<txLanes[NRF24_LANE_BULK].count)
+			lane = NRF24_LANE_BULK;
+		else
+			break; //nothing more to upload
+
+		txLane = &txLanes[lane];
+		index = txLane->base + (txLane->head+txLane->inFlight) % txLane->size;
+		writeCommand(txQueue[index].noAck ? W_TX_PAYLOAD_NOACK : W_TX_PAYLOAD, txQueue[index].data, txQueue[index].size);
+		txLane->inFlight++;
+		txFifoLane[txFifoCount++] = lane;
+	}
+
+	if(txFifoCount>0)
+		CE = 1; //nrf24 sends TX FIFO back to back and waits in Standby-II when it is empty
+	else
+		CE = 0; //Standby-I
+}
+
+/**
+  * @brief  Removes the packet that is sent first from TX FIFO and from its lane, and reports its result.
+  *
+  * @param	result: How the packet is completed.
+  * @retval NONE.
+  */
+void txComplete(NRF24_TxStatus result)
+{
+	TxLane *txLane = &txLanes[txFifoLane[0]];
+	unsigned char ticket = txQueue[txLane->base+txLane->head].ticket;
+
+	txLastLane = txFifoLane[0];
+	txFifoLane[0] = txFifoLane[1];
+	txFifoLane[1] = txFifoLane[2];
+	txFifoCount--;
+
+	txResults[ticket % NRF24_TX_STATUS_SIZE].status = result;
+	txLane->head = (txLane->head+1) % txLane->size;
+	txLane->count--;
+	txLane->inFlight--;
+	txLastTicket = ticket;
+
+	if(result==NRF24_TX_DELIVERED)
+	{
+		txLane->stats.delivered++;
+		if(txCoalesce==0)
+		{
+			pushEvent(NRF24_EVENT_TX_DONE, 0, 0, ticket);
+		}
+		else if(++txCoalesced>=txCoalesce) //one event per txCoalesce packets
+		{
+			pushEvent(NRF24_EVENT_TX_DONE, 0, txCoalesced, ticket);
+			txCoalesced = 0;
+		}
+	}
+	else
+	{
+		txLane->stats.failed++;
+		pushEvent(NRF24_EVENT_MAX_RT, 0, 0, ticket);
+	}
+}
+
+/**
+  * @brief  Adds ARC_CNT to the lane of the last completed packet, once per TX_DS or MAX_RT interrupt.
+  *         ARC_CNT belongs to the last packet that is sent, so the packets completed before it in
+  *         the same interrupt (coalesced group, two merged TX_DS) have unknown retransmits.
+  *
+  * @param	ticket: Value of txLastTicket before the interrupt completed its packets.
+  * @retval NONE.
+  */
+void txObserve(unsigned char ticket)
+{
+	char observe[1];
+
+	if(txLastTicket==ticket) //no queued packet is completed
+		return;
+
+	writeCommand(R_REGISTER+OBSERVE_TX, observe, 1);
+	txLanes[txLastLane].stats.retries += observe[0] & 0x0F; //ARC_CNT, retransmits of last packet
+	txLanes[txLastLane].stats.observed++;
+}
+
+/**
+  * @brief  Flushes TX FIFO, packets that were uploaded stay in their lanes to be uploaded again.
+  *         Packets whose TX_DS or MAX_RT is latched are completed first, then these flags are cleared.
+  *         Must be called with interrupts disabled or from IRQ service routine.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void txFlushFifo()
+{
+	txCollect(); //sent packets are not uploaded again
+	writeCommand(FLUSH_TX, NULL, 0); //flush TX FIFO
+	clearInterruptFlag(0, 1, 1); //flags of flushed packets must not complete the next ones
+	txLanes[NRF24_LANE_HIGH].inFlight = 0;
+	txLanes[NRF24_LANE_BULK].inFlight = 0;
+	txFifoCount = 0;
+}
+
+/**
+  * @brief  Sets interrupt coalescing of transmitter. In coalescing mode TX_DS interrupt is masked,
+  *         sent packets are counted from FIFO_STATUS by serviceTxQueue() and when TX FIFO drains,
+  *         and one TX_DONE event is reported per count packets. MAX_RT still interrupts.
+  *
+  * @param	count: 0: one TX_DS interrupt and TX_DONE event per packet, 1 to 255: packets per TX_DONE event.
+  * @retval NONE.
+  */
+void setTxCoalescing(unsigned char count)
+{
+	unsigned char sreg;
+
+	sreg = SREG; //save global interrupt state
+	#asm("cli")
+	txCoalesce = count;
+	txDrainWatch = 0;
+	if(operationMode==NRF24_TRANSMITTER && beaconActive==0)
+		setInterruptMask(0, count==0, 1); //TX_DS only if not coalescing, MAX_RT always
+	if(count>0)
+		txDrainCheck();
+	SREG = sreg; //restore global interrupt state
+}
+
+/**
+  * @brief  Counts the packets that are sent, feeds TX FIFO and reports coalesced TX_DONE events.
+  *         Used in coalescing mode, it is also called by serviceEvents().
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void serviceTxQueue()
+{
+	unsigned char sreg;
+	char data[1];
+
+	if(txCoalesce==0 || txFifoCount==0 || operationMode!=NRF24_TRANSMITTER)
+		return;
+
+	sreg = SREG; //save global interrupt state
+	#asm("cli")
+	writeCommand(R_REGISTER+FIFO_STATUS, data, 1); //read FIFO_STATUS
+	txAccount(data[0]);
+	txKick();
+	txDrainCheck();
+	SREG = sreg; //restore global interrupt state
+}
+
+/**
+  * @brief  Completes the packets that FIFO_STATUS proves to be sent. TX FIFO holds 3 packets when
+  *         TX_FULL is set, none when TX_EMPTY is set and at most 2 otherwise.
+  *
+  * @param	fifoStatus: Value of FIFO_STATUS register.
+  * @retval NONE.
+  */
+void txAccount(unsigned char fifoStatus)
+{
+	unsigned char left; //maximum number of packets still in TX FIFO
+
+	if(fifoStatus & 0x10) //TX_EMPTY
+		left = 0;
+	else if(fifoStatus & 0x20) //TX_FULL
+		left = 3;
+	else
+		left = 2;
+
+	while(txFifoCount>left)
+		txComplete(NRF24_TX_DELIVERED);
+
+	if(txFifoCount==0 && txCoalesced>0) //TX FIFO is drained, report the rest
+	{
+		pushEvent(NRF24_EVENT_TX_DONE, 0, txCoalesced, txLastTicket);
+		txCoalesced = 0;
+	}
+}
+
+/**
+  * @brief  Completes queued packets after TX_DS or MAX_RT. TX_DS is cleared at every interrupt, so
+  *         without coalescing it means at least one packet is sent, more if two TX_DS came together,
+  *         FIFO_STATUS tells the rest. On MAX_RT the failed packet is the head of TX FIFO, the packets
+  *         before it are delivered, it is failed and TX FIFO has to be flushed. CE must be low on MAX_RT.
+  *
+  * @param	status: Value of STATUS register, read before its flags are cleared.
+  * @param	fifoStatus: Value of FIFO_STATUS register, read with STATUS.
+  * @retval NONE.
+  */
+void txSettle(unsigned char status, unsigned char fifoStatus)
+{
+	unsigned char left;
+
+	if(txFifoCount==0 || beaconActive==1) //nothing is queued in TX FIFO
+		return;
+
+	if(status & 0x10) //MAX_RT
+	{
+		left = txFifoLeft(fifoStatus);
+		while(txFifoCount>left)
+			txComplete(NRF24_TX_DELIVERED);
+		txComplete(NRF24_TX_MAX_RETRIES); //it stays in TX FIFO till it is flushed
+	}
+	else
+	{
+		if((status & 0x20) && txCoalesce==0) //TX_DS stays set in coalescing mode, it is masked
+			txComplete(NRF24_TX_DELIVERED);
+		txAccount(fifoStatus);
+	}
+}
+
+/**
+  * @brief  Stops TX FIFO and completes the queued packets whose TX_DS or MAX_RT is latched but not
+  *         handled by IRQ service routine yet, then clears the flags that are seen. TX FIFO is flushed
+  *         after MAX_RT.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void txCollect()
+{
+	char data[1];
+	unsigned char status;
+	unsigned char queued = txFifoCount;
+
+	CE = 0; //TX FIFO does not change while it is read
+	status = writeCommand(R_REGISTER+FIFO_STATUS, data, 1).status; //STATUS comes with FIFO_STATUS
+	txSettle(status, data[0]);
+	clearInterruptFlag(0, (status&0x20)!=0, (status&0x10)!=0);
+	if((status & 0x10) && queued>0)
+		txFlushFifo(); //failed packet is still in TX FIFO, nothing is on air after MAX_RT
+}
+
+/**
+  * @brief  Number of packets in TX FIFO while CE is low. FIFO_STATUS tells 0 or 3, 1 and 2 look the
+  *         same, so a dummy payload is uploaded and TX_FULL tells which one, TX FIFO has to be flushed after.
+  *
+  * @param	fifoStatus: Value of FIFO_STATUS register.
+  * @retval Number of packets in TX FIFO, at most txFifoCount.
+  */
+unsigned char txFifoLeft(unsigned char fifoStatus)
+{
+	char data[1] = {0};
+
+	if(fifoStatus & 0x10) //TX_EMPTY
+		return 0;
+	if(fifoStatus & 0x20) //TX_FULL
+		return 3;
+	if(txFifoCount<2)
+		return txFifoCount;
+
+	writeCommand(W_TX_PAYLOAD, data, 1); //dummy, never sent because CE is low
+	writeCommand(R_REGISTER+FIFO_STATUS, data, 1);
+	return (data[0] & 0x20) ? 2 : 1;
+}
+
+/**
+  * @brief  In coalescing mode, TX_DS interrupt is enabled only while the last queued packets are in
+  *         TX FIFO, so the end of transmission interrupts without any per packet interrupt before.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void txDrainCheck()
+{
+	bool drain;
+
+	drain = txFifoCount>0 && txLanes[NRF24_LANE_HIGH].inFlight==txLanes[NRF24_LANE_HIGH].count
+		&& txLanes[NRF24_LANE_BULK].inFlight==txLanes[NRF24_LANE_BULK].count; //nothing waits in RAM
+
+	if(drain!=txDrainWatch && beaconActive==0)
+	{
+		setInterruptMask(0, drain, 1);
+		txDrainWatch = drain;
+	}
+}
+
+/** @defgroup nrf24L01p Beacon functions
+ *  @brief   Beacon functions
+ *
+@verbatim
+ ===============================================================================
+							##### Beacon functions  #####
+ ===============================================================================
+    [..]
+    A beacon payload is uploaded once and nrf24 is told to reuse it
+    (REUSE_TX_PL), then every repeat is just a CE pulse without any SPI
+    transaction. TX_DS interrupt is masked while beacon is loaded, so repeats
+    do not wake the MCU up. Packets of TX queue wait till stopBeacon() is
+    called, sendData() must not be used while beacon is loaded.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Uploads a payload once to be sent again and again by fireBeacon(), repeatBeacon() and burstBeacon().
+  *
+  * @param	data: data to be sent.
+  * @param	size: size of data, 1 to 32.
+  * @retval 1: beacon is loaded, 0: device is not transmitter, TX queue is not empty or size is not valid.
+  */
+bool loadBeacon(char *data, unsigned char size)
+{
+	if(operationMode!=NRF24_TRANSMITTER || size==0 || size>32)
+		return 0;
+	if(txLanes[NRF24_LANE_HIGH].count>0 || txLanes[NRF24_LANE_BULK].count>0) //queued packets would wait behind beacon
+		return 0;
+
+	CE = 0;
+	if(beaconActive==0)
+		setInterruptMask(0, 0, 1); //repeats must not interrupt, MAX_RT still does
+	writeCommand(FLUSH_TX, NULL, 0); //ends reuse of previous beacon
+	writeCommand(W_TX_PAYLOAD, data, size);
+	writeCommand(REUSE_TX_PL, NULL, 0); //keep payload in TX FIFO after it is sent
+	beaconActive = 1;
+
+	return 1;
+}
+
+/**
+  * @brief  Sends the loaded beacon once, no SPI transaction is used.
+  *         Next call must wait for 130us TX settling time and time on air of beacon.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void fireBeacon()
+{
+	if(beaconActive==1)
+	{
+		CE = 1;
+		delay_us(15); //CE is 1 for more than 10us
+		CE = 0;
+	}
+}
+
+/**
+  * @brief  Sends the loaded beacon several times with a fixed interval.
+  *
+  * @param	count: Number of times beacon is sent.
+  * @param	interval: Time between two beacons in ms, at least 1 ms.
+  * @retval NONE.
+  */
+void repeatBeacon(unsigned int count, unsigned int interval)
+{
+	if(interval==0)
+		interval = 1; //time on air of a 32 byte beacon at 250Kbps plus TX settling time is about 1.5ms
+
+	while(count>0)
+	{
+		fireBeacon();
+		count--;
+		if(count>0)
+			delay_ms(interval);
+	}
+}
+
+/**
+  * @brief  Sends the loaded beacon back to back for a while, CE is kept high so nrf24 repeats it by itself.
+  *         Used as wake-up burst.
+  *
+  * @param	duration: Length of burst in ms.
+  * @retval NONE.
+  */
+void burstBeacon(unsigned int duration)
+{
+	if(beaconActive==1)
+	{
+		CE = 1;
+		delay_ms(duration);
+		CE = 0;
+	}
+}
+
+/**
+  * @brief  Removes the beacon from TX FIFO and enables TX_DS interrupt again.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void stopBeacon()
+{
+	unsigned char sreg;
+
+	if(beaconActive==1)
+	{
+		CE = 0;
+		writeCommand(FLUSH_TX, NULL, 0); //ends reuse of beacon
+		clearInterruptFlag(0, 1, 1);
+		setInterruptMask(0, txCoalesce==0, 1); //enable TX_DS if not coalescing, and MAX_RT
+
+		sreg = SREG; //save global interrupt state
+		#asm("cli")
+		beaconActive = 0;
+		txDrainWatch = 0;
+		txKick(); //send packets queued meanwhile
+		if(txCoalesce>0)
+			txDrainCheck();
+		SREG = sreg; //restore global interrupt state
+	}
+}
+
+#endif
+
+/** @defgroup nrf24L01p Polled mode functions
+ *  @brief   Polled mode functions
+ *
+@verbatim
+ ===============================================================================
+						##### Polled mode functions  #####
+ ===============================================================================
+    [..]
+    For latency critical links, pin change interrupt of IRQ can be disabled by
+    setPolledMode(1) and the application calls pollReceive() in a tight loop.
+    RX_P_NO of STATUS is read, so packets that wait behind the first one are
+    found too, and the payload is read straight into the buffer of caller,
+    there is no interrupt entry, event queue or copy.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Enables or Disables polled mode, pin change interrupt of IRQ is disabled in polled mode.
+  *
+  * @param	param: 1: polled mode, 0: interrupt mode.
+  * @retval NONE.
+  */
+void setPolledMode(bool param)
+{
+	if(param==1)
+	{
+		PCMSK0 &= ~(1<<PCINT0); //IRQ does not call pin_change_isr0 any more
+	}
+	else
+	{
+		clearInterruptFlag(1, 1, 1); //IRQ has to be high before first falling edge
+		PCIFR = (1<<PCIF0); //clear pending pin change interrupt
+		PCMSK0 |= (1<<PCINT0);
+	}
+}
+
+/**
+  * @brief  Tells if polled mode is active.
+  *
+  * @param	NONE.
+  * @retval 1: polled mode, 0: interrupt mode.
+  */
+bool getPolledMode()
+{
+	return (PCMSK0 & (1<<PCINT0))==0;
+}
+
+#if NRF24_USE_RX
+/**
+  * @brief  Reads a received packet if any, used in polled mode of receiver.
+  *
+  * @param	data: Array to store received packet, at least 32 byte.
+  * @param	pipe: Stores data pipe number of the packet, can be NULL.
+  * @retval Size of received packet, 0 if nothing is received.
+  */
+unsigned char pollReceive(char *data, unsigned char *pipe)
+{
+	char dataTemp[1];
+	unsigned char rxPipe;
+	unsigned char width;
+
+	//IRQ is not enough, it goes high when RX_DR is cleared while more packets wait in RX FIFO
+	rxPipe = (writeCommand(NOP, NULL, 0).status>>1) & 0x07; //RX_P_NO bits of status register, 7 means RX FIFO is empty
+	if(rxPipe>5)
+		return 0;
+	rxTimestamp = getTimestamp();
+
+	width = pipeWidth[rxPipe];
+	if(width==0) //dynamic payload length on this pipe
+	{
+		writeCommand(R_RX_PL_WID, dataTemp, 1); //Read RX-payload width
+		width = dataTemp[0];
+	}
+
+	if(width==0 || width>32) //width is not valid, the packet is corrupted
+	{
+		writeCommand(FLUSH_RX, NULL, 0); //flush RX FIFO
+		dataTemp[0] = 0x40;
+		writeCommand(W_REGISTER+STATUS, dataTemp, 1); //clear RX_DR, RX FIFO is empty
+		return 0;
+	}
+
+	writeCommand(R_RX_PAYLOAD, data, width); //read RX FIFO into buffer of caller
+	if(pipe!=NULL)
+		*pipe = rxPipe;
+
+	writeCommand(R_REGISTER+FIFO_STATUS, dataTemp, 1);
+	if(dataTemp[0] & 0x01) //RX_EMPTY, clear RX_DR only when RX FIFO is drained
+	{
+		dataTemp[0] = 0x40;
+		writeCommand(W_REGISTER+STATUS, dataTemp, 1);
+	}
+
+	return width;
+}
+#endif
+
+/** @defgroup nrf24L01p Power management functions
+ *  @brief   Power management functions
+ *
+@verbatim
+ ===============================================================================
+					##### Power management functions  #####
+ ===============================================================================
+    [..]
+    The driver knows the state of nrf24 (Power Down, Standby-I, Standby-II,
+    TX, RX) and the time each transition takes. Between bursts, a node can
+    call powerIdle() with the wake latency it can afford; the lowest power
+    state that can still wake up in time is selected:
+
+      (+) Power Down    (0.9uA): 1.5ms crystal start up + 130us settling
+      (+) Standby-I     (26uA) : 130us settling
+      (+) RX            (13.5mA): no delay, the only choice below 130us
+    Standby-II (320uA) is entered by a transmitter that keeps CE high with
+    empty TX FIFO, it wakes up as slow as Standby-I so it is never selected.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Indicates the state of the module.
+  *
+  * @param	NONE.
+  * @retval Current power state.
+  */
+NRF24_PowerState getPowerState()
+{
+	if(powerUp==0)
+		return NRF24_POWER_DOWN;
+	if(CE==0)
+		return NRF24_STANDBY_I;
+	if(operationMode==NRF24_RECEIVER)
+		return NRF24_RX_MODE;
+#if NRF24_USE_TX
+	if(txFifoCount>0 || beaconActive==1)
+		return NRF24_TX_MODE;
+#endif
+	return NRF24_STANDBY_II; //transmitter with CE high and nothing to send
+}
+
+/**
+  * @brief  Time needed to go from one state to another one.
+  *
+  * @param	from: Current state.
+  * @param	to: Next state.
+  * @retval Transition time in us.
+  */
+unsigned int getTransitionTime(NRF24_PowerState from, NRF24_PowerState to)
+{
+	unsigned int time = 0;
+
+	if(to==NRF24_POWER_DOWN || to==from)
+		return 0;
+	if(from==NRF24_POWER_DOWN)
+		time += NRF24_TPD2STBY; //crystal oscillator start up
+	if(to==NRF24_TX_MODE || to==NRF24_RX_MODE)
+		time += NRF24_TSTBY2A; //PLL settling
+	return time;
+}
+
+/**
+  * @brief  Selects the lowest power state that can still start TX or RX within the given latency.
+  *
+  * @param	wakeLatency: Maximum allowed time in us from wake up request to TX or RX mode.
+  * @retval Idle power state.
+  */
+NRF24_PowerState selectIdleState(unsigned int wakeLatency)
+{
+	if(wakeLatency>=getTransitionTime(NRF24_POWER_DOWN, NRF24_RX_MODE))
+		return NRF24_POWER_DOWN;
+	if(wakeLatency>=getTransitionTime(NRF24_STANDBY_I, NRF24_RX_MODE))
+		return NRF24_STANDBY_I;
+	if(operationMode==NRF24_RECEIVER)
+		return NRF24_RX_MODE; //receiver has to keep listening
+	return NRF24_STANDBY_I; //no state of transmitter is faster than Standby-I
+}
+
+/**
+  * @brief  Goes to the lowest power state that meets the wake latency.
+  *
+  * @param	wakeLatency: Maximum allowed time in us from wake up request to TX or RX mode.
+  * @retval Selected power state.
+  */
+NRF24_PowerState powerIdle(unsigned int wakeLatency)
+{
+	NRF24_PowerState state = selectIdleState(wakeLatency);
+
+	setPowerState(state);
+	return state;
+}
+
+/**
+  * @brief  Moves the module to a power state, waits exactly the transition time needed.
+  *         TX queue should be empty before going to a standby or power down state.
+  *
+  * @param	state: Next power state.
+  * @retval NONE.
+  */
+void setPowerState(NRF24_PowerState state)
+{
+	NRF24_PowerState current = getPowerState();
+
+	if(state==current)
+		return;
+
+	if(state==NRF24_POWER_DOWN)
+	{
+		CE = 0;
+		setPowerDown();
+		return;
+	}
+
+	if(current==NRF24_POWER_DOWN) //every other state starts from Standby-I
+	{
+		setPowerUp();
+		delay_us(NRF24_TPD2STBY); //crystal oscillator start up
+	}
+
+	switch(state){
+		case NRF24_STANDBY_I:
+			CE = 0;
+		break;
+
+		case NRF24_STANDBY_II:
+			if(operationMode!=NRF24_TRANSMITTER)
+				switchRole(NRF24_TRANSMITTER);
+			CE = 1; //PTX with CE high and empty TX FIFO
+		break;
+
+		case NRF24_TX_MODE:
+			switchRole(NRF24_TRANSMITTER); //TX starts as soon as anything is queued
+		break;
+
+		case NRF24_RX_MODE:
+			switchRole(NRF24_RECEIVER); //waits for RX settling
+		break;
+	}
+}
+
+#if NRF24_USE_TX
+/** @defgroup nrf24L01p CSMA functions
+ *  @brief   CSMA functions
+ *
+@verbatim
+ ===============================================================================
+							##### CSMA functions  #####
+ ===============================================================================
+    [..]
+    In CSMA mode, sendData() listens before it talks: nrf24 is put in RX for
+    170us and RPD shows if anybody is sending on the channel. If the channel
+    is busy, sender waits a random number of backoff units, from 0 to
+    2^BE-1, BE grows from NRF24_CSMA_MIN_BE to NRF24_CSMA_MAX_BE after each
+    busy try. After NRF24_CSMA_MAX_BACKOFFS busy tries the packet is dropped
+    and counted as channel access failure. Use srand() to give every node its
+    own random sequence.
+    Only sendData() is sensed. TX queue is fed by IRQ service routine, which
+    can not wait 170us for RPD and backoff units, so txEnqueue() packets are
+    sent without listening; do not mix them with CSMA on a busy channel.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Enables or Disables listen before talk of sendData(), TX queue is never sensed.
+  *
+  * @param	param: 1: Enable, 0:Disable.
+  * @retval NONE.
+  */
+void setCSMA(bool param)
+{
+	csmaEnabled = param;
+}
+
+/**
+  * @brief  Reads CSMA counters.
+  *
+  * @param	stats: Stores the counters.
+  * @retval NONE.
+  */
+void getCSMAStats(NRF24_CsmaStats *stats)
+{
+	*stats = csmaStats;
+}
+
+/**
+  * @brief  Senses the channel and backs off while it is busy.
+  *
+  * @param	NONE.
+  * @retval 1: channel is clear, 0: channel access failure.
+  */
+bool csmaAccess()
+{
+	unsigned char be = NRF24_CSMA_MIN_BE; //backoff exponent
+	unsigned char tries = 0;
+	unsigned int units;
+
+	while(channelClear()==0)
+	{
+		csmaStats.deferrals++;
+		if(tries>=NRF24_CSMA_MAX_BACKOFFS)
+		{
+			csmaStats.failures++;
+			return 0;
+		}
+		tries++;
+
+		units = rand() & ((1<<be)-1);
+		csmaStats.backoffTime += (unsigned long)units*NRF24_CSMA_UNIT;
+		while(units>0)
+		{
+			delay_us(NRF24_CSMA_UNIT);
+			units--;
+		}
+		if(be<NRF24_CSMA_MAX_BE)
+			be++;
+	}
+
+	return 1;
+}
+
+/**
+  * @brief  Puts transmitter in RX for a moment and reads RPD. Module has to be in Standby-I.
+  *
+  * @param	NONE.
+  * @retval 1: channel is clear, 0: carrier is detected.
+  */
+bool channelClear()
+{
+	char data[1];
+	char config;
+	bool clear;
+	unsigned char status;
+
+	csmaStats.senses++;
+	status = writeCommand(R_REGISTER+CONFIG, data, 1).status; //read current config register
+	config = data[0];
+	data[0] |= 0x01; //PRIM_RX, RX_DR is masked in transmitter
+	writeCommand(W_REGISTER+CONFIG, data, 1);
+
+	CE = 1;
+	delay_us(130+40); //RX settling time, RPD is valid after 40us in RX mode
+	clear = (getCarrierDetect()==0);
+	CE = 0;
+
+	data[0] = config;
+	if((writeCommand(W_REGISTER+CONFIG, data, 1).status & ~status) & 0x40) //back to PTX, RX_DR rose while sensing
+	{
+		writeCommand(FLUSH_RX, NULL, 0); //packet heard while sensing is not for us, ACK payloads are kept
+		clearInterruptFlag(1, 0, 0);
+	}
+
+	return clear;
+}
+
+/** @defgroup nrf24L01p Addressing functions
+ *  @brief   Addressing functions
+ *
+@verbatim
+ ===============================================================================
+						##### Addressing functions  #####
+ ===============================================================================
+    [..]
+    Addresses of TX_ADDR and RX_ADDR_P0 are kept in RAM, so a destination
+    change only writes what differs. nrf24 takes address bytes LSB first, a
+    shorter write changes the LSBs and keeps the rest, so only bytes from
+    the first one that differs (MSB side) down to LSB are sent. Peers that
+    share all bytes but the LSB cost 2 SPI bytes per register, the loaded
+    peer costs none. RX_ADDR_P0 follows TX_ADDR only in PTX with auto ACK
+    and gets back the base address when switchRole() makes it a receiver.
+    Define NRF24_FULL_ADDRESS_WRITE to write whole addresses instead.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Sets the address of a peer of sendDataTo().
+  *
+  * @param	peer: Index of the peer, 0 to NRF24_PEER_TABLE_SIZE-1.
+  * @param	address: NRF24_ADDRESS_WIDTH bytes, first byte is MSB like Base_Addrs.
+  * @retval 1: address is set, 0: peer is not valid.
+  */
+bool setPeerAddress(unsigned char peer, char *address)
+{
+	if(peer>=NRF24_PEER_TABLE_SIZE)
+		return 0;
+
+	memcpy(peerAddress[peer], address, NRF24_ADDRESS_WIDTH);
+	if(peer==loadedPeer)
+		loadedPeer = PEER_UNKNOWN; //registers are compared again
+	return 1;
+}
+
+#ifndef NRF24_PROFILE
+/**
+  * @brief  Changes the base address of this device, RX_ADDR_P0 of receiver and peer NRF24_PEER_BASE.
+  *
+  * @param	address: 5 bytes, first byte is MSB.
+  * @retval NONE.
+  */
+void setBaseAddress(char *address)
+{
+	unsigned char sreg;
+
+	memcpy(Base_Addrs, address, 5);
+	sreg = SREG; //save global interrupt state
+	#asm("cli")
+	if(operationMode==NRF24_RECEIVER || ackEnabled==0)
+		writeAddress(RX_ADDR_P0, Base_Addrs, rx0Address);
+	SREG = sreg; //restore global interrupt state
+	if(loadedPeer==NRF24_PEER_BASE)
+		loadedPeer = PEER_UNKNOWN;
+}
+#endif
+
+/**
+  * @brief  Loads the address of a peer to TX_ADDR (and RX_ADDR_P0 for ACKs), next packets are sent to it.
+  *         Address is not changed while queued packets or a beacon wait for current address.
+  *
+  * @param	peer: Index of the peer, or NRF24_PEER_BASE for the base address of nRF_Config().
+  * @retval 1: peer is loaded, 0: peer is not valid or TX queue is not empty.
+  */
+bool selectPeer(unsigned char peer)
+{
+	unsigned char address[NRF24_ADDRESS_WIDTH];
+	unsigned char sreg;
+
+	addressStats.selects++;
+	if(peer==loadedPeer)
+		return 1; //the common case of polling one peer, no SPI
+
+	if(peer==NRF24_PEER_BASE)
+		getBaseAddress(address);
+	else if(peer<NRF24_PEER_TABLE_SIZE)
+		memcpy(address, peerAddress[peer], NRF24_ADDRESS_WIDTH);
+	else
+		return 0;
+
+	if(memcmp(address, txAddress, NRF24_ADDRESS_WIDTH)!=0 && (txLanes[NRF24_LANE_HIGH].count>0 || txLanes[NRF24_LANE_BULK].count>0 || beaconActive==1))
+		return 0; //they have to be sent to current address first
+
+	sreg = SREG; //save global interrupt state
+	#asm("cli")
+	writeAddress(TX_ADDR, address, txAddress);
+	if(ackEnabled==1 && operationMode==NRF24_TRANSMITTER)
+		writeAddress(RX_ADDR_P0, address, rx0Address); //ACK is sent to the address of the packet
+	SREG = sreg; //restore global interrupt state
+
+	loadedPeer = peer;
+	return 1;
+}
+
+/**
+  * @brief  Sends data to a peer, its address is only written if it is not loaded yet.
+  *
+  * @param	peer: Index of the peer, or NRF24_PEER_BASE.
+  * @param	data: data to be sent.
+  * @param	size: size of data.
+  * @retval NONE.
+  */
+void sendDataTo(unsigned char peer, char *data, int size)
+{
+	if(selectPeer(peer)==1)
+		sendData(data, size);
+}
+
+/**
+  * @brief  Reads addressing counters.
+  *
+  * @param	stats: Stores the counters.
+  * @retval NONE.
+  */
+void getAddressStats(NRF24_AddressStats *stats)
+{
+	*stats = addressStats;
+}
+
+/**
+  * @brief  Copies the base address of this device to RAM, it is in flash in a profile.
+  *
+  * @param	address: Array of NRF24_ADDRESS_WIDTH bytes.
+  * @retval NONE.
+  */
+void getBaseAddress(unsigned char *address)
+{
+	unsigned char i;
+
+	for(i=0;i<NRF24_ADDRESS_WIDTH;i++)
+		address[i] = Base_Addrs[i];
+}
+
+/**
+  * @brief  Writes an address register from the first byte that differs from what it holds.
+  *
+  * @param	reg: TX_ADDR or RX_ADDR_P0.
+  * @param	address: New address, first byte is MSB.
+  * @param	loaded: What the register holds, updated.
+  * @retval NONE.
+  */
+void writeAddress(unsigned char reg, unsigned char *address, unsigned char *loaded)
+{
+	unsigned char first = 0; //MSB side byte that differs first
+
+	while(first<NRF24_ADDRESS_WIDTH && address[first]==loaded[first])
+		first++;
+	if(first==NRF24_ADDRESS_WIDTH)
+		return; //register holds it already
+#ifdef NRF24_FULL_ADDRESS_WRITE
+	first = 0;
+#endif
+
+	writeCommand(W_REGISTER+reg, (char*)&address[first], NRF24_ADDRESS_WIDTH-first); //last byte (LSB) is sent first
+	memcpy(&loaded[first], &address[first], NRF24_ADDRESS_WIDTH-first);
+	addressStats.writes++;
+	addressStats.bytes += 1+NRF24_ADDRESS_WIDTH-first;
+}
+#endif
+
+/** @defgroup nrf24L01p Initialization and configuration functions
+ *  @brief   Initialization and configuration functions 
+ *
+@verbatim   
+ ===============================================================================
+							##### Interrupt functions  #####
+ ===============================================================================  
+    [..]
+    This section provides functions needed to send and receive data using nrf24l01p
+    [..] 
+
+@endverbatim
+  * @{
+  */
+
+// Pin change 0-7 interrupt service routine
+/**
+  * @brief  IRQ signal interrupt service routine
+  *         
+  * @param  NONE
+  * @retval NONE
+  */
+interrupt [PC_INT0] void pin_change_isr0(void)
+{
+	char dataTemp[32] = {0};
+	unsigned char status = 0; 
+#if NRF24_USE_TX
+	unsigned char fifoStatus = 0;
+	unsigned char ticket = 0;
+#endif
+#if NRF24_USE_RX
+	unsigned char pipe = 0;
+#endif
+	unsigned char width = 0;
+	unsigned long irqTime;
+	
+	irqTime = getTimestamp(); //as close to the falling edge of IRQ as possible
+	while(IRQ==0){ //IRQ stays low as long as any interrupt flag is set
+#if NRF24_USE_TX
+		if(operationMode==NRF24_TRANSMITTER) //if it is transmitter
+		{
+			status = writeCommand(R_REGISTER+FIFO_STATUS, dataTemp, 1).status; //STATUS comes with FIFO_STATUS
+			fifoStatus = dataTemp[0];
+			ticket = txLastTicket;
+			if((status & 0x10) && txFifoCount>0)
+				CE = 0; //failed packet is not sent again when MAX_RT is cleared, it is flushed below
+			clearInterruptFlag((status&0x40)!=0, (status&0x20)!=0, (status&0x10)!=0); //clear only seen flags, new ones keep IRQ low
+			if(status & W_REGISTER) //Data Sent TX FIFO interrupt
+			{
+				if((fifoStatus & 0x01)==0) //check RX FIFO empty flag, 0 means ACK payload in RX FIFO
+				{
+					writeCommand(R_RX_PL_WID, dataTemp, 1); //Read RX-payload width
+					width = dataTemp[0];
+					if(width==0 || width>32) //width is not valid, the packet is corrupted
+					{
+						writeCommand(FLUSH_RX, NULL, 0); //flush RX FIFO
+					}
+					else if(receiveBytesAvailable==0) //last packet is read by application
+					{
+						receiveBytesAvailable = width;
+						receivePipe = (status>>1) & 0x07;
+						rxTimestamp = irqTime;
+						writeCommand(R_RX_PAYLOAD, payload, width); //read ACK payload
+						pushEvent(NRF24_EVENT_RX_READY, receivePipe, width, 0);
+					}
+					else //last packet is not read yet, ACK payload is droped
+					{
+						writeCommand(FLUSH_RX, NULL, 0); //flush RX FIFO
+						pushEvent(NRF24_EVENT_RX_OVERFLOW, (status>>1) & 0x07, width, 0);
+					}
+				}
+				
+				if(txFifoCount==0) //packet is sent by sendData
+					pushEvent(NRF24_EVENT_TX_DONE, 0, 0, 0);
+			}
+			if(status & 0x10) //Maximum number of TX retransmits interrupt
+			{
+				if(beaconActive==1) //beacon stays in TX FIFO, next CE pulse sends it again
+				{
+					pushEvent(NRF24_EVENT_MAX_RT, 0, 0, 0);
+				}
+				else if(txFifoCount==0) //packet is sent by sendData
+				{
+					CE = 0;
+					writeCommand(FLUSH_TX, NULL, 0); //failed packet stays in TX FIFO till it is flushed
+					pushEvent(NRF24_EVENT_MAX_RT, 0, 0, 0);
+				}
+				else
+				{
+					txSettle(status, fifoStatus); //delivered packets before the failed one, then the failed one
+					txObserve(ticket); //before the flush, ARC_CNT of the failed packet
+					txFlushFifo(); //the others are uploaded again by txKick
+				}
+			}
+			else
+			{
+				txSettle(status, fifoStatus); //completes queued packets that are sent
+				txObserve(ticket);
+			}
+			txKick(); //feed TX FIFO from TX queue
+			if(txCoalesce>0)
+				txDrainCheck();
+		}
+#endif
+#if NRF24_USE_RX
+		if(operationMode==NRF24_RECEIVER) //it is receiver
+		{
+			//clear all interupt flags, status register before clearing comes with it
+			dataTemp[0] = 0x70;
+			status = writeCommand(W_REGISTER+STATUS, dataTemp, 1).status;
+			pipe = (status>>1) & 0x07; //RX_P_NO bits of status register, 7 means RX FIFO is empty
+			if(pipe>5)
+				continue;
+			
+			width = pipeWidth[pipe];
+			if(width==0) //dynamic payload length on this pipe
+			{
+				writeCommand(R_RX_PL_WID, dataTemp, 1); //Read RX-payload width
+				width = dataTemp[0];
+			}
+			
+			if(width==0 || width>32) //width is not valid (maximum valid size is 32 byte), the packet is corrupted
+			{
+				writeCommand(FLUSH_RX, NULL, 0); //flush RX FIFO
+			}
+			else if(receiveBytesAvailable==0) //last packet is read by application
+			{
+				receiveBytesAvailable = width; //number of bytes available in RX FIFO
+				receivePipe = pipe;
+				rxTimestamp = irqTime;
+				writeCommand(R_RX_PAYLOAD, payload, receiveBytesAvailable); //read RX FIFO
+				pushEvent(NRF24_EVENT_RX_READY, receivePipe, receiveBytesAvailable, 0);
+			}
+			else //last packet is not read yet, new packet is droped
+			{
+				writeCommand(FLUSH_RX, NULL, 0); //flush RX FIFO
+				pushEvent(NRF24_EVENT_RX_OVERFLOW, pipe, width, 0);
+			}
+		}
+#endif
+	}		
+}
+
+/**
+  * @brief  Enable Interrupts of nrf24l01p module.
+  *         
+  * @param	RX_DR: if 1: Enable RX_DR interrupt, 0 Disable RX_DR interrupt.
+  * @param	TX_DS: if 1: Enable TX_DS interrupt, 0 Disable TX_DS interrupt.
+  * @param	MAX_RT: if 1: Enable MAX_RT interrupt, 0 Disable MAX_RT interrupt.
+  * @retval NONE.
+  */
+void setInterruptMask(bool RX_DR, bool TX_DS, bool MAX_RT)
+{
+	char data[1];
+	
+	writeCommand(R_REGISTER+CONFIG, data, 1); //read current config register
+	
+	if(RX_DR==1)
+		data[0] &= 0xBF; //clear bit 6 (enable RX_DR)
+	else
+		data[0] |= 0x40; //set bit 6 (disable RX_DR)
+	
+	if(TX_DS==1)
+		data[0] &= 0xDF; //clear bit 5 (enable TX_DS)
+	else
+		data[0] |= 0x20; //set bit 5 (disable TX_DS)
+	
+	if(MAX_RT==1)
+		data[0] &= 0xEF; //clear bit 4 (enable MAX_RT)
+	else
+		data[0] |= 0x10; //set bit 4 (disable MAX_RT)
+	
+	writeCommand(W_REGISTER+CONFIG, data, 1); //write data
+}
+
+/**
+  * @brief  Clears pending interrupt flag if any.
+  *         
+  * @param	RX_DR: clear RX_DR interrupt pending flag.
+  * @param	TX_DS: clear TX_DS interrupt pending flag.
+  * @param	MAX_RT: clear MAX_RT interrupt pending flag.
+  * @retval NONE.
+  */
+void clearInterruptFlag(bool RX_DR, bool TX_DS, bool MAX_RT)
+{
+	char data[1] = {0};
+	
+	if(RX_DR==1)
+		data[0] |= 0x40;
+	if(TX_DS==1)
 		data[0] |= 0x20;
 	if(MAX_RT==1)
 		data[0] |= 0x10;
 	
 	writeCommand(W_REGISTER+STATUS, data, 1); //write 1 to clear interrupt flags
 }
+
+/**
+  * @brief  Sets the clock used to timestamp received packets, it is called from IRQ service routine.
+  *         
+  * @param	source: Function returning current time in us (e.g. from a timer), NULL to disable timestamps.
+  * @retval NONE.
+  */
+void setTimestampSource(NRF24_TimestampSource source)
+{
+	timestampSource = source;
+}
+
+/**
+  * @brief  Clock given to setTimestampSource(), lets other modules know if time can be measured.
+  *         
+  * @param	NONE.
+  * @retval Timestamp source, NULL if there is none.
+  */
+NRF24_TimestampSource getTimestampSource()
+{
+	return timestampSource;
+}
+
+/**
+  * @brief  Reads the clock given to setTimestampSource().
+  *         
+  * @param	NONE.
+  * @retval Current time in us, 0 if there is no timestamp source.
+  */
+unsigned long getTimestamp()
+{
+	if(timestampSource==NULL)
+		return 0;
+	return timestampSource();
+}
+
+/**
+  * @brief  Time of IRQ of the last received packet, valid while it is not read by readRxFIFO().
+  *         In polled mode it is the time pollReceive() has found the packet in RX FIFO.
+  *         
+  * @param	NONE.
+  * @retval Time in us.
+  */
+unsigned long getRxTimestamp()
+{
+	return rxTimestamp;
+}
+
+/** @defgroup nrf24L01p Event functions
+ *  @brief   Event functions
+ *
+@verbatim
+ ===============================================================================
+							##### Event functions  #####
+ ===============================================================================
+    [..]
+    The IRQ service routine only records what happened; the recorded events are
+    dispatched to the registered callbacks by serviceEvents() in main context.
+    Call serviceEvents() each time the MCU wakes up, so the reaction time is
+    bounded by the interrupt latency instead of the main loop period:
+
+      #asm("cli")
+      if(eventsPending()==0){
+          SMCR=(1<<SE); //idle, the pin change interrupt of IRQ wakes the MCU up
+          #asm("sei")
+          #asm("sleep")
+          SMCR=0;
+      }
+      #asm("sei")
+      serviceEvents();
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Registers the function to be called when an event is dispatched.
+  *
+  * @param	type: Type of event.
+  * @param	callback: Function to be called, NULL to ignore this type of event.
+  * @retval NONE.
+  */
+void setEventCallback(NRF24_EventType type, NRF24_EventCallback callback)
+{
+	if(type<=NRF24_EVENT_RX_OVERFLOW)
+		eventCallbacks[type] = callback;
+}
+
+/**
+  * @brief  Dispatches all pending events to their callbacks.
+  *
+  * @param	NONE.
+  * @retval Number of dispatched events.
+  */
+unsigned char serviceEvents()
+{
+	NRF24_Event event;
+	unsigned char sreg;
+	unsigned char dispatched = 0;
+
+#if NRF24_USE_TX
+	serviceTxQueue(); //count sent packets in TX coalescing mode
+#endif
+
+	while(eventCount>0)
+	{
+		sreg = SREG; //save global interrupt state
+		#asm("cli")
+		event = eventQueue[eventHead]; //pop the oldest event
+		eventHead = (eventHead+1) % NRF24_EVENT_QUEUE_SIZE;
+		eventCount--;
+		SREG = sreg; //restore global interrupt state
+
+		if(eventCallbacks[event.type]!=NULL)
+			eventCallbacks[event.type](&event);
+		dispatched++;
+	}
+
+	return dispatched;
+}
+
+/**
+  * @brief  Indicates number of events waiting to be dispatched.
+  *
+  * @param	NONE.
+  * @retval Number of pending events.
+  */
+unsigned char eventsPending()
+{
+	return eventCount;
+}
+
+/**
+  * @brief  Queues an event, called from IRQ service routine. Event is lost if queue is full.
+  *
+  * @param	type: Type of event.
+  * @param	pipe: Data pipe number of the packet.
+  * @param	length: Length of the packet.
+  * @param	ticket: Ticket of the sent packet.
+  * @retval NONE.
+  */
+void pushEvent(NRF24_EventType type, unsigned char pipe, unsigned char length, unsigned char ticket)
+{
+	unsigned char index;
+
+	if(eventCount<NRF24_EVENT_QUEUE_SIZE)
+	{
+		index = (eventHead+eventCount) % NRF24_EVENT_QUEUE_SIZE;
+		eventQueue[index].type = type;
+		eventQueue[index].pipe = pipe;
+		eventQueue[index].length = length;
+		eventQueue[index].ticket = ticket;
+		eventCount++;
+	}
+}
@@ -34,12 +34,134 @@
 #define __NRF24L01P_H
 
 /* Includes ------------------------------------------------------------------*/
+#ifdef __CODEVISIONAVR__
 #include <mega88a.h>
+#endif
 #include <stdbool.h>
 
+#ifdef __CODEVISIONAVR__ //types and constants of this file are also used by host programs
 #define CE PORTB.1
 #define CSN PORTB.2
 #define IRQ PINB.0
+#endif
+
+#ifndef NRF24_EVENT_QUEUE_SIZE
+#define NRF24_EVENT_QUEUE_SIZE 4 //number of events that can wait for serviceEvents()
+#endif
+
+#ifndef NRF24_TX_QUEUE_SIZE
+#define NRF24_TX_QUEUE_SIZE 4 //number of packets that can wait in bulk TX lane (34 byte RAM each)
+#endif
+
+#ifndef NRF24_TX_HIGH_QUEUE_SIZE
+#define NRF24_TX_HIGH_QUEUE_SIZE 2 //number of packets that can wait in high priority TX lane (34 byte RAM each)
+#endif
+
+#ifndef NRF24_TPD2STBY
+#define NRF24_TPD2STBY 1500 //us, Power Down to Standby-I (crystal start up), 4500 for crystals with Ls=90mH
+#endif
+
+#define NRF24_TSTBY2A 130 //us, Standby to TX or RX mode (PLL settling)
+
+#ifndef NRF24_CSMA_UNIT
+#define NRF24_CSMA_UNIT 250 //us, backoff unit, about time on air of a 32 byte packet at 1Mbps
+#endif
+
+#ifndef NRF24_CSMA_MIN_BE
+#define NRF24_CSMA_MIN_BE 2 //backoff exponent of first busy try
+#endif
+
+#ifndef NRF24_CSMA_MAX_BE
+#define NRF24_CSMA_MAX_BE 5 //largest backoff exponent
+#endif
+
+#ifndef NRF24_CSMA_MAX_BACKOFFS
+#define NRF24_CSMA_MAX_BACKOFFS 4 //busy tries before the packet is dropped
+#endif
+
+#ifndef NRF24_TX_STATUS_SIZE
+#define NRF24_TX_STATUS_SIZE 8 //number of recent tickets whose completion status is kept
+#endif
+
+#ifndef NRF24_PEER_TABLE_SIZE
+#define NRF24_PEER_TABLE_SIZE 4 //number of destinations of sendDataTo() (NRF24_ADDRESS_WIDTH byte RAM each)
+#endif
+
+#define NRF24_PEER_BASE 0xFF //peer of sendDataTo() that is the base address of nRF_Config()
+
+#define NRF24_ROLE_TX 0x01 //role bits of NRF24_PROFILE_ROLES
+#define NRF24_ROLE_RX 0x02
+
+/* Compile-time profile: define NRF24_PROFILE in project settings when the configuration never
+   changes. nRF_Config() writes a register image computed at build time, setters of fixed
+   parameters, parameter checks of writeCommand() and the unused role are compiled out. */
+#ifdef NRF24_PROFILE
+
+#ifndef NRF24_PROFILE_CHANNEL
+#define NRF24_PROFILE_CHANNEL 1 //RF channel, 0 to 125
+#endif
+
+#ifndef NRF24_PROFILE_RATE
+#define NRF24_PROFILE_RATE 1 //0: 250Kbps, 1: 1Mbps, 2: 2Mbps
+#endif
+
+#ifndef NRF24_PROFILE_POWER
+#define NRF24_PROFILE_POWER 3 //0: -18dBm, 1: -12dBm, 2: -6dBm, 3: 0dBm, can be changed later by setTXPower()
+#endif
+
+#ifndef NRF24_PROFILE_CRC
+#define NRF24_PROFILE_CRC 2 //number of CRC bytes, 0 to 2
+#endif
+
+#ifndef NRF24_PROFILE_ADDRESS_WIDTH
+#define NRF24_PROFILE_ADDRESS_WIDTH 3 //address bytes, 3 to 5
+#endif
+
+#ifndef NRF24_PROFILE_ADDRESS //address of pipe 0 and TX, last byte is sent first
+#if NRF24_PROFILE_ADDRESS_WIDTH==3
+#define NRF24_PROFILE_ADDRESS {0x03,0x07,0x00}
+#elif NRF24_PROFILE_ADDRESS_WIDTH==4
+#define NRF24_PROFILE_ADDRESS {0x01,0x03,0x07,0x00}
+#else
+#define NRF24_PROFILE_ADDRESS {0x00,0x01,0x03,0x07,0x00}
+#endif
+#endif
+
+#ifndef NRF24_PROFILE_PIPES
+#define NRF24_PROFILE_PIPES 0x01 //enabled data pipes, bit n is pipe n
+#endif
+
+#ifndef NRF24_PROFILE_AUTO_ACK
+#define NRF24_PROFILE_AUTO_ACK 0x00 //data pipes with auto acknowledge, bit n is pipe n
+#endif
+
+#ifndef NRF24_PROFILE_DPL
+#define NRF24_PROFILE_DPL 1 //1: dynamic payload length on enabled pipes, 0: 32 byte packets
+#endif
+
+#ifndef NRF24_PROFILE_ROLES
+#define NRF24_PROFILE_ROLES (NRF24_ROLE_TX|NRF24_ROLE_RX) //roles nRF_Config() and switchRole() are used with
+#endif
+
+#if NRF24_PROFILE_CHANNEL>125 || NRF24_PROFILE_RATE>2 || NRF24_PROFILE_POWER>3 || NRF24_PROFILE_CRC>2
+#error "NRF24_PROFILE: channel, rate, power or CRC is out of range"
+#endif
+
+#if NRF24_PROFILE_ADDRESS_WIDTH<3 || NRF24_PROFILE_ADDRESS_WIDTH>5 || NRF24_PROFILE_PIPES>0x3F || NRF24_PROFILE_ROLES==0
+#error "NRF24_PROFILE: address width, pipes or roles are out of range"
+#endif
+
+#define NRF24_ADDRESS_WIDTH NRF24_PROFILE_ADDRESS_WIDTH
+#define NRF24_USE_TX ((NRF24_PROFILE_ROLES&NRF24_ROLE_TX)!=0)
+#define NRF24_USE_RX ((NRF24_PROFILE_ROLES&NRF24_ROLE_RX)!=0)
+
+#else
+
+#define NRF24_ADDRESS_WIDTH 5
+#define NRF24_USE_TX 1
+#define NRF24_USE_RX 1
+
+#endif
 
 /* Exported types ------------------------------------------------------------*/
 
@@ -63,6 +185,11 @@ typedef enum {NRF24_250Kbps, NRF24_1Mbps, NRF24_2Mbps} NRF24_BaudRate;
   */
 typedef enum {NRF24_3Byte, NRF24_4Byte, NRF24_5Byte} NRF24_AddressWidth;
 
+/** 
+  * @brief	Power State. State of the module, from the lowest to the highest current.
+  */
+typedef enum {NRF24_POWER_DOWN, NRF24_STANDBY_I, NRF24_STANDBY_II, NRF24_TX_MODE, NRF24_RX_MODE} NRF24_PowerState;
+
 /** 
   * @brief	Power Amplifier level.
   */
@@ -76,33 +203,178 @@ typedef struct {
     ErrorCode error;
 } WriteAnswer;
 
+/** 
+  * @brief	Event Type. What the IRQ service routine has observed.
+  */
+typedef enum {NRF24_EVENT_RX_READY, NRF24_EVENT_TX_DONE, NRF24_EVENT_MAX_RT, NRF24_EVENT_RX_OVERFLOW} NRF24_EventType;
+
+/** 
+  * @brief	Event Format. pipe and length are only valid for RX_READY and RX_OVERFLOW events,
+  *         ticket is only valid for TX_DONE and MAX_RT events (0 if packet is sent by sendData).
+  *         In TX coalescing mode, length of TX_DONE is the number of packets sent up to ticket.
+  */
+typedef struct {
+    NRF24_EventType type;
+    unsigned char pipe;
+    unsigned char length;
+    unsigned char ticket;
+} NRF24_Event;
+
+/** 
+  * @brief	TX Status. Completion status of a packet queued by txEnqueue().
+  */
+typedef enum {NRF24_TX_PENDING, NRF24_TX_DELIVERED, NRF24_TX_MAX_RETRIES, NRF24_TX_DROPPED, NRF24_TX_UNKNOWN} NRF24_TxStatus;
+
+/** 
+  * @brief	TX Lane. High priority packets are sent before any bulk packet that is still in RAM.
+  */
+typedef enum {NRF24_LANE_HIGH, NRF24_LANE_BULK} NRF24_TxLane;
+
+/** 
+  * @brief	Lane Counters. Number of packets of a TX lane since power on.
+  */
+typedef struct {
+    unsigned int queued; //accepted by txEnqueue
+    unsigned int delivered; //TX_DS is received
+    unsigned int failed; //MAX_RT is received
+    unsigned int dropped; //removed by flushTxQueue
+    unsigned int rejected; //lane was full
+    unsigned int preempted; //flushed from TX FIFO by a high priority packet, then uploaded again
+    unsigned int retries; //retransmits (ARC_CNT) of observed packets
+    unsigned int observed; //completed packets whose ARC_CNT is read, one per TX_DS or MAX_RT interrupt, the others in a coalesced group are unknown
+} NRF24_LaneStats;
+
+/** 
+  * @brief	CSMA Counters. Listen before talk of sendData() since power on, TX queue is not sensed.
+  */
+typedef struct {
+    unsigned int senses; //times RPD is sampled
+    unsigned int deferrals; //channel was busy
+    unsigned int failures; //packet is dropped after NRF24_CSMA_MAX_BACKOFFS busy tries
+    unsigned long backoffTime; //us waited in backoff
+} NRF24_CsmaStats;
+
+/** 
+  * @brief	Addressing Counters. Destination changes of sendDataTo() and selectPeer() since power on.
+  */
+typedef struct {
+    unsigned int selects; //calls of selectPeer(), including the ones of sendDataTo()
+    unsigned int writes; //TX_ADDR and RX_ADDR_P0 writes, a peer that is already loaded costs none
+    unsigned int bytes; //SPI bytes of these writes, command included
+} NRF24_AddressStats;
+
+/** 
+  * @brief	Event Callback. Called from serviceEvents(), never from interrupt context.
+  */
+typedef void (*NRF24_EventCallback)(NRF24_Event *event);
+
+/** 
+  * @brief	Timestamp Source. Returns current time of application in us, called from interrupt context.
+  */
+typedef unsigned long (*NRF24_TimestampSource)(void);
+
 /* Exported functions --------------------------------------------------------*/
 
 /* Initialization and configuration functions ********************************/
 void nRF_Config(Mode mode);
-void setMode(Mode m);
-void setCRCScheme(unsigned char num);
+void switchRole(Mode m);
 void setPowerUp();
 void setPowerDown();
 void setBaudRate(NRF24_BaudRate br);
 void setAutoAck(bool param);
+void setRetransmit(unsigned char delay, unsigned char count);
+void setTXPower(NRF24_TXPower power);
+#ifndef NRF24_PROFILE
+void setMode(Mode m);
+void setCRCScheme(unsigned char num);
 void enableRxDataPipe(bool param);
 void setAddressWidth(NRF24_AddressWidth aw);
 void serRFChannel(unsigned char ch);
-void setTXPower(NRF24_TXPower power);
 void setDynamicPayloadLength(bool param); 
+#endif
+void setAckPayload(bool param);
+void setDynamicAck(bool param);
+void setPipePayloadWidth(unsigned char pipe, unsigned char width);
 
 /* Input and Output operation functions **************************************/
 WriteAnswer writeCommand(unsigned char ins, char* data, int size);
-void sendData(char *data, int size);
 unsigned char bytesAvailable();
 void readRxFIFO(char* data, unsigned char size);
 unsigned char getStatus();
+bool getCarrierDetect();
+unsigned char getObserveTx();
+#if NRF24_USE_TX
+void sendData(char *data, int size);
+#endif
+#if NRF24_USE_RX
+void loadAckPayload(unsigned char pipe, char *data, unsigned char size);
+#endif
+
+#if NRF24_USE_TX
+/* TX queue functions ********************************************************/
+unsigned char txEnqueue(char *data, unsigned char size);
+unsigned char txEnqueueLane(char *data, unsigned char size, NRF24_TxLane lane, bool preempt);
+unsigned char txEnqueueNoAck(char *data, unsigned char size);
+NRF24_TxStatus getTxStatus(unsigned char ticket);
+unsigned char txQueueFree();
+unsigned char txLaneFree(NRF24_TxLane lane);
+void getLaneStats(NRF24_TxLane lane, NRF24_LaneStats *stats);
+void flushTxQueue();
+void setTxCoalescing(unsigned char count);
+void serviceTxQueue();
+
+/* Beacon functions **********************************************************/
+bool loadBeacon(char *data, unsigned char size);
+void fireBeacon();
+void repeatBeacon(unsigned int count, unsigned int interval);
+void burstBeacon(unsigned int duration);
+void stopBeacon();
+#endif
+
+/* Polled mode functions *****************************************************/
+void setPolledMode(bool param);
+bool getPolledMode();
+#if NRF24_USE_RX
+unsigned char pollReceive(char *data, unsigned char *pipe);
+#endif
+
+/* Power management functions ************************************************/
+NRF24_PowerState getPowerState();
+unsigned int getTransitionTime(NRF24_PowerState from, NRF24_PowerState to);
+NRF24_PowerState selectIdleState(unsigned int wakeLatency);
+NRF24_PowerState powerIdle(unsigned int wakeLatency);
+void setPowerState(NRF24_PowerState state);
+
+#if NRF24_USE_TX
+/* CSMA functions ************************************************************/
+void setCSMA(bool param);
+void getCSMAStats(NRF24_CsmaStats *stats);
+
+/* Addressing functions ******************************************************/
+bool setPeerAddress(unsigned char peer, char *address);
+#ifndef NRF24_PROFILE
+void setBaseAddress(char *address);
+#endif
+bool selectPeer(unsigned char peer);
+void sendDataTo(unsigned char peer, char *data, int size);
+void getAddressStats(NRF24_AddressStats *stats);
+#endif
 
 /* Interrupt functions *******************************************************/
+#ifdef __CODEVISIONAVR__
 interrupt [PC_INT0] void pin_change_isr0(void);
+#endif
 void setInterruptMask(bool RX_DR, bool TX_DS, bool MAX_RT);
 void clearInterruptFlag(bool RX_DR, bool TX_DS, bool MAX_RT);
+void setTimestampSource(NRF24_TimestampSource source);
+NRF24_TimestampSource getTimestampSource();
+unsigned long getTimestamp();
+unsigned long getRxTimestamp();
+
+/* Event functions ***********************************************************/
+void setEventCallback(NRF24_EventType type, NRF24_EventCallback callback);
+unsigned char serviceEvents();
+unsigned char eventsPending();
 
 /*
  * service routine of IRQ change state (this routin is called when IRQ signal of nrf24L01p has changed)
@@ -0,0 +1,224 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_aggr.c
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Message aggregation over nrf24L01p driver.
+  *    
+  *         This file provides firmware functions to manage the following 
+  *         functionalities of small message workloads
+  *           + Aggregation functions
+  @verbatim     
+  ==============================================================================      
+                        ##### How to use this driver #####
+  ============================================================================== 
+  [..]
+   (#) In case of Transmitter:
+	   Give messages to aggrSend(), they are packed in one frame that is
+	   queued by txEnqueue() when next message does not fit, when the first
+	   message is older than the deadline (checked by aggrService() in main
+	   loop, needs setTimestampSource()), or when aggrFlush() is called.
+	   Without a timestamp source every frame goes on next aggrService().
+
+   (#) In case of Receiver:
+	   Call aggrRead() in main loop, it takes frames from the driver and
+	   returns their messages one by one.
+
+     *** Frame ***    
+     =================================== 
+    [..]
+	  | 0xAC | length | message | length | message | ... |
+	  Up to 32 bytes. Eight 4 byte messages take one packet instead of
+	  eight, so preamble, address, CRC and 130us settling are paid once.
+  
+  @endverbatim
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <mega88a.h>
+#include <nRF24L01p.h>
+#include <nRF24L01p_aggr.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define AGGR_MAGIC 0xAC //first byte of every frame
+
+/* Private variables ---------------------------------------------------------*/
+char aggrTxFrame[32]; //frame being filled
+unsigned char aggrTxLength = 0; //bytes in aggrTxFrame, 0 if empty
+unsigned long aggrTxStart = 0; //time first message is added
+unsigned int aggrDeadline = NRF24_AGGR_DEADLINE;
+
+char aggrRxFrame[32]; //frame being split
+unsigned char aggrRxLength = 0;
+unsigned char aggrRxPos = 0; //next length byte in aggrRxFrame
+
+NRF24_AggrStats aggrStats;
+
+/** @defgroup nrf24L01p_aggr Aggregation functions
+ *  @brief   Aggregation functions
+ *
+@verbatim
+ ===============================================================================
+						##### Aggregation functions  #####
+ ===============================================================================
+    [..]
+    Only one frame is filled at a time. If TX queue is full when the frame
+    has to go, aggrSend() returns 0 and the application retries, the frame
+    stays as it is.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Sets how long the first message of a frame may wait for others, call it after setTimestampSource().
+  *
+  * @param	deadline: Time in us, 0 sends every frame from next aggrService().
+  * @retval 1: deadline is set, 0: deadline is not 0 and there is no timestamp source to measure it.
+  */
+bool aggrSetDeadline(unsigned int deadline)
+{
+	if(deadline>0 && getTimestampSource()==NULL)
+		return 0;
+	aggrDeadline = deadline;
+	return 1;
+}
+
+/**
+  * @brief  Adds a message to current frame, the frame is queued first if the message does not fit.
+  *
+  * @param	data: Message.
+  * @param	size: Size of message, 1 to 30.
+  * @retval 1: message is taken, 0: TX queue is full or size is not valid.
+  */
+bool aggrSend(char *data, unsigned char size)
+{
+	if(size==0 || size>NRF24_AGGR_MAX_MESSAGE)
+		return 0;
+
+	if(aggrTxLength+1+size > 32 && aggrFlush()==0)
+		return 0;
+
+	if(aggrTxLength==0)
+	{
+		aggrTxFrame[0] = AGGR_MAGIC;
+		aggrTxLength = 1;
+		aggrTxStart = getTimestamp();
+	}
+	aggrTxFrame[aggrTxLength++] = size;
+	memcpy(&aggrTxFrame[aggrTxLength], data, size);
+	aggrTxLength += size;
+	aggrStats.messages++;
+
+	if(aggrTxLength>=31) //no other message fits
+		aggrFlush();
+	return 1;
+}
+
+/**
+  * @brief  Queues current frame now.
+  *
+  * @param	NONE.
+  * @retval 1: frame is queued or empty, 0: TX queue is full.
+  */
+bool aggrFlush()
+{
+	if(aggrTxLength==0)
+		return 1;
+	if(txEnqueue(aggrTxFrame, aggrTxLength)==0)
+		return 0;
+
+	aggrTxLength = 0;
+	aggrStats.frames++;
+	return 1;
+}
+
+/**
+  * @brief  Queues current frame when deadline of its first message has passed. Has to be called in main loop.
+  *         Without a timestamp source the deadline can not pass, the frame is queued at once.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void aggrService()
+{
+	if(aggrTxLength>0 && (getTimestampSource()==NULL || getTimestamp()-aggrTxStart >= aggrDeadline))
+	{
+		if(aggrFlush()==1)
+			aggrStats.deadlineFlushes++;
+	}
+}
+
+/**
+  * @brief  Reads the next received message.
+  *
+  * @param	data: Array to store the message, at least 30 byte.
+  * @retval Size of message, 0 if there is no message.
+  */
+unsigned char aggrRead(char *data)
+{
+	unsigned char size;
+
+	if(aggrRxPos>=aggrRxLength) //current frame is finished
+	{
+		aggrRxLength = bytesAvailable();
+		aggrRxPos = 1;
+		if(aggrRxLength==0)
+			return 0;
+		readRxFIFO(aggrRxFrame, aggrRxLength);
+		if((unsigned char)aggrRxFrame[0]!=AGGR_MAGIC)
+		{
+			aggrRxLength = 0; //not a frame of this layer
+			return 0;
+		}
+		aggrStats.frames++;
+	}
+
+	size = aggrRxFrame[aggrRxPos];
+	if(size==0 || aggrRxPos+1+size > aggrRxLength) //corrupted length, rest of frame is dropped
+	{
+		aggrRxLength = 0;
+		return 0;
+	}
+
+	memcpy(data, &aggrRxFrame[aggrRxPos+1], size);
+	aggrRxPos += 1+size;
+	aggrStats.messages++;
+	return size;
+}
+
+/**
+  * @brief  Reads aggregation counters.
+  *
+  * @param	stats: Stores the counters.
+  * @retval NONE.
+  */
+void aggrGetStats(NRF24_AggrStats *stats)
+{
+	*stats = aggrStats;
+}
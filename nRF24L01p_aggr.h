@@ -0,0 +1,66 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_aggr.h
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Header file of message aggregation over nrf24L01p.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NRF24L01P_AGGR_H
+#define __NRF24L01P_AGGR_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p.h>
+
+#ifndef NRF24_AGGR_DEADLINE
+#define NRF24_AGGR_DEADLINE 2000 //us, default time the first message of a frame may wait for others
+#endif
+
+#define NRF24_AGGR_MAX_MESSAGE 30 //largest message, a frame has 1 byte header and 1 byte length per message
+
+/* Exported types ------------------------------------------------------------*/
+
+/** 
+  * @brief	Aggregation Counters. Since power on.
+  */
+typedef struct {
+    unsigned int messages; //given to aggrSend() or returned by aggrRead()
+    unsigned int frames; //sent or received
+    unsigned int deadlineFlushes; //frames sent because deadline has passed
+} NRF24_AggrStats;
+
+/* Exported functions --------------------------------------------------------*/
+
+/* Aggregation functions *****************************************************/
+bool aggrSetDeadline(unsigned int deadline);
+bool aggrSend(char *data, unsigned char size);
+bool aggrFlush();
+void aggrService();
+unsigned char aggrRead(char *data);
+void aggrGetStats(NRF24_AggrStats *stats);
+
+#endif
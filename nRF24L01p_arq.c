@@ -0,0 +1,440 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_arq.c
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Selective repeat ARQ over nrf24L01p driver.
+  *    
+  *         This file provides firmware functions to manage the following 
+  *         functionalities of bulk transfers
+  *           + ARQ functions
+  @verbatim     
+  ==============================================================================      
+                        ##### How to use this driver #####
+  ============================================================================== 
+  [..]
+   (#) Initialize the module by nRF_Config(), then call arqInit() with the
+	   same mode on both sides. 2Mbps and the largest window that fits in
+	   RAM give the best throughput.
+
+   (#) In case of Transmitter:
+	   Give packets of up to 30 bytes to arqSend(), it returns 0 while the
+	   window is full. Call arqService() in main loop, it processes ACKs and
+	   sends lost packets again. arqIdle() is 1 when everything is
+	   acknowledged.
+
+   (#) In case of Receiver:
+	   Call arqService() in main loop as often as possible, and read
+	   packets in order of sending by arqReceive(). arqInit() puts the
+	   receiver in polled mode, arqService() drains RX FIFO itself.
+
+     *** Protocol ***    
+     =================================== 
+    [..]
+	  Data packet: | 0xD5 | seq | data (1 to 30 bytes) |
+	  Most packets are sent by W_TX_PAYLOAD_NOACK and go back to back.
+	  Every NRF24_ARQ_POLL-th packet, and the packet that fills the window,
+	  is a normal packet; nrf24 of receiver acknowledges it with the ACK
+	  payload loaded by arqService():
+	  ACK payload: | 0xA5 | next expected seq | 32 bit bitmap of seq+1.. |
+	  Sender frees acknowledged packets and sends again every packet older
+	  than the poll that receiver has not got. Only one poll is outstanding.
+  
+  @endverbatim
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <mega88a.h>
+#include <nRF24L01p.h>
+#include <nRF24L01p_arq.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define ARQ_DATA 0xD5 //first byte of data packet
+#define ARQ_ACK 0xA5 //first byte of ACK payload
+#define ARQ_ACK_SIZE 6
+
+#if (NRF24_ARQ_WINDOW & (NRF24_ARQ_WINDOW-1))!=0 || NRF24_ARQ_WINDOW>32
+#error NRF24_ARQ_WINDOW has to be a power of 2 up to 32, slots are indexed by 8 bit seq
+#endif
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    unsigned char size; //bytes in data, 0: slot is free (receiver) or acknowledged (sender)
+    unsigned char epoch; //sender: poll counter when the packet was queued
+    char data[NRF24_ARQ_MAX_DATA];
+} ArqSlot;
+
+/* Private variables ---------------------------------------------------------*/
+Mode arqMode;
+ArqSlot arqSlots[NRF24_ARQ_WINDOW]; //indexed by seq % NRF24_ARQ_WINDOW
+unsigned char arqBase = 0; //sender: oldest not acknowledged seq, receiver: next seq to give to arqReceive
+unsigned char arqNext = 0; //sender: seq of next new packet, receiver: first seq not received
+unsigned char arqSincePoll = 0; //packets queued since last poll
+unsigned char arqEpoch = 0; //number of polls queued
+unsigned char arqPollTicket = 0; //ticket of outstanding poll, 0 if none
+unsigned char arqPollEpoch = 0; //epoch of outstanding poll
+unsigned char arqPollSeq = 0; //seq of outstanding poll, ACK payload was loaded before it is received
+NRF24_ArqStats arqStats;
+
+/* Private function prototypes -----------------------------------------------*/
+bool arqQueue(unsigned char seq);
+void arqProcessAck(char *ack);
+void arqProcessData(char *packet, unsigned char size);
+void arqLoadAck();
+
+/** @defgroup nrf24L01p_arq ARQ functions
+ *  @brief   ARQ functions
+ *
+@verbatim
+ ===============================================================================
+							##### ARQ functions  #####
+ ===============================================================================
+    [..]
+    Packets of a window are kept by sender till they are acknowledged and by
+    receiver till they are read in order, so RAM is fixed by
+    NRF24_ARQ_WINDOW. Sequence numbers are 8 bit, window is at most 32, so
+    old and new packets are never mixed up.
+    Data packets come back to back, the single packet buffer of IRQ service
+    routine would flush RX FIFO behind it, so receiver reads up to 3 packets
+    straight from RX FIFO by pollReceive() on each arqService().
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Prepares both sides, nRF_Config() must be called before.
+  *         Enables auto acknowledge, dynamic ACK and ACK payload, receiver goes to polled mode.
+  *
+  * @param	mode: Mode of operation, Transmitter or Receiver.
+  * @retval NONE.
+  */
+void arqInit(Mode mode)
+{
+	unsigned char i;
+
+	arqMode = mode;
+	arqBase = 0;
+	arqNext = 0;
+	arqSincePoll = 0;
+	arqEpoch = 0;
+	arqPollTicket = 0;
+	for(i=0;i<NRF24_ARQ_WINDOW;i++)
+		arqSlots[i].size = 0;
+	memset(&arqStats, 0, sizeof(arqStats));
+
+	setAutoAck(1); //polls are acknowledged by nrf24
+	setRetransmit(1, 3); //500us for ACK with payload
+	setDynamicAck(1); //data packets go without ACK
+	setAckPayload(1); //state of receiver comes back with ACK of polls
+
+	if(mode==NRF24_RECEIVER)
+	{
+		setPolledMode(1); //RX FIFO is drained by arqService()
+		arqLoadAck();
+	}
+}
+
+/**
+  * @brief  Sends a packet in order, without waiting for ACK.
+  *
+  * @param	data: data to be sent.
+  * @param	size: size of data, 1 to 30.
+  * @retval 1: packet is taken, 0: window or TX queue is full, or size is not valid.
+  */
+bool arqSend(char *data, unsigned char size)
+{
+	ArqSlot *slot;
+
+	if(arqMode!=NRF24_TRANSMITTER || size==0 || size>NRF24_ARQ_MAX_DATA || arqWindowFree()==0 || txQueueFree()==0)
+		return 0;
+
+	slot = &arqSlots[arqNext % NRF24_ARQ_WINDOW];
+	slot->size = size;
+	memcpy(slot->data, data, size);
+	if(arqQueue(arqNext)==0)
+	{
+		slot->size = 0;
+		return 0;
+	}
+
+	arqNext++;
+	arqStats.sent++;
+	return 1;
+}
+
+/**
+  * @brief  Reads the next packet in order of sending.
+  *
+  * @param	data: Array to store the packet, at least 30 byte.
+  * @retval Size of packet, 0 if next packet is not received yet.
+  */
+unsigned char arqReceive(char *data)
+{
+	ArqSlot *slot = &arqSlots[arqBase % NRF24_ARQ_WINDOW];
+	unsigned char size = slot->size;
+
+	if(arqMode!=NRF24_RECEIVER || arqBase==arqNext) //next packet is missing
+		return 0;
+
+	memcpy(data, slot->data, size);
+	slot->size = 0;
+	arqBase++; //window of receiver moves
+	return size;
+}
+
+/**
+  * @brief  Processes received packets and ACKs, sends lost packets again. Has to be called in main loop.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void arqService()
+{
+	char packet[32];
+	unsigned char size;
+	unsigned char i;
+	NRF24_TxStatus status;
+
+	if(arqMode==NRF24_RECEIVER)
+	{
+		for(i=0;i<3;i++) //RX FIFO holds 3 packets
+		{
+			size = pollReceive(packet, NULL);
+			if(size==0)
+				break;
+			if(size>2 && (unsigned char)packet[0]==ARQ_DATA)
+				arqProcessData(packet, size);
+		}
+		return;
+	}
+
+	size = bytesAvailable();
+	if(size>0)
+	{
+		readRxFIFO(packet, size);
+		if(size==ARQ_ACK_SIZE && (unsigned char)packet[0]==ARQ_ACK)
+			arqProcessAck(packet);
+	}
+
+	if(arqPollTicket!=0)
+	{
+		status = getTxStatus(arqPollTicket);
+		if(status!=NRF24_TX_PENDING) //ACK payload, if any, is already processed
+			arqPollTicket = 0;
+	}
+
+	//everything is sent, poll is answered but window is not empty: ask again with oldest packet
+	if(arqPollTicket==0 && arqBase!=arqNext && txQueueFree()==NRF24_TX_QUEUE_SIZE)
+	{
+		arqSincePoll = NRF24_ARQ_POLL; //force poll
+		if(arqQueue(arqBase)==1)
+			arqStats.retransmitted++;
+	}
+}
+
+/**
+  * @brief  Number of packets arqSend() can take before an ACK is needed.
+  *
+  * @param	NONE.
+  * @retval Free places of window.
+  */
+unsigned char arqWindowFree()
+{
+	return NRF24_ARQ_WINDOW - (unsigned char)(arqNext-arqBase);
+}
+
+/**
+  * @brief  Indicates if every packet of sender is acknowledged.
+  *
+  * @param	NONE.
+  * @retval 1: nothing to send, 0: packets are waiting for ACK.
+  */
+bool arqIdle()
+{
+	return arqBase==arqNext;
+}
+
+/**
+  * @brief  Reads ARQ counters.
+  *
+  * @param	stats: Stores the counters.
+  * @retval NONE.
+  */
+void arqGetStats(NRF24_ArqStats *stats)
+{
+	*stats = arqStats;
+}
+
+/**
+  * @brief  Queues a packet of window, as poll if it is time to ask for ACK.
+  *
+  * @param	seq: Sequence number of the packet.
+  * @retval 1: packet is queued, 0: TX queue is full.
+  */
+bool arqQueue(unsigned char seq)
+{
+	ArqSlot *slot = &arqSlots[seq % NRF24_ARQ_WINDOW];
+	char packet[32];
+	unsigned char ticket;
+	bool poll;
+
+	packet[0] = ARQ_DATA;
+	packet[1] = seq;
+	memcpy(&packet[2], slot->data, slot->size);
+
+	poll = arqPollTicket==0 && (arqSincePoll+1>=NRF24_ARQ_POLL || (unsigned char)(seq+1-arqBase)>=NRF24_ARQ_WINDOW);
+	slot->epoch = arqEpoch;
+	if(poll==1)
+		ticket = txEnqueue(packet, slot->size+2); //normal packet, receiver answers with ACK payload
+	else
+		ticket = txEnqueueNoAck(packet, slot->size+2);
+	if(ticket==0)
+		return 0; //not counted, the next try may still be the poll
+
+	arqSincePoll++;
+	if(poll==1)
+	{
+		arqPollTicket = ticket;
+		arqPollEpoch = arqEpoch;
+		arqPollSeq = seq;
+		arqEpoch++; //packets queued from now on are sent after the poll
+		arqSincePoll = 0;
+		arqStats.polls++;
+	}
+	return 1;
+}
+
+/**
+  * @brief  Frees acknowledged packets of sender and sends again the ones lost before the poll.
+  *
+  * @param	ack: ACK payload, it does not include the poll itself.
+  * @retval NONE.
+  */
+void arqProcessAck(char *ack)
+{
+	unsigned char expected = ack[1];
+	unsigned long bitmap;
+	unsigned char seq;
+	unsigned char offset;
+	ArqSlot *slot;
+
+	bitmap = (unsigned char)ack[2];
+	bitmap |= (unsigned long)(unsigned char)ack[3]<<8;
+	bitmap |= (unsigned long)(unsigned char)ack[4]<<16;
+	bitmap |= (unsigned long)(unsigned char)ack[5]<<24;
+	arqStats.acks++;
+
+	if((unsigned char)(expected-arqBase) > (unsigned char)(arqNext-arqBase)) //stale ACK
+		return;
+
+	for(seq=arqBase; seq!=arqNext; seq++)
+	{
+		slot = &arqSlots[seq % NRF24_ARQ_WINDOW];
+		offset = seq - expected;
+		if((unsigned char)(seq-arqBase) < (unsigned char)(expected-arqBase)) //cumulative part
+			slot->size = 0;
+		else if(offset>0 && offset<=32 && (bitmap>>(offset-1)) & 1)
+			slot->size = 0;
+	}
+
+	while(arqBase!=arqNext && arqSlots[arqBase % NRF24_ARQ_WINDOW].size==0)
+		arqBase++;
+
+	//packets queued before the answered poll and still not received are lost
+	arqPollTicket = 0;
+	for(seq=arqBase; seq!=arqNext; seq++)
+	{
+		slot = &arqSlots[seq % NRF24_ARQ_WINDOW];
+		if(slot->size>0 && seq!=arqPollSeq && (unsigned char)(arqPollEpoch-slot->epoch) < 128)
+		{
+			if(arqQueue(seq)==0)
+				break; //TX queue is full, next ACK will tell again
+			arqStats.retransmitted++;
+		}
+	}
+}
+
+/**
+  * @brief  Stores a data packet in window of receiver and updates the ACK payload.
+  *
+  * @param	packet: Received packet.
+  * @param	size: Size of packet.
+  * @retval NONE.
+  */
+void arqProcessData(char *packet, unsigned char size)
+{
+	unsigned char seq = packet[1];
+	ArqSlot *slot = &arqSlots[seq % NRF24_ARQ_WINDOW];
+
+	if((unsigned char)(seq-arqBase) >= NRF24_ARQ_WINDOW || slot->size>0) //already received, its ACK was lost
+	{
+		arqStats.duplicates++;
+	}
+	else
+	{
+		slot->size = size-2;
+		memcpy(slot->data, &packet[2], size-2);
+		arqStats.received++;
+		while((unsigned char)(arqNext-arqBase) < NRF24_ARQ_WINDOW && arqSlots[arqNext % NRF24_ARQ_WINDOW].size>0)
+			arqNext++;
+	}
+
+	arqLoadAck();
+}
+
+/**
+  * @brief  Loads the state of receiver as payload of next ACK.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void arqLoadAck()
+{
+	char ack[ARQ_ACK_SIZE];
+	unsigned long bitmap = 0;
+	unsigned char offset;
+	unsigned char seq;
+
+	for(offset=1; offset<=32; offset++)
+	{
+		seq = arqNext + offset;
+		if((unsigned char)(seq-arqBase) >= NRF24_ARQ_WINDOW)
+			break;
+		if(arqSlots[seq % NRF24_ARQ_WINDOW].size>0)
+			bitmap |= 1UL<<(offset-1);
+	}
+
+	ack[0] = ARQ_ACK;
+	ack[1] = arqNext;
+	ack[2] = bitmap;
+	ack[3] = bitmap>>8;
+	ack[4] = bitmap>>16;
+	ack[5] = bitmap>>24;
+	loadAckPayload(0, ack, ARQ_ACK_SIZE);
+}
@@ -0,0 +1,74 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_arq.h
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Header file of selective repeat ARQ over nrf24L01p.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NRF24L01P_ARQ_H
+#define __NRF24L01P_ARQ_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p.h>
+
+#ifndef NRF24_ARQ_WINDOW
+#define NRF24_ARQ_WINDOW 8 //packets sent before an ACK is needed, 1 to 32 (32 byte RAM each on both sides)
+#endif
+
+#ifndef NRF24_ARQ_POLL
+#define NRF24_ARQ_POLL (NRF24_ARQ_WINDOW/2) //every n-th packet asks for ACK
+#endif
+
+#define NRF24_ARQ_MAX_DATA 30 //bytes of user data in a packet, 2 bytes are header
+
+/* Exported types ------------------------------------------------------------*/
+
+/** 
+  * @brief	ARQ Counters. Since arqInit().
+  */
+typedef struct {
+    unsigned int sent; //new packets
+    unsigned int retransmitted; //packets sent again
+    unsigned int polls; //packets that asked for ACK
+    unsigned int acks; //ACK payloads received by sender
+    unsigned int received; //new packets of receiver
+    unsigned int duplicates; //packets receiver already had
+} NRF24_ArqStats;
+
+/* Exported functions --------------------------------------------------------*/
+
+/* ARQ functions *************************************************************/
+void arqInit(Mode mode);
+bool arqSend(char *data, unsigned char size);
+unsigned char arqReceive(char *data);
+void arqService();
+unsigned char arqWindowFree();
+bool arqIdle();
+void arqGetStats(NRF24_ArqStats *stats);
+
+#endif
@@ -0,0 +1,526 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_bench.c
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Link benchmark over nrf24L01p driver.
+  *    
+  *         This file provides firmware functions to manage the following 
+  *         functionalities of link measurements
+  *           + Benchmark functions
+  @verbatim     
+  ==============================================================================      
+                        ##### How to use this driver #####
+  ============================================================================== 
+  [..]
+   (#) Two nodes are needed: initiator calls nRF_Config(NRF24_TRANSMITTER),
+	   reflector nRF_Config(NRF24_RECEIVER), then both call benchInit().
+	   A us clock has to be given to setTimestampSource() on both sides.
+
+   (#) Reflector calls benchReflect() in main loop, nothing else.
+
+   (#) Initiator gets each case of the sweep by benchGetCase() (0 to
+	   benchCaseCount()-1), runs it by benchRun() and prints the result
+	   line of benchFormat() after NRF24_BENCH_HEADER.
+
+     *** Sweep ***    
+     =================================== 
+    [..]
+	  Every combination of payload size, data rate, CRC width, auto ACK
+	  and TX pipelining depth in the tables below. Depth is the number of
+	  packets that are queued by txEnqueue() and wait for their result.
+
+     *** Run of a case ***    
+     =================================== 
+    [..]
+	  (+) Setup: in control configuration (1Mbps, 2 byte CRC, auto ACK),
+	      initiator sends the case, both sides apply it after the reply.
+	  (+) Stream: NRF24_BENCH_PACKETS data packets, elapsed time is from
+	      the first upload to the result of the last packet.
+	  (+) Ping: NRF24_BENCH_PINGS requests, NRF24_BENCH_TURNAROUND us apart.
+	      Reflector sends each one back after NRF24_BENCH_TURNAROUND us,
+	      RTT does not include this wait.
+	  (+) Report: reflector goes back to control configuration after
+	      NRF24_BENCH_IDLE us of silence and tells initiator how many data
+	      packets it has read, that gives loss even without ACK.
+
+     *** Frames ***    
+     =================================== 
+    [..]
+	  | type | id or sequence | ... |
+	  Setup:  | 0xB2 | id | size | rate | crc | ack | depth |
+	  Report: | 0xB3 | id | received:2 (reply only, LSB first) |
+	  Data:   | 0xB0 | sequence:2 | fill |, shorter payloads are cut
+	  Ping:   | 0xB1 | id | fill |, reply is the same frame
+  
+  @endverbatim
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p.h>
+#include <nRF24L01p_bench.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define BENCH_DATA 0xB0
+#define BENCH_PING 0xB1
+#define BENCH_SETUP 0xB2
+#define BENCH_REPORT 0xB3
+
+#define BENCH_SETUP_SIZE 7
+#define BENCH_TRIES 5 //setup and report requests before a case fails
+
+/* Private variables ---------------------------------------------------------*/
+flash unsigned char benchSizes[] = {1, 16, 32};
+flash unsigned char benchCrcs[] = {1, 2};
+flash unsigned char benchDepths[] = {1, 3, NRF24_BENCH_MAX_DEPTH};
+flash unsigned int benchKbps[3] = {250, 1000, 2000}; //indexed by NRF24_BaudRate
+
+unsigned char benchId = 0; //id of last request of initiator
+unsigned long benchReplyAt = 0; //time the last reply of benchRequest() was read
+
+/* Private function prototypes -----------------------------------------------*/
+void benchApply(NRF24_BenchCase *test);
+void benchControl();
+NRF24_TxStatus benchWait(unsigned char ticket);
+unsigned char benchRequest(char *frame, unsigned char size, char *reply, unsigned char tries);
+void benchStream(NRF24_BenchCase *test, NRF24_BenchResult *result);
+void benchPing(NRF24_BenchCase *test, NRF24_BenchResult *result);
+
+/** @defgroup nrf24L01p_bench Benchmark functions
+ *  @brief   Benchmark functions
+ *
+@verbatim
+ ===============================================================================
+					##### Benchmark functions  #####
+ ===============================================================================
+    [..]
+    Nothing is changed in the driver, the benchmark only uses its API, so
+    the same sweep shows the effect of a change of the driver.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Applies control configuration, has to be called on both sides after nRF_Config().
+  *
+  * @param	mode: Mode of operation, Transmitter (initiator) or Receiver (reflector).
+  * @retval NONE.
+  */
+void benchInit(Mode mode)
+{
+	benchControl();
+	if(mode==NRF24_TRANSMITTER)
+		flushTxQueue();
+}
+
+/**
+  * @brief  Number of cases of the sweep.
+  *
+  * @param	NONE.
+  * @retval Number of cases.
+  */
+unsigned char benchCaseCount()
+{
+	return sizeof(benchSizes) * 3 * sizeof(benchCrcs) * 2 * sizeof(benchDepths);
+}
+
+/**
+  * @brief  Reads a case of the sweep, payload size changes fastest, then depth, auto ACK, CRC and data rate.
+  *
+  * @param	index: Case, 0 to benchCaseCount()-1.
+  * @param	test: Stores the case.
+  * @retval NONE.
+  */
+void benchGetCase(unsigned char index, NRF24_BenchCase *test)
+{
+	test->size = benchSizes[index % sizeof(benchSizes)];
+	index /= sizeof(benchSizes);
+	test->depth = benchDepths[index % sizeof(benchDepths)];
+	index /= sizeof(benchDepths);
+	test->autoAck = index % 2;
+	index /= 2;
+	test->crc = benchCrcs[index % sizeof(benchCrcs)];
+	index /= sizeof(benchCrcs);
+	test->rate = (NRF24_BaudRate)(index % 3);
+}
+
+/**
+  * @brief  Runs a case with the reflector, blocks till it is done.
+  *
+  * @param	test: The case.
+  * @param	result: Stores what is measured.
+  * @retval 1: result is complete, 0: reflector has not answered setup or report request.
+  */
+bool benchRun(NRF24_BenchCase *test, NRF24_BenchResult *result)
+{
+	char frame[BENCH_SETUP_SIZE];
+	char reply[32];
+	unsigned long start;
+
+	memset(result, 0, sizeof(NRF24_BenchResult));
+	result->test = *test;
+
+	frame[0] = BENCH_SETUP;
+	frame[1] = ++benchId;
+	frame[2] = test->size;
+	frame[3] = test->rate;
+	frame[4] = test->crc;
+	frame[5] = test->autoAck;
+	frame[6] = test->depth;
+	if(benchRequest(frame, BENCH_SETUP_SIZE, reply, BENCH_TRIES)==0)
+		return 0;
+
+	benchApply(test);
+	benchStream(test, result);
+	benchPing(test, result);
+
+	start = getTimestamp(); //reflector goes back to control configuration after NRF24_BENCH_IDLE
+	while(getTimestamp()-start < NRF24_BENCH_IDLE+NRF24_BENCH_TURNAROUND);
+	benchControl();
+
+	frame[0] = BENCH_REPORT;
+	frame[1] = ++benchId;
+	if(benchRequest(frame, 2, reply, BENCH_TRIES)<4)
+		return 0;
+	result->received = (unsigned char)reply[2] | ((unsigned int)(unsigned char)reply[3]<<8);
+
+	if(result->elapsed>=10)
+		result->packetsPerSecond = (unsigned long)result->received*100000 / (result->elapsed/10);
+	result->goodput = result->packetsPerSecond * test->size * 8;
+	if(result->received<result->sent)
+		result->loss = ((unsigned long)(result->sent-result->received)*1000) / result->sent;
+	return 1;
+}
+
+/**
+  * @brief  Answers the initiator, has to be called in main loop of reflector.
+  *
+  * @param	reflector: State of reflector, zero it before the first call.
+  * @retval NONE.
+  */
+void benchReflect(NRF24_BenchReflector *reflector)
+{
+	unsigned long now = getTimestamp();
+	char frame[32];
+	unsigned char size;
+	NRF24_TxStatus status;
+
+	if(reflector->ticket!=0) //reply is on its way
+	{
+		status = getTxStatus(reflector->ticket);
+		if(status==NRF24_TX_PENDING && now-reflector->replyAt < NRF24_BENCH_TIMEOUT)
+			return;
+		reflector->ticket = 0;
+		switchRole(NRF24_RECEIVER);
+		if(reflector->setup==1 && status==NRF24_TX_DELIVERED) //initiator has the reply, both move to the case
+		{
+			benchApply(&reflector->next);
+			reflector->running = 1;
+			reflector->received = 0;
+			reflector->lastRx = getTimestamp();
+		}
+		reflector->setup = 0;
+		return;
+	}
+
+	if(reflector->replySize>0)
+	{
+		if((long)(now-reflector->replyAt) < 0) //initiator is not in RX yet
+			return;
+		switchRole(NRF24_TRANSMITTER);
+		reflector->ticket = txEnqueue(reflector->reply, reflector->replySize);
+		reflector->replySize = 0;
+		if(reflector->ticket==0)
+		{
+			switchRole(NRF24_RECEIVER);
+			reflector->setup = 0;
+		}
+		return;
+	}
+
+	if(reflector->running==1 && now-reflector->lastRx >= NRF24_BENCH_IDLE) //case is over
+	{
+		reflector->running = 0;
+		benchControl();
+	}
+
+	size = bytesAvailable();
+	if(size==0)
+		return;
+	readRxFIFO(frame, size);
+	reflector->lastRx = now;
+
+	switch((unsigned char)frame[0])
+	{
+		case BENCH_DATA:
+			if(reflector->running==1)
+				reflector->received++;
+		break;
+
+		case BENCH_PING:
+			memcpy(reflector->reply, frame, size);
+			reflector->replySize = size;
+		break;
+
+		case BENCH_SETUP:
+			if(size<BENCH_SETUP_SIZE || frame[2]<1 || frame[2]>32 || (unsigned char)frame[3]>NRF24_2Mbps)
+				return;
+			reflector->next.size = frame[2];
+			reflector->next.rate = (NRF24_BaudRate)frame[3];
+			reflector->next.crc = frame[4];
+			reflector->next.autoAck = frame[5];
+			reflector->next.depth = frame[6];
+			reflector->setup = 1;
+			reflector->received = 0; //report of a case it has missed is not the count of the last one
+			reflector->reply[0] = BENCH_SETUP;
+			reflector->reply[1] = frame[1];
+			reflector->replySize = 2;
+		break;
+
+		case BENCH_REPORT:
+			reflector->reply[0] = BENCH_REPORT;
+			reflector->reply[1] = frame[1];
+			reflector->reply[2] = reflector->received;
+			reflector->reply[3] = reflector->received>>8;
+			reflector->replySize = 4;
+		break;
+
+		default:
+			return;
+	}
+	reflector->replyAt = now + NRF24_BENCH_TURNAROUND;
+}
+
+/**
+  * @brief  Writes a result as one comma separated line, the columns of NRF24_BENCH_HEADER.
+  *
+  * @param	result: The result.
+  * @param	line: Array to store the line, at least NRF24_BENCH_LINE byte.
+  * @retval NONE.
+  */
+void benchFormat(NRF24_BenchResult *result, char *line)
+{
+	sprintf(line, "bench,%u,%u,%u,%u,%u,%u,%u,%u,%lu,%lu,%lu,%u,%u,%u,%u,%u",
+		result->test.size, benchKbps[result->test.rate], result->test.crc, result->test.autoAck, result->test.depth,
+		result->sent, result->delivered, result->received, result->elapsed, result->packetsPerSecond,
+		result->goodput, result->loss, result->pings, result->rttMin, result->rttAverage, result->rttMax);
+}
+
+/**
+  * @brief  Changes data rate, CRC and auto ACK of this side.
+  *
+  * @param	test: The case.
+  * @retval NONE.
+  */
+void benchApply(NRF24_BenchCase *test)
+{
+	setBaudRate(test->rate);
+	setCRCScheme(test->crc);
+	setAutoAck(test->autoAck);
+	setRetransmit(1, 3); //500us, enough for ACK at 250Kbps
+}
+
+/**
+  * @brief  Applies control configuration, setup and report requests are sent in it.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void benchControl()
+{
+	setBaudRate(NRF24_1Mbps);
+	setCRCScheme(2);
+	setAutoAck(1);
+	setRetransmit(1, 15);
+}
+
+/**
+  * @brief  Waits for result of a queued packet.
+  *
+  * @param	ticket: Ticket of txEnqueue().
+  * @retval Result, NRF24_TX_PENDING if it is not known after NRF24_BENCH_TIMEOUT.
+  */
+NRF24_TxStatus benchWait(unsigned char ticket)
+{
+	unsigned long start = getTimestamp();
+	NRF24_TxStatus status;
+
+	do {
+		status = getTxStatus(ticket);
+	} while(status==NRF24_TX_PENDING && getTimestamp()-start < NRF24_BENCH_TIMEOUT);
+	return status;
+}
+
+/**
+  * @brief  Sends a request and waits in RX for its reply.
+  *
+  * @param	frame: The request, first two bytes are type and id.
+  * @param	size: Size of request.
+  * @param	reply: Array to store the reply, 32 byte.
+  * @param	tries: Requests sent before it fails.
+  * @retval Size of reply, 0 if there is no reply.
+  */
+unsigned char benchRequest(char *frame, unsigned char size, char *reply, unsigned char tries)
+{
+	unsigned char ticket;
+	unsigned char length;
+	unsigned long start;
+
+	while(tries-->0)
+	{
+		ticket = txEnqueue(frame, size);
+		if(ticket==0 || benchWait(ticket)!=NRF24_TX_DELIVERED) //without ACK it is only sent
+		{
+			flushTxQueue();
+			continue;
+		}
+
+		switchRole(NRF24_RECEIVER);
+		start = getTimestamp();
+		do {
+			length = bytesAvailable();
+			if(length>0)
+			{
+				readRxFIFO(reply, length);
+				if(reply[0]==frame[0] && reply[1]==frame[1])
+				{
+					benchReplyAt = getTimestamp(); //reflector needs the ACK of its reply, a lost one is retransmitted
+					while(getTimestamp()-benchReplyAt < NRF24_BENCH_HOLD);
+					switchRole(NRF24_TRANSMITTER);
+					return length;
+				}
+			}
+		} while(getTimestamp()-start < NRF24_BENCH_TIMEOUT);
+		switchRole(NRF24_TRANSMITTER);
+	}
+	return 0;
+}
+
+/**
+  * @brief  Sends data packets, up to depth of them are queued at a time.
+  *
+  * @param	test: The case.
+  * @param	result: Stores sent, delivered and elapsed.
+  * @retval NONE.
+  */
+void benchStream(NRF24_BenchCase *test, NRF24_BenchResult *result)
+{
+	char frame[32];
+	unsigned char tickets[NRF24_BENCH_MAX_DEPTH];
+	unsigned char head = 0;
+	unsigned char count = 0;
+	unsigned char ticket;
+	NRF24_TxStatus status;
+	unsigned long start;
+	unsigned long last;
+
+	memset(frame, 0x55, sizeof(frame));
+	frame[0] = BENCH_DATA;
+	start = getTimestamp();
+	last = start;
+	while(result->sent<NRF24_BENCH_PACKETS || count>0)
+	{
+		if(count<test->depth && result->sent<NRF24_BENCH_PACKETS)
+		{
+			frame[1] = result->sent;
+			frame[2] = result->sent>>8;
+			ticket = txEnqueue(frame, test->size);
+			if(ticket!=0)
+			{
+				tickets[(head+count) % NRF24_BENCH_MAX_DEPTH] = ticket;
+				count++;
+				result->sent++;
+				continue;
+			}
+		}
+
+		status = getTxStatus(tickets[head]);
+		if(status!=NRF24_TX_PENDING)
+		{
+			if(status==NRF24_TX_DELIVERED)
+				result->delivered++;
+			head = (head+1) % NRF24_BENCH_MAX_DEPTH;
+			count--;
+			last = getTimestamp();
+		}
+		else if(getTimestamp()-last >= NRF24_BENCH_TIMEOUT) //radio does not answer, the rest is lost
+		{
+			flushTxQueue();
+			break;
+		}
+	}
+	result->elapsed = last - start;
+}
+
+/**
+  * @brief  Measures RTT by pings of data packet size, at least 2 byte.
+  *
+  * @param	test: The case.
+  * @param	result: Stores pings and RTT.
+  * @retval NONE.
+  */
+void benchPing(NRF24_BenchCase *test, NRF24_BenchResult *result)
+{
+	char frame[32];
+	char reply[32];
+	unsigned char size = (test->size<2) ? 2 : test->size;
+	unsigned char p;
+	unsigned long start;
+	unsigned long rtt;
+	unsigned long sum = 0;
+
+	memset(frame, 0x55, sizeof(frame));
+	frame[0] = BENCH_PING;
+	result->rttMin = 0xFFFF;
+	for(p=0;p<NRF24_BENCH_PINGS;p++)
+	{
+		start = getTimestamp(); //reflector waits for ACK of last reply before it is in RX again
+		while(getTimestamp()-start < NRF24_BENCH_TURNAROUND);
+
+		frame[1] = ++benchId;
+		start = getTimestamp();
+		if(benchRequest(frame, size, reply, 1)==0)
+			continue;
+		rtt = benchReplyAt - start - NRF24_BENCH_TURNAROUND;
+		if(rtt>0xFFFF)
+			rtt = 0xFFFF;
+		if(rtt<result->rttMin)
+			result->rttMin = rtt;
+		if(rtt>result->rttMax)
+			result->rttMax = rtt;
+		sum += rtt;
+		result->pings++;
+	}
+	if(result->pings>0)
+		result->rttAverage = sum / result->pings;
+	else
+		result->rttMin = 0;
+}
+
@@ -0,0 +1,140 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_bench.h
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Header file of link benchmark over nrf24L01p.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NRF24L01P_BENCH_H
+#define __NRF24L01P_BENCH_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p.h>
+
+#ifndef __CODEVISIONAVR__
+#define flash const //tables are in flash on AVR, const elsewhere
+#endif
+
+#ifdef NRF24_PROFILE
+#error "nRF24L01p_bench.c changes data rate, CRC and auto ACK, it can not be used with NRF24_PROFILE"
+#endif
+
+#ifndef NRF24_BENCH_PACKETS
+#define NRF24_BENCH_PACKETS 500 //data packets sent for each case
+#endif
+
+#if NRF24_BENCH_PACKETS>10000
+#error "NRF24_BENCH_PACKETS can be 10000 at most, goodput is calculated in 32 bit"
+#endif
+
+#ifndef NRF24_BENCH_PINGS
+#define NRF24_BENCH_PINGS 16 //request and reply pairs that measure RTT of each case
+#endif
+
+#ifndef NRF24_BENCH_TIMEOUT
+#define NRF24_BENCH_TIMEOUT 50000 //us, longest wait for a TX result or a reply
+#endif
+
+#ifndef NRF24_BENCH_IDLE
+#define NRF24_BENCH_IDLE 100000 //us without packets before reflector goes back to control configuration
+#endif
+
+#ifndef NRF24_BENCH_TURNAROUND
+#define NRF24_BENCH_TURNAROUND 600 //us between a request and its reply, so the other side has switched to RX (ACK at 250Kbps included)
+#endif
+
+#ifndef NRF24_BENCH_HOLD
+#define NRF24_BENCH_HOLD 3000 //us initiator stays in RX after a reply, so retransmits of the reply are ACKed too
+#endif
+
+#define NRF24_BENCH_MAX_DEPTH 6 //largest TX pipelining depth of the sweep
+
+#if NRF24_TX_STATUS_SIZE<=NRF24_BENCH_MAX_DEPTH
+#error "NRF24_TX_STATUS_SIZE has to be more than NRF24_BENCH_MAX_DEPTH, status of queued packets would be lost"
+#endif
+
+#define NRF24_BENCH_LINE 100 //size of line buffer of benchFormat()
+#define NRF24_BENCH_HEADER "bench,size,rate_kbps,crc,ack,depth,sent,delivered,received,elapsed_us,packets_s,goodput_bps,loss_permille,pings,rtt_min_us,rtt_avg_us,rtt_max_us"
+
+/* Exported types ------------------------------------------------------------*/
+
+/** 
+  * @brief	Benchmark Case. One combination of the sweep.
+  */
+typedef struct {
+    unsigned char size; //payload of data packets, 1 to 32
+    NRF24_BaudRate rate;
+    unsigned char crc; //CRC bytes, 1 or 2
+    bool autoAck;
+    unsigned char depth; //packets queued at a time, 1 to NRF24_BENCH_MAX_DEPTH
+} NRF24_BenchCase;
+
+/** 
+  * @brief	Benchmark Result. Measured by initiator, received is counted by reflector.
+  */
+typedef struct {
+    NRF24_BenchCase test;
+    unsigned int sent; //data packets queued by txEnqueue()
+    unsigned int delivered; //acknowledged, or only sent if auto ACK is disabled
+    unsigned int received; //data packets reflector has read
+    unsigned long elapsed; //us from first upload to result of last packet
+    unsigned long packetsPerSecond; //received packets
+    unsigned long goodput; //bit/s of received payload
+    unsigned int loss; //per mille of sent packets that reflector has not read
+    unsigned char pings; //pings answered, RTT is measured on them
+    unsigned int rttMin; //us from upload of a ping to read of its reply, turnaround of reflector is not included
+    unsigned int rttAverage;
+    unsigned int rttMax;
+} NRF24_BenchResult;
+
+/** 
+  * @brief	Reflector State. Kept by application for benchReflect().
+  */
+typedef struct {
+    bool running; //case configuration is applied
+    unsigned long lastRx; //time of last packet
+    unsigned int received; //data packets of current case
+    char reply[32];
+    unsigned char replySize; //reply waiting for its time, 0 if none
+    unsigned long replyAt; //time reply is sent
+    unsigned char ticket; //ticket of reply on its way, 0 if none
+    NRF24_BenchCase next; //case applied when setup reply is delivered
+    bool setup; //reply on its way answers a setup request
+} NRF24_BenchReflector;
+
+/* Exported functions --------------------------------------------------------*/
+
+/* Benchmark functions *******************************************************/
+void benchInit(Mode mode);
+unsigned char benchCaseCount();
+void benchGetCase(unsigned char index, NRF24_BenchCase *test);
+bool benchRun(NRF24_BenchCase *test, NRF24_BenchResult *result);
+void benchReflect(NRF24_BenchReflector *reflector);
+void benchFormat(NRF24_BenchResult *result, char *line);
+
+#endif
@@ -0,0 +1,441 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_capture.c
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Packet capture of nrf24L01p spidev backend to a pcap stream.
+  *    
+  *         This file provides functions to manage the following 
+  *         functionalities of a Linux sniffer or gateway
+  *           + Capture functions
+  *           + Format functions
+  @verbatim     
+  ==============================================================================      
+                        ##### How to use this driver #####
+  ============================================================================== 
+  [..]
+   (#) Open a radio by nRF24L01p_spidev.c. Configure it as receiver by
+	   spidevConfig() to log the packets of a network, or by
+	   spidevConfigPromiscuous() to log raw frames of any address.
+
+   (#) Open the output: a file, a pipe to another program or a socket, and
+	   give it to captureStart(). It writes the pcap file header and starts
+	   an I/O thread that reads the radio and a writer thread that streams
+	   records, e.g. "./sniffer | wireshark -k -i -".
+
+   (#) captureStop() stops both threads after every record is written,
+	   captureGetStats() counts captured, dropped and written records.
+
+     *** File format ***    
+     =================================== 
+    [..]
+	  Standard pcap, every field little endian:
+	  (+) File header, 24 byte: magic 0xA1B23C4D (ns timestamps), version
+	      2.4, zone 0, sigfigs 0, snaplen 36, link type 147 (LINKTYPE_USER0).
+	  (+) Record header, 16 byte: seconds and ns of CLOCK_REALTIME when the
+	      packet was read from RX FIFO, captured length, original length.
+	  (+) Frame, 4 to 36 byte: version (1), RF channel, data pipe, flags,
+	      then the payload. Flags: bits 0-1 data rate (0: 250Kbps, 1: 1Mbps,
+	      2: 2Mbps), bit 2 RPD (stronger than -64dBm), bit 3 raw record of
+	      promiscuous mode.
+	  Payload of a normal record is in the order given to sendData() by
+	  the sender. A raw record is 32 byte in the order it was on air: the
+	  address, packet control field, payload and CRC of the frame are found
+	  by the reader at any bit offset. In Wireshark, DLT_USER0 is mapped to
+	  a dissector in "Preferences, Protocols, DLT_USER", tcpdump and libpcap
+	  read the file as it is.
+
+     *** Pipeline ***    
+     =================================== 
+    [..]
+	  (+) The ring and the write buffer are allocated once by captureStart(),
+	      nothing is allocated per packet.
+	  (+) I/O thread only waits for IRQ, reads RX FIFO (RPD in the same
+	      batch) and puts the record in a single producer single consumer
+	      ring, so a slow disk never delays RX FIFO.
+	  (+) Writer encodes up to NRF24_CAPTURE_BATCH records at once and
+	      writes them by one write(), or sooner when the ring is empty.
+	  (+) When the ring is full the record is dropped and counted.
+  
+  @endverbatim
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p.h>
+#include <nRF24L01p_spidev.h>
+#include <nRF24L01p_capture.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Private define ------------------------------------------------------------*/
+#define PCAP_MAGIC_NS 0xA1B23C4DUL //pcap with ns timestamps
+#define PCAP_VERSION_MAJOR 2
+#define PCAP_VERSION_MINOR 4
+
+/* Private function prototypes -----------------------------------------------*/
+void *captureIoThread(void *arg);
+void *captureWriterThread(void *arg);
+bool captureWrite(int fd, unsigned char *data, unsigned int size);
+void capturePut16(unsigned char *out, unsigned int value);
+void capturePut32(unsigned char *out, unsigned long value);
+unsigned long long captureNanoseconds();
+
+/** @defgroup nrf24L01p_capture Capture functions
+ *  @brief   Capture functions
+ *
+@verbatim
+ ===============================================================================
+						##### Capture functions  #####
+ ===============================================================================
+    [..]
+    The ring works like rings of nRF24L01p_gateway.c: I/O thread writes a
+    slot then publishes head with release order, writer reads head with
+    acquire order, copies slots into its write buffer and publishes tail.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Writes the pcap file header, allocates the ring and starts I/O and writer threads.
+  *
+  * @param	capture: Capture.
+  * @param	radio: Radio of nRF24L01p_spidev.c, configured as receiver or promiscuous.
+  * @param	fd: Output, a file, pipe or socket opened for writing.
+  * @retval 1: started, 0: header could not be written or memory or threads could not be made.
+  */
+bool captureStart(NRF24_Capture *capture, NRF24_Spidev *radio, int fd)
+{
+	unsigned char header[NRF24_CAPTURE_FILE_HEADER];
+
+	memset(capture, 0, sizeof(NRF24_Capture));
+	capture->radio = radio;
+	capture->fd = fd;
+
+	if(captureWrite(fd, header, captureFileHeader(header))==0)
+		return 0;
+	capture->stats.bytes = NRF24_CAPTURE_FILE_HEADER;
+
+	capture->ring = calloc(1, sizeof(NRF24_CaptureRing)); //the only allocation
+	if(capture->ring==NULL)
+		return 0;
+	spidevSetRpd(radio, 1);
+	capture->running = 1;
+
+	if(pthread_create(&capture->writerThread, NULL, captureWriterThread, capture)!=0)
+	{
+		free(capture->ring);
+		capture->ring = NULL;
+		return 0;
+	}
+	if(pthread_create(&capture->ioThread, NULL, captureIoThread, capture)!=0)
+	{
+		__atomic_store_n(&capture->ioStopped, 1, __ATOMIC_RELEASE);
+		pthread_join(capture->writerThread, NULL);
+		free(capture->ring);
+		capture->ring = NULL;
+		return 0;
+	}
+	return 1;
+}
+
+/**
+  * @brief  Stops I/O thread, then the writer after records left in the ring are written. Radio and fd are not closed.
+  *
+  * @param	capture: Capture.
+  * @retval NONE.
+  */
+void captureStop(NRF24_Capture *capture)
+{
+	if(capture->ring==NULL)
+		return;
+
+	__atomic_store_n(&capture->running, 0, __ATOMIC_RELEASE);
+	pthread_join(capture->ioThread, NULL); //I/O thread waits for IRQ 10ms at most
+	__atomic_store_n(&capture->ioStopped, 1, __ATOMIC_RELEASE);
+	pthread_join(capture->writerThread, NULL);
+
+	spidevSetRpd(capture->radio, 0);
+	free(capture->ring);
+	capture->ring = NULL;
+}
+
+/**
+  * @brief  Copies counters of the capture.
+  *
+  * @param	capture: Capture.
+  * @param	stats: Stores the counters.
+  * @retval NONE.
+  */
+void captureGetStats(NRF24_Capture *capture, NRF24_CaptureStats *stats)
+{
+	stats->captured = __atomic_load_n(&capture->stats.captured, __ATOMIC_RELAXED);
+	stats->dropped = __atomic_load_n(&capture->stats.dropped, __ATOMIC_RELAXED);
+	stats->written = __atomic_load_n(&capture->stats.written, __ATOMIC_RELAXED);
+	stats->bytes = __atomic_load_n(&capture->stats.bytes, __ATOMIC_RELAXED);
+	stats->failed = __atomic_load_n(&capture->stats.failed, __ATOMIC_RELAXED);
+}
+
+/**
+  * @brief  I/O thread: waits for IRQ, reads RX FIFO into the ring.
+  *
+  * @param	arg: Capture.
+  * @retval NULL.
+  */
+void *captureIoThread(void *arg)
+{
+	NRF24_Capture *capture = (NRF24_Capture*)arg;
+	NRF24_Spidev *radio = capture->radio;
+	NRF24_CaptureRing *ring = capture->ring;
+	NRF24_CaptureRecord record;
+	unsigned int head = 0;
+	unsigned long captured = 0;
+	unsigned long dropped = 0;
+	unsigned char i;
+	char swap;
+
+	while(__atomic_load_n(&capture->running, __ATOMIC_ACQUIRE))
+	{
+		if(spidevRxPending(radio)==0 && spidevWaitIrq(radio, 10)==0)
+			continue;
+
+		record.length = spidevReceive(radio, record.data, &record.pipe);
+		if(record.length==0)
+			continue;
+		record.time = captureNanoseconds();
+		record.channel = radio->channel;
+		record.flags = radio->rate & NRF24_CAPTURE_RATE;
+		if(spidevGetRpd(radio)==1)
+			record.flags |= NRF24_CAPTURE_RPD;
+		if(radio->width!=0) //static width is only used by promiscuous mode
+		{
+			record.flags |= NRF24_CAPTURE_RAW;
+			for(i=0;i<record.length/2;i++) //back to the order on air
+			{
+				swap = record.data[i];
+				record.data[i] = record.data[record.length-1-i];
+				record.data[record.length-1-i] = swap;
+			}
+		}
+		captured++;
+		__atomic_store_n(&capture->stats.captured, captured, __ATOMIC_RELAXED);
+
+		if(head-__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= NRF24_CAPTURE_RING_SIZE)
+		{
+			dropped++; //writer is behind
+			__atomic_store_n(&capture->stats.dropped, dropped, __ATOMIC_RELAXED);
+			continue;
+		}
+		ring->slot[head & (NRF24_CAPTURE_RING_SIZE-1)] = record;
+		head++;
+		__atomic_store_n(&ring->head, head, __ATOMIC_RELEASE); //every record at once, the writer batches
+	}
+	return NULL;
+}
+
+/**
+  * @brief  Writer thread: encodes records of the ring and writes them by one write() per batch.
+  *
+  * @param	arg: Capture.
+  * @retval NULL.
+  */
+void *captureWriterThread(void *arg)
+{
+	NRF24_Capture *capture = (NRF24_Capture*)arg;
+	NRF24_CaptureRing *ring = capture->ring;
+	unsigned int head;
+	unsigned int tail = 0;
+	unsigned int taken;
+	unsigned int size;
+	unsigned long written = 0;
+	unsigned long long bytes = capture->stats.bytes;
+	bool stopping = 0;
+	struct timespec idle;
+
+	idle.tv_sec = 0;
+	idle.tv_nsec = NRF24_CAPTURE_IDLE_SLEEP*1000L;
+
+	while(1)
+	{
+		head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+		size = 0;
+		for(taken=0;tail!=head && taken<NRF24_CAPTURE_BATCH;taken++)
+		{
+			size += captureEncode(&ring->slot[tail & (NRF24_CAPTURE_RING_SIZE-1)], &ring->out[size]);
+			tail++;
+		}
+
+		if(taken>0)
+		{
+			__atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE); //slots are copied, I/O thread can use them
+			if(captureWrite(capture->fd, ring->out, size)==0)
+			{
+				__atomic_store_n(&capture->stats.failed, 1, __ATOMIC_RELAXED);
+				break; //ring fills up, I/O thread counts drops
+			}
+			written += taken;
+			bytes += size;
+			__atomic_store_n(&capture->stats.written, written, __ATOMIC_RELAXED);
+			__atomic_store_n(&capture->stats.bytes, bytes, __ATOMIC_RELAXED);
+			continue;
+		}
+
+		if(stopping==1)
+			break; //I/O thread is stopped and the ring is empty
+		stopping = __atomic_load_n(&capture->ioStopped, __ATOMIC_ACQUIRE); //one more pass takes last records
+		if(stopping==0)
+			nanosleep(&idle, NULL);
+	}
+	return NULL;
+}
+
+/**
+  * @brief  Writes all bytes, partial writes of pipes and sockets are continued.
+  *
+  * @param	fd: Output.
+  * @param	data: Bytes to write.
+  * @param	size: Number of bytes.
+  * @retval 1: written, 0: failed.
+  */
+bool captureWrite(int fd, unsigned char *data, unsigned int size)
+{
+	ssize_t done;
+
+	while(size>0)
+	{
+		done = write(fd, data, size);
+		if(done<0 && errno==EINTR)
+			continue;
+		if(done<=0)
+			return 0;
+		data += done;
+		size -= done;
+	}
+	return 1;
+}
+
+/**
+  * @brief  Wall clock time, pcap timestamps are UTC.
+  *
+  * @param	NONE.
+  * @retval ns since 1970.
+  */
+unsigned long long captureNanoseconds()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_REALTIME, &now);
+	return (unsigned long long)now.tv_sec*1000000000ULL + now.tv_nsec;
+}
+
+/** @defgroup nrf24L01p_capture Format functions
+ *  @brief   Format functions
+ *
+@verbatim
+ ===============================================================================
+						##### Format functions  #####
+ ===============================================================================
+    [..]
+    Fields are written byte by byte in little endian, so files are the same
+    on every host and the magic number tells readers the byte order.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Makes the pcap file header.
+  *
+  * @param	out: Stores the header, NRF24_CAPTURE_FILE_HEADER byte.
+  * @retval Number of bytes, NRF24_CAPTURE_FILE_HEADER.
+  */
+unsigned int captureFileHeader(unsigned char *out)
+{
+	capturePut32(&out[0], PCAP_MAGIC_NS);
+	capturePut16(&out[4], PCAP_VERSION_MAJOR);
+	capturePut16(&out[6], PCAP_VERSION_MINOR);
+	capturePut32(&out[8], 0); //time zone, timestamps are UTC
+	capturePut32(&out[12], 0); //accuracy of timestamps
+	capturePut32(&out[16], NRF24_CAPTURE_HEADER+32); //snaplen, records are never cut
+	capturePut32(&out[20], NRF24_CAPTURE_LINKTYPE);
+	return NRF24_CAPTURE_FILE_HEADER;
+}
+
+/**
+  * @brief  Makes the pcap record of a captured packet: record header, pseudo header and payload.
+  *
+  * @param	record: Captured packet.
+  * @param	out: Stores the record, up to NRF24_CAPTURE_RECORD_MAX byte.
+  * @retval Number of bytes.
+  */
+unsigned int captureEncode(NRF24_CaptureRecord *record, unsigned char *out)
+{
+	unsigned int length = NRF24_CAPTURE_HEADER+record->length;
+
+	capturePut32(&out[0], (unsigned long)(record->time/1000000000ULL));
+	capturePut32(&out[4], (unsigned long)(record->time%1000000000ULL));
+	capturePut32(&out[8], length); //captured
+	capturePut32(&out[12], length); //original
+	out[16] = NRF24_CAPTURE_VERSION;
+	out[17] = record->channel;
+	out[18] = record->pipe;
+	out[19] = record->flags;
+	memcpy(&out[NRF24_CAPTURE_RECORD_HEADER+NRF24_CAPTURE_HEADER], record->data, record->length);
+	return NRF24_CAPTURE_RECORD_HEADER+length;
+}
+
+/**
+  * @brief  Stores 16 bit little endian.
+  *
+  * @param	out: 2 byte.
+  * @param	value: Value.
+  * @retval NONE.
+  */
+void capturePut16(unsigned char *out, unsigned int value)
+{
+	out[0] = value & 0xFF;
+	out[1] = (value>>8) & 0xFF;
+}
+
+/**
+  * @brief  Stores 32 bit little endian.
+  *
+  * @param	out: 4 byte.
+  * @param	value: Value.
+  * @retval NONE.
+  */
+void capturePut32(unsigned char *out, unsigned long value)
+{
+	out[0] = value & 0xFF;
+	out[1] = (value>>8) & 0xFF;
+	out[2] = (value>>16) & 0xFF;
+	out[3] = (value>>24) & 0xFF;
+}
@@ -0,0 +1,132 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_capture.h
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Header file of packet capture of nrf24L01p spidev backend.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NRF24L01P_CAPTURE_H
+#define __NRF24L01P_CAPTURE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p.h>
+#include <nRF24L01p_spidev.h>
+#include <pthread.h>
+
+#ifndef NRF24_CAPTURE_RING_SIZE
+#define NRF24_CAPTURE_RING_SIZE 4096 //records between I/O thread and writer, power of 2
+#endif
+
+#if (NRF24_CAPTURE_RING_SIZE & (NRF24_CAPTURE_RING_SIZE-1))!=0
+#error "NRF24_CAPTURE_RING_SIZE has to be a power of 2"
+#endif
+
+#ifndef NRF24_CAPTURE_BATCH
+#define NRF24_CAPTURE_BATCH 64 //records written by one write()
+#endif
+
+#ifndef NRF24_CAPTURE_IDLE_SLEEP
+#define NRF24_CAPTURE_IDLE_SLEEP 1000 //us writer sleeps when the ring is empty
+#endif
+
+#define NRF24_CAPTURE_CACHE_LINE 64
+
+#define NRF24_CAPTURE_LINKTYPE 147 //LINKTYPE_USER0 of pcap
+#define NRF24_CAPTURE_VERSION 1 //first byte of each frame, version of the pseudo header
+#define NRF24_CAPTURE_HEADER 4 //bytes of pseudo header before the payload
+#define NRF24_CAPTURE_FILE_HEADER 24 //bytes of pcap file header
+#define NRF24_CAPTURE_RECORD_HEADER 16 //bytes of pcap record header
+#define NRF24_CAPTURE_RECORD_MAX (NRF24_CAPTURE_RECORD_HEADER+NRF24_CAPTURE_HEADER+32)
+
+#define NRF24_CAPTURE_RATE 0x03 //flags: NRF24_BaudRate of the channel
+#define NRF24_CAPTURE_RPD 0x04 //flags: RPD was set, signal stronger than -64dBm
+#define NRF24_CAPTURE_RAW 0x08 //flags: promiscuous record, raw bits in the order they were on air
+
+/* Exported types ------------------------------------------------------------*/
+
+/** 
+  * @brief	Capture Record. A received packet and what the radio knew about it.
+  */
+typedef struct {
+    unsigned long long time; //ns, CLOCK_REALTIME when it is read from RX FIFO
+    unsigned char channel;
+    unsigned char pipe;
+    unsigned char length;
+    unsigned char flags; //NRF24_CAPTURE_RATE, NRF24_CAPTURE_RPD and NRF24_CAPTURE_RAW bits
+    char data[32];
+} NRF24_CaptureRecord;
+
+/** 
+  * @brief	SPSC Ring of records, the I/O thread is the producer and the writer the consumer.
+  */
+typedef struct {
+    unsigned int head; //written by I/O thread only
+    char padHead[NRF24_CAPTURE_CACHE_LINE-sizeof(unsigned int)];
+    unsigned int tail; //written by writer only
+    char padTail[NRF24_CAPTURE_CACHE_LINE-sizeof(unsigned int)];
+    NRF24_CaptureRecord slot[NRF24_CAPTURE_RING_SIZE];
+    unsigned char out[NRF24_CAPTURE_BATCH*NRF24_CAPTURE_RECORD_MAX]; //pcap bytes of one write()
+} NRF24_CaptureRing;
+
+/** 
+  * @brief	Capture Counters.
+  */
+typedef struct {
+    unsigned long captured; //records read by I/O thread
+    unsigned long dropped; //records read while the ring was full
+    unsigned long written; //records written to the file
+    unsigned long long bytes; //bytes written, file header included
+    bool failed; //a write failed, writer has stopped
+} NRF24_CaptureStats;
+
+/** 
+  * @brief	Capture.
+  */
+typedef struct {
+    NRF24_Spidev *radio;
+    int fd; //pcap stream: file, pipe or socket
+    NRF24_CaptureRing *ring;
+    pthread_t ioThread;
+    pthread_t writerThread;
+    volatile bool running; //I/O thread runs
+    volatile bool ioStopped; //I/O thread is stopped, writer stops when the ring is empty
+    NRF24_CaptureStats stats;
+} NRF24_Capture;
+
+/* Exported functions --------------------------------------------------------*/
+
+/* Capture functions *********************************************************/
+bool captureStart(NRF24_Capture *capture, NRF24_Spidev *radio, int fd);
+void captureStop(NRF24_Capture *capture);
+void captureGetStats(NRF24_Capture *capture, NRF24_CaptureStats *stats);
+
+/* Format functions **********************************************************/
+unsigned int captureFileHeader(unsigned char *out);
+unsigned int captureEncode(NRF24_CaptureRecord *record, unsigned char *out);
+
+#endif
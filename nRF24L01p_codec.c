@@ -0,0 +1,559 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_codec.c
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Compact telemetry codec for nrf24L01p payloads.
+  *    
+  *         This file provides functions to manage the following 
+  *         functionalities of telemetry records
+  *           + Codec functions
+  @verbatim     
+  ==============================================================================      
+                        ##### How to use this driver #####
+  ============================================================================== 
+  [..]
+   (#) Describe the record struct by an array of NRF24_CodecField in flash,
+	   one entry per field that is sent, and give it to codecInit() with a
+	   history array of NRF24_CODEC_HISTORY records. Both sides use the same
+	   schema.
+
+   (#) In case of Transmitter:
+	   codecEncode() packs as many of the given records as fit in one
+	   payload and returns how many it has taken, send the payload by
+	   sendData() or txEnqueue(). Call codecAcked() with the payload once it
+	   is delivered (TX_DONE event or NRF24_TX_DELIVERED), later records are
+	   sent as changes from it. Without auto ACK, call it after each packet,
+	   lost packets then cost records until next key packet.
+
+   (#) In case of Receiver:
+	   Read the payload by readRxFIFO() and give it to codecDecode(), it
+	   returns the records, or 0 if the record it refers to is not known.
+
+     *** Packet ***    
+     =================================== 
+    [..]
+	  | seq:4 ref:4 | count | bit stream of records |
+	  ref is the packet whose last record the first record is coded
+	  against, ref==seq marks a key packet that needs no reference. Other
+	  records are coded against the record before them. Bits are packed
+	  from LSB of each byte.
+	  A field is sent bits wide, or as varint of group+1 bit groups (group
+	  data bits and a continuation bit). DELTA fields send zig-zag varint
+	  of the change instead, e.g. a temperature that moves by 1 costs 4 bits
+	  with group 3.
+
+     *** Cost ***    
+     =================================== 
+    [..]
+	  Bits are moved up to 8 at a time, there is no multiplication or
+	  division. History costs NRF24_CODEC_HISTORY records of RAM.
+  
+  @endverbatim
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p.h>
+#include <nRF24L01p_codec.h>
+#include <string.h>
+
+/* Private variables ---------------------------------------------------------*/
+char *codecBuffer; //packet being written or read
+unsigned int codecBit; //next bit of codecBuffer
+unsigned char codecEnd; //bytes of codecBuffer
+bool codecOverflow; //a bit beyond codecEnd is needed
+
+/* Private function prototypes -----------------------------------------------*/
+unsigned char codecFind(NRF24_Codec *codec, unsigned char seq);
+void codecKeep(NRF24_Codec *codec, unsigned char seq, char *record);
+void codecPutRecord(NRF24_Codec *codec, char *record, char *previous);
+void codecGetRecord(NRF24_Codec *codec, char *record, char *previous);
+NRF24_CodecValue codecLoad(char *record, unsigned char offset, unsigned char format);
+void codecStore(char *record, unsigned char offset, unsigned char format, NRF24_CodecValue value);
+void codecPutBits(NRF24_CodecValue value, unsigned char bits);
+NRF24_CodecValue codecGetBits(unsigned char bits);
+void codecPutVarint(NRF24_CodecValue value, unsigned char group);
+NRF24_CodecValue codecGetVarint(unsigned char group);
+
+/** @defgroup nrf24L01p_codec Codec functions
+ *  @brief   Codec functions
+ *
+@verbatim
+ ===============================================================================
+						##### Codec functions  #####
+ ===============================================================================
+    [..]
+    Transmitter codes against the last acknowledged packet, receiver keeps
+    last records of the last NRF24_CODEC_HISTORY packets it has decoded. A
+    packet that is received but whose ACK is lost is still in history, so
+    with the default of 2 one lost ACK costs nothing. When the acknowledged
+    packet leaves history of transmitter, the next packet is a key packet.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Starts a codec, first packet is a key packet.
+  *
+  * @param	codec: State of the codec.
+  * @param	fields: Schema of the record.
+  * @param	fieldCount: Number of fields in schema.
+  * @param	recordSize: sizeof the record.
+  * @param	history: Array of NRF24_CODEC_HISTORY records.
+  * @retval NONE.
+  */
+void codecInit(NRF24_Codec *codec, flash NRF24_CodecField *fields, unsigned char fieldCount, unsigned char recordSize, char *history)
+{
+	memset(codec, 0, sizeof(NRF24_Codec));
+	codec->fields = fields;
+	codec->fieldCount = fieldCount;
+	codec->recordSize = recordSize;
+	codec->history = history;
+	memset(codec->historySeq, NRF24_CODEC_NONE, NRF24_CODEC_HISTORY);
+	codec->refSeq = NRF24_CODEC_NONE;
+}
+
+/**
+  * @brief  Packs records into a payload, as many as fit in 32 byte.
+  *
+  * @param	codec: State of the codec.
+  * @param	records: Array of records, oldest first.
+  * @param	count: Number of records.
+  * @param	packet: Array of 32 byte to store the payload.
+  * @param	length: Stores size of the payload.
+  * @retval Number of records taken from the beginning of records, 0 if count is 0 or first record does not fit.
+  */
+unsigned char codecEncode(NRF24_Codec *codec, char *records, unsigned char count, char *packet, unsigned char *length)
+{
+	char *previous = NULL;
+	unsigned char ref = codec->seq; //key packet
+	unsigned char slot = codecFind(codec, codec->refSeq);
+	unsigned char i;
+	unsigned int start;
+
+	if(slot<NRF24_CODEC_HISTORY && codec->sinceKey<NRF24_CODEC_KEY_INTERVAL)
+	{
+		previous = codec->history + slot*codec->recordSize;
+		ref = codec->refSeq;
+	}
+
+	codecBuffer = packet;
+	codecBit = 16;
+	codecEnd = 32;
+	codecOverflow = 0;
+	for(i=0;i<count;i++)
+	{
+		start = codecBit;
+		codecPutRecord(codec, records + i*codec->recordSize, previous);
+		if(codecOverflow==1) //record does not fit
+		{
+			codecBit = start;
+			break;
+		}
+		previous = records + i*codec->recordSize;
+	}
+	if(i==0)
+		return 0;
+
+	if(codecBit&0x07)
+		packet[codecBit>>3] &= (1<<(codecBit&0x07))-1; //bits of the record that did not fit
+	packet[0] = (codec->seq<<4) | ref;
+	packet[1] = i;
+	*length = (codecBit+7)>>3;
+
+	codecKeep(codec, codec->seq, previous);
+	if(ref==codec->seq)
+	{
+		codec->sinceKey = 0;
+		codec->keyPackets++;
+	}
+	else
+		codec->sinceKey++;
+	codec->seq = (codec->seq+1) & 0x0F;
+	codec->packets++;
+	codec->records += i;
+	return i;
+}
+
+/**
+  * @brief  Tells that a payload made by codecEncode() is delivered, next packets are coded against it.
+  *
+  * @param	codec: State of the codec.
+  * @param	packet: The payload.
+  * @retval NONE.
+  */
+void codecAcked(NRF24_Codec *codec, char *packet)
+{
+	unsigned char seq = ((unsigned char)packet[0]>>4) & 0x0F;
+
+	if(codecFind(codec, seq)<NRF24_CODEC_HISTORY)
+		codec->refSeq = seq;
+}
+
+/**
+  * @brief  Unpacks records of a received payload.
+  *
+  * @param	codec: State of the codec.
+  * @param	packet: The payload.
+  * @param	length: Size of the payload.
+  * @param	records: Array to store the records.
+  * @param	max: Number of records that fit in records.
+  * @retval Number of records, 0 if the payload is not valid, has more than max records or its reference is not known.
+  */
+unsigned char codecDecode(NRF24_Codec *codec, char *packet, unsigned char length, char *records, unsigned char max)
+{
+	char *previous = NULL;
+	unsigned char seq = ((unsigned char)packet[0]>>4) & 0x0F;
+	unsigned char ref = packet[0] & 0x0F;
+	unsigned char count = packet[1];
+	unsigned char slot;
+	unsigned char i;
+
+	if(length<2 || length>32 || count==0 || count>max)
+	{
+		codec->corrupted++;
+		return 0;
+	}
+	if(ref!=seq)
+	{
+		slot = codecFind(codec, ref);
+		if(slot>=NRF24_CODEC_HISTORY)
+		{
+			codec->missingRef++;
+			return 0;
+		}
+		previous = codec->history + slot*codec->recordSize;
+	}
+
+	codecBuffer = packet;
+	codecBit = 16;
+	codecEnd = length;
+	codecOverflow = 0;
+	for(i=0;i<count;i++)
+	{
+		codecGetRecord(codec, records + i*codec->recordSize, previous);
+		previous = records + i*codec->recordSize;
+	}
+	if(codecOverflow==1)
+	{
+		codec->corrupted++;
+		return 0;
+	}
+
+	codecKeep(codec, seq, previous);
+	if(ref==seq)
+		codec->keyPackets++;
+	codec->packets++;
+	codec->records += count;
+	return count;
+}
+
+/**
+  * @brief  Finds the history slot of a packet.
+  *
+  * @param	codec: State of the codec.
+  * @param	seq: Sequence of the packet.
+  * @retval Slot, NRF24_CODEC_HISTORY if the packet is not in history.
+  */
+unsigned char codecFind(NRF24_Codec *codec, unsigned char seq)
+{
+	unsigned char slot;
+
+	if(seq==NRF24_CODEC_NONE) //same as empty slots
+		return NRF24_CODEC_HISTORY;
+	for(slot=0;slot<NRF24_CODEC_HISTORY;slot++)
+	{
+		if(codec->historySeq[slot]==seq)
+			break;
+	}
+	return slot;
+}
+
+/**
+  * @brief  Keeps last record of a packet in history, in place of the oldest one.
+  *
+  * @param	codec: State of the codec.
+  * @param	seq: Sequence of the packet.
+  * @param	record: Last record of the packet.
+  * @retval NONE.
+  */
+void codecKeep(NRF24_Codec *codec, unsigned char seq, char *record)
+{
+	if(codec->historySeq[codec->next]==codec->refSeq) //acknowledged packet leaves history, its sequence will be used again
+		codec->refSeq = NRF24_CODEC_NONE;
+	memcpy(codec->history + codec->next*codec->recordSize, record, codec->recordSize);
+	codec->historySeq[codec->next] = seq;
+	codec->next++;
+	if(codec->next>=NRF24_CODEC_HISTORY)
+		codec->next = 0;
+}
+
+/**
+  * @brief  Writes fields of a record to codecBuffer.
+  *
+  * @param	codec: State of the codec.
+  * @param	record: The record.
+  * @param	previous: Record it is coded against, NULL if none.
+  * @retval NONE.
+  */
+void codecPutRecord(NRF24_Codec *codec, char *record, char *previous)
+{
+	flash NRF24_CodecField *field = codec->fields;
+	NRF24_CodecValue value;
+	unsigned char f;
+
+	for(f=0;f<codec->fieldCount;f++,field++)
+	{
+		value = codecLoad(record, field->offset, field->format);
+		if((field->format & NRF24_CODEC_DELTA) && previous!=NULL)
+		{
+			value -= codecLoad(previous, field->offset, field->format);
+			codecPutVarint((value<<1) ^ ((value & 0x80000000) ? 0xFFFFFFFF : 0), field->group); //zig-zag
+		}
+		else if(field->format & NRF24_CODEC_VARINT)
+		{
+			if(field->format & NRF24_CODEC_SIGNED)
+				value = (value<<1) ^ ((value & 0x80000000) ? 0xFFFFFFFF : 0);
+			codecPutVarint(value, field->group);
+		}
+		else
+			codecPutBits(value, field->bits);
+		if(codecOverflow==1)
+			return;
+	}
+}
+
+/**
+  * @brief  Reads fields of a record from codecBuffer.
+  *
+  * @param	codec: State of the codec.
+  * @param	record: Stores the record, bytes that are not in schema are 0.
+  * @param	previous: Record it is coded against, NULL if none.
+  * @retval NONE.
+  */
+void codecGetRecord(NRF24_Codec *codec, char *record, char *previous)
+{
+	flash NRF24_CodecField *field = codec->fields;
+	NRF24_CodecValue value;
+	unsigned char f;
+
+	memset(record, 0, codec->recordSize);
+	for(f=0;f<codec->fieldCount;f++,field++)
+	{
+		if((field->format & NRF24_CODEC_DELTA) && previous!=NULL)
+		{
+			value = codecGetVarint(field->group);
+			value = (value>>1) ^ (0-(value&1)); //zig-zag
+			value += codecLoad(previous, field->offset, field->format);
+		}
+		else if(field->format & NRF24_CODEC_VARINT)
+		{
+			value = codecGetVarint(field->group);
+			if(field->format & NRF24_CODEC_SIGNED)
+				value = (value>>1) ^ (0-(value&1));
+		}
+		else
+		{
+			value = codecGetBits(field->bits);
+			if((field->format & NRF24_CODEC_SIGNED) && field->bits<32 && (value>>(field->bits-1))&1)
+				value |= 0xFFFFFFFF<<field->bits; //sign extension
+		}
+		if(codecOverflow==1)
+			return;
+		codecStore(record, field->offset, field->format, value);
+	}
+}
+
+/**
+  * @brief  Reads a field of a record.
+  *
+  * @param	record: The record.
+  * @param	offset: Offset of the field.
+  * @param	format: Format of the field.
+  * @retval Value, sign extended if the field is signed.
+  */
+NRF24_CodecValue codecLoad(char *record, unsigned char offset, unsigned char format)
+{
+	unsigned short word;
+	NRF24_CodecValue value;
+
+	switch(format & (NRF24_CODEC_SIZE | NRF24_CODEC_SIGNED))
+	{
+		case NRF24_CODEC_U8:
+			return (unsigned char)record[offset];
+		case NRF24_CODEC_S8:
+			return (NRF24_CodecValue)(signed char)record[offset];
+		case NRF24_CODEC_U16:
+			memcpy(&word, record+offset, 2);
+			return word;
+		case NRF24_CODEC_S16:
+			memcpy(&word, record+offset, 2);
+			return (NRF24_CodecValue)(short)word;
+		default:
+			memcpy(&value, record+offset, 4);
+			return value;
+	}
+}
+
+/**
+  * @brief  Writes a field of a record.
+  *
+  * @param	record: The record.
+  * @param	offset: Offset of the field.
+  * @param	format: Format of the field.
+  * @param	value: Value, only the size of the field is written.
+  * @retval NONE.
+  */
+void codecStore(char *record, unsigned char offset, unsigned char format, NRF24_CodecValue value)
+{
+	unsigned short word = value;
+
+	switch(format & NRF24_CODEC_SIZE)
+	{
+		case NRF24_CODEC_U8:
+			record[offset] = value;
+			break;
+		case NRF24_CODEC_U16:
+			memcpy(record+offset, &word, 2);
+			break;
+		default:
+			memcpy(record+offset, &value, 4);
+	}
+}
+
+/**
+  * @brief  Writes low bits of a value to codecBuffer.
+  *
+  * @param	value: The value.
+  * @param	bits: Number of bits, 1 to 32.
+  * @retval NONE.
+  */
+void codecPutBits(NRF24_CodecValue value, unsigned char bits)
+{
+	unsigned char byte;
+	unsigned char shift;
+	unsigned char n;
+
+	while(bits>0)
+	{
+		byte = codecBit>>3;
+		shift = codecBit & 0x07;
+		if(byte>=codecEnd)
+		{
+			codecOverflow = 1;
+			return;
+		}
+		n = 8-shift;
+		if(n>bits)
+			n = bits;
+		codecBuffer[byte] = (codecBuffer[byte] & ((1<<shift)-1)) | (((unsigned char)value & ((1<<n)-1)) << shift);
+		value >>= n;
+		bits -= n;
+		codecBit += n;
+	}
+}
+
+/**
+  * @brief  Reads bits from codecBuffer.
+  *
+  * @param	bits: Number of bits, 1 to 32.
+  * @retval The bits, first one is LSB.
+  */
+NRF24_CodecValue codecGetBits(unsigned char bits)
+{
+	NRF24_CodecValue value = 0;
+	unsigned char got = 0;
+	unsigned char byte;
+	unsigned char shift;
+	unsigned char n;
+
+	while(got<bits)
+	{
+		byte = codecBit>>3;
+		shift = codecBit & 0x07;
+		if(byte>=codecEnd)
+		{
+			codecOverflow = 1;
+			return 0;
+		}
+		n = 8-shift;
+		if(n>bits-got)
+			n = bits-got;
+		value |= (NRF24_CodecValue)(((unsigned char)codecBuffer[byte]>>shift) & ((1<<n)-1)) << got;
+		got += n;
+		codecBit += n;
+	}
+	return value;
+}
+
+/**
+  * @brief  Writes a varint to codecBuffer.
+  *
+  * @param	value: The value.
+  * @param	group: Data bits of each group, 1 to 8.
+  * @retval NONE.
+  */
+void codecPutVarint(NRF24_CodecValue value, unsigned char group)
+{
+	unsigned char data;
+
+	do
+	{
+		data = value & ((1<<group)-1);
+		value >>= group;
+		codecPutBits(data | (value!=0 ? 1<<group : 0), group+1);
+	}
+	while(value!=0 && codecOverflow==0);
+}
+
+/**
+  * @brief  Reads a varint from codecBuffer.
+  *
+  * @param	group: Data bits of each group, 1 to 8.
+  * @retval The value.
+  */
+NRF24_CodecValue codecGetVarint(unsigned char group)
+{
+	NRF24_CodecValue value = 0;
+	unsigned int data;
+	unsigned char shift = 0;
+
+	do
+	{
+		if(shift>=32) //too long, packet is corrupted
+		{
+			codecOverflow = 1;
+			return 0;
+		}
+		data = codecGetBits(group+1);
+		value |= (NRF24_CodecValue)(data & ((1<<group)-1)) << shift;
+		shift += group;
+	}
+	while((data>>group)&1);
+	return value;
+}
@@ -0,0 +1,116 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_codec.h
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Header file of compact telemetry codec for nrf24L01p payloads.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NRF24L01P_CODEC_H
+#define __NRF24L01P_CODEC_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p.h>
+
+#ifndef __CODEVISIONAVR__
+#define flash const //tables are in flash on AVR, const elsewhere
+#endif
+
+#ifdef __CODEVISIONAVR__
+typedef unsigned long NRF24_CodecValue; //a field of up to 32 bit
+#else
+#include <stdint.h>
+typedef uint32_t NRF24_CodecValue; //long is 64 bit on Linux gateways
+#endif
+
+#ifndef NRF24_CODEC_HISTORY
+#define NRF24_CODEC_HISTORY 2 //last records of recent packets kept as delta references, 1 more than packets that may be unacknowledged
+#endif
+
+#if NRF24_CODEC_HISTORY<1 || NRF24_CODEC_HISTORY>8
+#error "NRF24_CODEC_HISTORY has to be 1 to 8"
+#endif
+
+#ifndef NRF24_CODEC_KEY_INTERVAL
+#define NRF24_CODEC_KEY_INTERVAL 32 //packets between key packets, a receiver that has lost its references recovers at the next one
+#endif
+
+#define NRF24_CODEC_NONE 0xFF //no packet
+
+/* Field formats, size of the field in record ORed with the options */
+#define NRF24_CODEC_U8 0x01
+#define NRF24_CODEC_U16 0x02
+#define NRF24_CODEC_U32 0x04
+#define NRF24_CODEC_SIGNED 0x08
+#define NRF24_CODEC_S8 (NRF24_CODEC_U8 | NRF24_CODEC_SIGNED)
+#define NRF24_CODEC_S16 (NRF24_CODEC_U16 | NRF24_CODEC_SIGNED)
+#define NRF24_CODEC_S32 (NRF24_CODEC_U32 | NRF24_CODEC_SIGNED)
+#define NRF24_CODEC_VARINT 0x10 //value is sent as varint (zig-zag if signed) instead of bits wide
+#define NRF24_CODEC_DELTA 0x20 //change from previous record is sent as zig-zag varint, when there is one
+#define NRF24_CODEC_SIZE 0x07
+
+/* Exported types ------------------------------------------------------------*/
+
+/** 
+  * @brief	Codec Field. One field of a record schema, schemas are arrays of fields in flash.
+  */
+typedef struct {
+    unsigned char offset; //of the field in record, offsetof()
+    unsigned char format; //NRF24_CODEC_U8 ... NRF24_CODEC_S32, ORed with NRF24_CODEC_VARINT and NRF24_CODEC_DELTA
+    unsigned char bits; //width of a bit packed value, 1 to 32
+    unsigned char group; //data bits in each group of a varint, 1 to 8
+} NRF24_CodecField;
+
+/** 
+  * @brief	Codec State. One per schema and direction, history is given by the application.
+  */
+typedef struct {
+    flash NRF24_CodecField *fields;
+    unsigned char fieldCount;
+    unsigned char recordSize;
+    char *history; //NRF24_CODEC_HISTORY records
+    unsigned char historySeq[NRF24_CODEC_HISTORY]; //packet whose last record is in each slot, NRF24_CODEC_NONE if empty
+    unsigned char next; //slot written next
+    unsigned char seq; //sequence of next encoded packet, 0 to 15
+    unsigned char refSeq; //last acknowledged packet, NRF24_CODEC_NONE if none
+    unsigned char sinceKey; //packets encoded since last key packet
+    unsigned int packets; //encoded or decoded
+    unsigned int keyPackets;
+    unsigned int records;
+    unsigned int missingRef; //received packets whose reference was not in history
+    unsigned int corrupted; //received packets shorter than their records
+} NRF24_Codec;
+
+/* Exported functions --------------------------------------------------------*/
+
+/* Codec functions ***********************************************************/
+void codecInit(NRF24_Codec *codec, flash NRF24_CodecField *fields, unsigned char fieldCount, unsigned char recordSize, char *history);
+unsigned char codecEncode(NRF24_Codec *codec, char *records, unsigned char count, char *packet, unsigned char *length);
+void codecAcked(NRF24_Codec *codec, char *packet);
+unsigned char codecDecode(NRF24_Codec *codec, char *packet, unsigned char length, char *records, unsigned char max);
+
+#endif
@@ -0,0 +1,487 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_emu.c
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   nrf24L01p emulator behind a fake spidev.
+  *    
+  *         This file provides functions to emulate a nrf24 on a PC
+  *           + Emulator functions
+  @verbatim     
+  ==============================================================================      
+                        ##### How to use this driver #####
+  ============================================================================== 
+  [..]
+   (#) emuStart() resets an NRF24_EmuChip and starts its thread, then
+	   spidevAttach(radio, emuSpiFd(chip), emuIrqFd(chip)) makes a radio of
+	   nRF24L01p_spidev.c talk to it like to a real chip on /dev/spidev.
+
+   (#) Packets are put in RX FIFO by emuInject(), as if they were heard
+	   over the air. Two chips joined by emuConnect() receive packets of
+	   each other when they are on the same channel, rate and address.
+
+     *** Emulation ***    
+     =================================== 
+    [..]
+	  (+) Registers, 3 level RX and TX FIFOs, STATUS flags with masks and
+	      IRQ falling edges are emulated, each SPI transfer is one CSN frame.
+	  (+) There is no timing: a packet is sent as soon as it is in TX FIFO
+	      with CE high, and it is delivered, so TX_DS is always set.
+	  (+) The fake spidev is a seqpacket socket, so every batch still costs
+	      real syscalls, like SPI_IOC_MESSAGE on a real spidev.
+  
+  @endverbatim
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p.h>
+#include <nRF24L01p_spidev.h>
+#include <nRF24L01p_emu.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+/* Private define ------------------------------------------------------------*/
+#define W_REGISTER 0x20
+#define R_RX_PAYLOAD 0x61
+#define W_TX_PAYLOAD 0xA0
+#define W_TX_PAYLOAD_NOACK 0xB0
+#define FLUSH_TX 0xE1
+#define FLUSH_RX 0xE2
+#define R_RX_PL_WID 0x60
+
+#define CONFIG 0x00
+#define SETUP_AW 0x03
+#define RF_CH 0x05
+#define RF_SETUP 0x06
+#define STATUS 0x07
+#define RX_ADDR_P0 0x0A
+#define RX_ADDR_P1 0x0B
+#define TX_ADDR 0x10
+#define FIFO_STATUS 0x17
+
+/* Private function prototypes -----------------------------------------------*/
+void *emuServe(void *chip);
+void emuUpdate(NRF24_EmuChip *chip);
+unsigned char emuTakeTx(NRF24_EmuChip *chip, unsigned char packets[3][33]);
+bool emuReceives(NRF24_EmuChip *chip, NRF24_EmuChip *sender);
+bool emuPush(NRF24_EmuChip *chip, unsigned char pipe, unsigned char *data, unsigned char size);
+
+/** @defgroup nrf24L01p_emu Emulator functions
+ *  @brief   Emulator functions
+ *
+@verbatim
+ ===============================================================================
+						##### Emulator functions  #####
+ ===============================================================================
+    [..]
+    The thread of a chip and emuInject() of other threads share the chip,
+    so every access holds its lock. Packets to a peer are delivered after
+    the lock of the sender is released, two chips can send to each other.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Resets the chip to power on values and starts serving its fake spidev.
+  *
+  * @param	chip: Chip to start.
+  * @retval 1: started, 0: sockets or thread could not be made.
+  */
+bool emuStart(NRF24_EmuChip *chip)
+{
+	memset(chip, 0, sizeof(NRF24_EmuChip));
+	chip->reg[CONFIG] = 0x08;
+	chip->reg[0x01] = 0x3F; //EN_AA
+	chip->reg[0x02] = 0x03; //EN_RXADDR
+	chip->reg[SETUP_AW] = 0x03;
+	chip->reg[0x04] = 0x03; //SETUP_RETR
+	chip->reg[RF_CH] = 0x02;
+	chip->reg[RF_SETUP] = 0x0E;
+	chip->reg[STATUS] = 0x0E;
+	chip->reg[0x0C] = 0xC3; //RX_ADDR_P2 to P5
+	chip->reg[0x0D] = 0xC4;
+	chip->reg[0x0E] = 0xC5;
+	chip->reg[0x0F] = 0xC6;
+	chip->reg[FIFO_STATUS] = 0x11;
+	memset(chip->rxAddress[0], 0xE7, 5);
+	memset(chip->rxAddress[1], 0xC2, 5);
+	memset(chip->txAddress, 0xE7, 5);
+
+	if(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, chip->spiFd)<0)
+		return 0;
+	if(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, chip->irqFd)<0)
+	{
+		close(chip->spiFd[0]);
+		close(chip->spiFd[1]);
+		return 0;
+	}
+	pthread_mutex_init(&chip->lock, NULL);
+	if(pthread_create(&chip->thread, NULL, emuServe, chip)!=0)
+	{
+		emuStop(chip);
+		return 0;
+	}
+	return 1;
+}
+
+/**
+  * @brief  Stops the thread of the chip and closes its sockets.
+  *
+  * @param	chip: Chip to stop.
+  * @retval NONE.
+  */
+void emuStop(NRF24_EmuChip *chip)
+{
+	shutdown(chip->spiFd[0], SHUT_RDWR); //thread sees end of file
+	if(chip->thread!=0)
+		pthread_join(chip->thread, NULL);
+	close(chip->spiFd[0]);
+	close(chip->spiFd[1]);
+	close(chip->irqFd[0]);
+	close(chip->irqFd[1]);
+	pthread_mutex_destroy(&chip->lock);
+	chip->thread = 0;
+}
+
+/**
+  * @brief  Socket to give to spidevAttach() as spidev.
+  *
+  * @param	chip: Chip.
+  * @retval Socket.
+  */
+int emuSpiFd(NRF24_EmuChip *chip)
+{
+	return chip->spiFd[0];
+}
+
+/**
+  * @brief  Socket to give to spidevAttach() as IRQ, it gets one byte on each falling edge.
+  *
+  * @param	chip: Chip.
+  * @retval Socket.
+  */
+int emuIrqFd(NRF24_EmuChip *chip)
+{
+	return chip->irqFd[0];
+}
+
+/**
+  * @brief  Joins two chips, each one receives packets of the other one.
+  *
+  * @param	a: First chip.
+  * @param	b: Second chip.
+  * @retval NONE.
+  */
+void emuConnect(NRF24_EmuChip *a, NRF24_EmuChip *b)
+{
+	a->peer = b;
+	b->peer = a;
+}
+
+/**
+  * @brief  Puts a packet in RX FIFO as if it was received over the air.
+  *
+  * @param	chip: Receiving chip.
+  * @param	pipe: Data pipe number, 0 to 5.
+  * @param	data: Packet, in the order it is read by R_RX_PAYLOAD.
+  * @param	size: size of data, 1 to 32.
+  * @retval 1: stored, 0: RX FIFO is full and packet is lost.
+  */
+bool emuInject(NRF24_EmuChip *chip, unsigned char pipe, unsigned char *data, unsigned char size)
+{
+	bool stored;
+
+	pthread_mutex_lock(&chip->lock);
+	stored = emuPush(chip, pipe, data, size);
+	pthread_mutex_unlock(&chip->lock);
+	return stored;
+}
+
+/**
+  * @brief  Executes one SPI transfer (one CSN frame).
+  *
+  * @param	chip: Chip.
+  * @param	tx: Bytes sent to the chip, instruction first.
+  * @param	rx: Stores bytes sent by the chip, STATUS first.
+  * @param	length: Number of bytes, at least 1.
+  * @retval NONE.
+  */
+void emuTransfer(NRF24_EmuChip *chip, unsigned char *tx, unsigned char *rx, unsigned char length)
+{
+	unsigned char packets[3][33];
+	unsigned char sent;
+	unsigned char ins = tx[0];
+	unsigned char address = ins & 0x1F;
+	unsigned char slot;
+	unsigned char i;
+
+	pthread_mutex_lock(&chip->lock);
+	memset(rx, 0, length);
+	rx[0] = chip->reg[STATUS];
+
+	if(ins<W_REGISTER) //R_REGISTER
+	{
+		for(i=1;i<length;i++)
+		{
+			if(address==RX_ADDR_P0 || address==RX_ADDR_P1)
+				rx[i] = chip->rxAddress[address-RX_ADDR_P0][(i-1)%5];
+			else if(address==TX_ADDR)
+				rx[i] = chip->txAddress[(i-1)%5];
+			else if(address<sizeof(chip->reg))
+				rx[i] = chip->reg[address];
+		}
+	}
+	else if(ins<0x40 && length>1) //W_REGISTER
+	{
+		if(address==STATUS)
+			chip->reg[STATUS] &= ~(tx[1]&0x70); //write 1 to clear
+		else if(address==RX_ADDR_P0 || address==RX_ADDR_P1)
+			memcpy(chip->rxAddress[address-RX_ADDR_P0], &tx[1], (length-1<5) ? length-1 : 5);
+		else if(address==TX_ADDR)
+			memcpy(chip->txAddress, &tx[1], (length-1<5) ? length-1 : 5);
+		else if(address<sizeof(chip->reg) && address!=FIFO_STATUS && address!=0x08 && address!=0x09) //OBSERVE_TX and RPD are read only
+			chip->reg[address] = tx[1];
+	}
+	else if(ins==R_RX_PAYLOAD)
+	{
+		if(chip->rxCount>0)
+		{
+			for(i=1;i<length && i<=chip->rxWidth[chip->rxHead];i++)
+				rx[i] = chip->rxFifo[chip->rxHead][i-1];
+			chip->rxHead = (chip->rxHead+1)%3; //payload is deleted from RX FIFO after it is read
+			chip->rxCount--;
+		}
+	}
+	else if(ins==R_RX_PL_WID)
+	{
+		if(length>1 && chip->rxCount>0)
+			rx[1] = chip->rxWidth[chip->rxHead];
+	}
+	else if((ins==W_TX_PAYLOAD || ins==W_TX_PAYLOAD_NOACK) && length>1 && length<=33)
+	{
+		if(chip->txCount<3)
+		{
+			slot = (chip->txHead+chip->txCount)%3;
+			memcpy(chip->txFifo[slot], &tx[1], length-1);
+			chip->txWidth[slot] = length-1;
+			chip->txCount++;
+		}
+	}
+	else if(ins==FLUSH_TX)
+	{
+		chip->txCount = 0;
+	}
+	else if(ins==FLUSH_RX)
+	{
+		chip->rxCount = 0;
+	}
+	//W_ACK_PAYLOAD, REUSE_TX_PL, ACTIVATE and NOP change nothing here
+
+	sent = emuTakeTx(chip, packets);
+	emuUpdate(chip);
+	pthread_mutex_unlock(&chip->lock);
+
+	for(i=0;i<sent;i++) //outside of the lock of sender
+		if(chip->peer!=NULL && emuReceives(chip->peer, chip))
+			emuInject(chip->peer, 0, &packets[i][1], packets[i][0]);
+}
+
+/**
+  * @brief  Drives CE of the chip.
+  *
+  * @param	chip: Chip.
+  * @param	level: 1: high, 0: low.
+  * @retval NONE.
+  */
+void emuSetCe(NRF24_EmuChip *chip, bool level)
+{
+	unsigned char packets[3][33];
+	unsigned char sent;
+	unsigned char i;
+
+	pthread_mutex_lock(&chip->lock);
+	chip->ce = level;
+	sent = emuTakeTx(chip, packets);
+	emuUpdate(chip);
+	pthread_mutex_unlock(&chip->lock);
+
+	for(i=0;i<sent;i++)
+		if(chip->peer!=NULL && emuReceives(chip->peer, chip))
+			emuInject(chip->peer, 0, &packets[i][1], packets[i][0]);
+}
+
+/**
+  * @brief  Thread of a chip, answers messages of its fake spidev till the socket is closed.
+  *
+  * @param	chip: Chip.
+  * @retval NULL.
+  */
+void *emuServe(void *arg)
+{
+	NRF24_EmuChip *chip = (NRF24_EmuChip*)arg;
+	unsigned char message[2+NRF24_SPIDEV_MAX_XFERS*34];
+	unsigned char answer[NRF24_SPIDEV_MAX_XFERS*34];
+	unsigned int position;
+	unsigned int length;
+	unsigned int answered;
+	int received;
+	unsigned char i;
+
+	while(1)
+	{
+		received = recv(chip->spiFd[1], message, sizeof(message), 0);
+		if(received<=0)
+			break;
+
+		if(message[0]==NRF24_FAKE_CE && received==2)
+		{
+			emuSetCe(chip, message[1]!=0);
+		}
+		else if(message[0]==NRF24_FAKE_XFER && received>=2)
+		{
+			position = 2;
+			answered = 0;
+			for(i=0;i<message[1];i++)
+			{
+				length = message[position++];
+				if(length==0 || position+length>(unsigned int)received)
+					break; //broken message
+				emuTransfer(chip, &message[position], &answer[answered], length);
+				position += length;
+				answered += length;
+			}
+			send(chip->spiFd[1], answer, answered, 0);
+		}
+	}
+	return NULL;
+}
+
+/**
+  * @brief  Updates FIFO_STATUS and RX_P_NO, makes a falling edge on IRQ when an unmasked flag is set.
+  *
+  * @param	chip: Chip, locked by caller.
+  * @retval NONE.
+  */
+void emuUpdate(NRF24_EmuChip *chip)
+{
+	unsigned char status = chip->reg[STATUS] & 0x70;
+	unsigned char edge = 1;
+	bool irq;
+
+	status |= (chip->rxCount>0) ? (chip->rxPipe[chip->rxHead]<<1) : 0x0E; //RX_P_NO, 7: RX FIFO empty
+	status |= (chip->txCount==3) ? 0x01 : 0x00; //TX_FULL
+	chip->reg[STATUS] = status;
+
+	chip->reg[FIFO_STATUS] = (chip->txCount==3 ? 0x20 : 0x00) | (chip->txCount==0 ? 0x10 : 0x00) |
+		(chip->rxCount==3 ? 0x02 : 0x00) | (chip->rxCount==0 ? 0x01 : 0x00);
+
+	irq = (status & ~chip->reg[CONFIG] & 0x70)!=0; //MASK_x bits of CONFIG are at the same place as the flags
+	if(irq==1 && chip->irq==0)
+		send(chip->irqFd[1], &edge, 1, MSG_DONTWAIT);
+	chip->irq = irq;
+}
+
+/**
+  * @brief  Takes packets out of TX FIFO if the chip is a powered transmitter with CE high.
+  *
+  * @param	chip: Chip, locked by caller.
+  * @param	packets: Stores size and bytes of each packet.
+  * @retval Number of packets sent.
+  */
+unsigned char emuTakeTx(NRF24_EmuChip *chip, unsigned char packets[3][33])
+{
+	unsigned char sent = 0;
+
+	if(chip->ce==0 || (chip->reg[CONFIG]&0x03)!=0x02) //PWR_UP and PTX
+		return 0;
+
+	while(chip->txCount>0)
+	{
+		packets[sent][0] = chip->txWidth[chip->txHead];
+		memcpy(&packets[sent][1], chip->txFifo[chip->txHead], chip->txWidth[chip->txHead]);
+		chip->txHead = (chip->txHead+1)%3;
+		chip->txCount--;
+		chip->reg[STATUS] |= 0x20; //TX_DS
+		chip->transmitted++;
+		sent++;
+	}
+	return sent;
+}
+
+/**
+  * @brief  Indicates if a chip hears packets of a sender: PRX with CE high, same channel, rate and pipe 0 address.
+  *
+  * @param	chip: Receiving chip.
+  * @param	sender: Sending chip.
+  * @retval 1: packet is received.
+  */
+bool emuReceives(NRF24_EmuChip *chip, NRF24_EmuChip *sender)
+{
+	unsigned char width;
+	bool receives;
+
+	pthread_mutex_lock(&chip->lock);
+	width = (chip->reg[SETUP_AW]&0x03)+2;
+	receives = chip->ce==1 && (chip->reg[CONFIG]&0x03)==0x03 && chip->reg[RF_CH]==sender->reg[RF_CH] &&
+		(chip->reg[RF_SETUP]&0x28)==(sender->reg[RF_SETUP]&0x28) && memcmp(chip->rxAddress[0], sender->txAddress, width)==0;
+	pthread_mutex_unlock(&chip->lock);
+	return receives;
+}
+
+/**
+  * @brief  Stores a packet in RX FIFO and sets RX_DR.
+  *
+  * @param	chip: Chip, locked by caller.
+  * @param	pipe: Data pipe number.
+  * @param	data: Packet.
+  * @param	size: size of data, 1 to 32.
+  * @retval 1: stored, 0: RX FIFO is full.
+  */
+bool emuPush(NRF24_EmuChip *chip, unsigned char pipe, unsigned char *data, unsigned char size)
+{
+	unsigned char slot;
+
+	if(size==0 || size>32 || pipe>5)
+		return 0;
+	if(chip->rxCount==3)
+	{
+		chip->overflows++;
+		return 0;
+	}
+
+	slot = (chip->rxHead+chip->rxCount)%3;
+	memcpy(chip->rxFifo[slot], data, size);
+	chip->rxWidth[slot] = size;
+	chip->rxPipe[slot] = pipe;
+	chip->rxCount++;
+	chip->reg[STATUS] |= 0x40; //RX_DR
+	chip->injected++;
+	emuUpdate(chip);
+	return 1;
+}
@@ -0,0 +1,82 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_emu.h
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Header file of nrf24L01p emulator behind a fake spidev.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NRF24L01P_EMU_H
+#define __NRF24L01P_EMU_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p.h>
+#include <pthread.h>
+
+/* Exported types ------------------------------------------------------------*/
+
+/** 
+  * @brief	Emulated Chip. Registers and FIFOs of one nrf24, served to nRF24L01p_spidev.c by a thread.
+  */
+typedef struct NRF24_EmuChip {
+    unsigned char reg[0x1E]; //one byte registers, indexed by address
+    unsigned char rxAddress[2][5]; //RX_ADDR_P0 and RX_ADDR_P1, in the order they are sent (LSByte first)
+    unsigned char txAddress[5];
+    unsigned char rxFifo[3][32];
+    unsigned char rxWidth[3];
+    unsigned char rxPipe[3];
+    unsigned char rxHead;
+    unsigned char rxCount;
+    unsigned char txFifo[3][32];
+    unsigned char txWidth[3];
+    unsigned char txHead;
+    unsigned char txCount;
+    bool ce;
+    bool irq; //IRQ pin is low
+    int spiFd[2]; //fake spidev socket pair, [1] is used by the emulator
+    int irqFd[2]; //IRQ socket pair, [1] is used by the emulator
+    pthread_t thread;
+    pthread_mutex_t lock;
+    struct NRF24_EmuChip *peer; //receives packets sent by this chip, NULL: packets are lost
+    unsigned long injected; //packets put in RX FIFO
+    unsigned long overflows; //packets lost because RX FIFO was full
+    unsigned long transmitted; //packets sent from TX FIFO
+} NRF24_EmuChip;
+
+/* Exported functions --------------------------------------------------------*/
+
+/* Emulator functions ********************************************************/
+bool emuStart(NRF24_EmuChip *chip);
+void emuStop(NRF24_EmuChip *chip);
+int emuSpiFd(NRF24_EmuChip *chip);
+int emuIrqFd(NRF24_EmuChip *chip);
+void emuConnect(NRF24_EmuChip *a, NRF24_EmuChip *b);
+bool emuInject(NRF24_EmuChip *chip, unsigned char pipe, unsigned char *data, unsigned char size);
+void emuTransfer(NRF24_EmuChip *chip, unsigned char *tx, unsigned char *rx, unsigned char length);
+void emuSetCe(NRF24_EmuChip *chip, bool level);
+
+#endif
@@ -0,0 +1,457 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_fec.c
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Cross packet FEC for broadcasts over nrf24L01p driver.
+  *    
+  *         This file provides firmware functions to manage the following 
+  *         functionalities of one-to-many links without ACK
+  *           + FEC functions
+  @verbatim     
+  ==============================================================================      
+                        ##### How to use this driver #####
+  ============================================================================== 
+  [..]
+   (#) Call fecInit() with the same block of k data and m parity packets on
+	   sender and receivers, after nRF_Config().
+
+   (#) In case of Transmitter:
+	   fecSend() queues a packet of up to 27 bytes without ACK, after k
+	   packets m parity packets are queued. Call fecFlush() at end of a
+	   burst, so the last short block gets its parity too.
+
+   (#) In case of Receiver:
+	   Call fecService() in main loop, it reads received packets straight
+	   from RX FIFO in polled mode and rebuilds lost ones as soon as any k
+	   packets of a block are there. Read data packets by fecRead() in
+	   order of sending; a lost packet holds the next ones back till it is
+	   rebuilt or its block can not be decoded any more.
+
+     *** Packet ***    
+     =================================== 
+    [..]
+	  | 0xFC | block | used<<4 | index | k<<4 | m | length | data, 27 bytes |
+	  Every packet is 32 bytes. index is 0 to k-1 for data and k to k+m-1
+	  for parity; used is only set by parity of a short block sent by
+	  fecFlush(). length and data are the symbol that is coded.
+  
+  @endverbatim
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <mega88a.h>
+#include <nRF24L01p.h>
+#include <nRF24L01p_fec.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define FEC_MAGIC 0xFC //first byte of every packet
+#define FEC_HEADER 4
+#define FEC_SYMBOL (NRF24_FEC_MAX_DATA+1) //length byte and data
+
+#if NRF24_FEC_MAX_K+NRF24_FEC_MAX_M>16 || NRF24_FEC_MAX_M>NRF24_RS_MAX_M
+#error index of a packet is 4 bit and rsDecode() uses up to NRF24_RS_MAX_M parity packets
+#endif
+
+#if NRF24_FEC_MAX_M+1>NRF24_TX_QUEUE_SIZE
+#error last data packet of a block and its parity packets are queued together
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+unsigned char fecK = 0; //data packets per block
+unsigned char fecM = 0; //parity packets per block
+
+unsigned char fecParity[NRF24_FEC_MAX_M][FEC_SYMBOL]; //sender: parity of current block, updated by every data packet
+unsigned char fecTxBlock = 0;
+unsigned char fecTxIndex = 0; //data packets sent in current block
+
+unsigned char fecSymbols[NRF24_FEC_MAX_K+NRF24_FEC_MAX_M][FEC_SYMBOL]; //receiver: symbols of current block
+unsigned int fecPresent = 0; //bit i: symbol i is received or rebuilt
+unsigned int fecPadding = 0; //bit i: data symbol i is padding of a short block
+unsigned char fecReadIndex = 0; //next data symbol given to fecRead()
+unsigned char fecRxHighest = 0; //highest index received in current block, packets are sent in order of index
+bool fecRxClosed = 0; //a packet of next block has come, missing symbols of current block are lost
+char fecPending[NRF24_FEC_PENDING][32]; //packets of next block, wait till fecRead() has read current block
+unsigned char fecPendingHead = 0;
+unsigned char fecPendingCount = 0;
+unsigned char fecRxBlock = 0;
+unsigned char fecRxK = 0; //k and m of current block, from its header
+unsigned char fecRxM = 0;
+bool fecRxActive = 0; //a block is received
+
+NRF24_FecStats fecStats;
+
+/* Private function prototypes -----------------------------------------------*/
+void fecSendParity(unsigned char used);
+bool fecAccept(char *packet);
+void fecEndBlock();
+bool fecDecodable();
+bool fecUnread();
+
+/** @defgroup nrf24L01p_fec FEC functions
+ *  @brief   FEC functions
+ *
+@verbatim
+ ===============================================================================
+							##### FEC functions  #####
+ ===============================================================================
+    [..]
+    Sender does not keep data packets, parity is updated by each one when
+    it is queued. Packets go through TX queue, so they leave back to back
+    without overlapping on air; sendData() would flush a packet that is
+    still being sent. Receiver keeps one block; the first packet of a newer block
+    ends the current one and its packets that are not rebuilt are lost.
+    Packets come back to back, the single packet buffer of IRQ service
+    routine would flush RX FIFO behind it, so receiver reads up to 3 packets
+    straight from RX FIFO by pollReceive() on each fecService(). Packets of
+    the next block wait in NRF24_FEC_PENDING places while fecRead() gives
+    the rest of current block; when they are full, RX FIFO is not read.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Sets the block size, starts a new block on both sides. Enables dynamic ACK.
+  *
+  * @param	k: Data packets per block, 1 to NRF24_FEC_MAX_K.
+  * @param	m: Parity packets per block, 0 to NRF24_FEC_MAX_M, 1 is XOR parity.
+  * @retval 1: block size is set, 0: a parameter is not valid.
+  */
+bool fecInit(unsigned char k, unsigned char m)
+{
+	if(k==0 || k>NRF24_FEC_MAX_K || m>NRF24_FEC_MAX_M)
+		return 0;
+
+	setDynamicAck(1); //packets are sent without ACK
+	fecK = k;
+	fecM = m;
+	fecTxIndex = 0;
+	memset(fecParity, 0, sizeof(fecParity));
+	fecRxActive = 0;
+	fecPendingCount = 0;
+	memset(&fecStats, 0, sizeof(fecStats));
+	return 1;
+}
+
+/**
+  * @brief  Sends a data packet and the parity of the block when it is complete.
+  *
+  * @param	data: data to be sent.
+  * @param	size: size of data, 1 to 27.
+  * @retval 1: packet is queued, 0: TX queue is full, size is not valid or fecInit() is not called.
+  */
+bool fecSend(char *data, unsigned char size)
+{
+	char packet[32];
+	unsigned char *symbol = (unsigned char *)&packet[FEC_HEADER];
+	unsigned char row;
+
+	if(fecK==0 || size==0 || size>NRF24_FEC_MAX_DATA)
+		return 0;
+	if(txQueueFree() < ((fecTxIndex+1==fecK) ? 1+fecM : 1)) //last packet of a block needs room for parity too
+		return 0;
+
+	packet[0] = FEC_MAGIC;
+	packet[1] = fecTxBlock;
+	packet[2] = fecTxIndex;
+	packet[3] = (fecK<<4) | fecM;
+	symbol[0] = size;
+	memcpy(&symbol[1], data, size);
+	memset(&symbol[1+size], 0, NRF24_FEC_MAX_DATA-size);
+	txEnqueueNoAck(packet, 32);
+
+	for(row=0;row<fecM;row++)
+		gfMulAdd(fecParity[row], symbol, rsCoefficient(fecK, fecM, row, fecTxIndex), FEC_SYMBOL);
+
+	fecTxIndex++;
+	if(fecTxIndex==fecK)
+		fecSendParity(fecK);
+	return 1;
+}
+
+/**
+  * @brief  Ends a short block, its parity is queued now.
+  *
+  * @param	NONE.
+  * @retval 1: block is ended or there was none, 0: TX queue has no room for parity, call again.
+  */
+bool fecFlush()
+{
+	if(fecTxIndex==0)
+		return 1;
+	if(txQueueFree()<fecM)
+		return 0;
+	fecSendParity(fecTxIndex);
+	return 1;
+}
+
+/**
+  * @brief  Reads received packets from RX FIFO and rebuilds lost ones. Has to be called in main loop.
+  *         Puts nrf24 in polled mode on first call.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void fecService()
+{
+	char packet[32];
+	unsigned char size;
+	unsigned char *symbols[NRF24_FEC_MAX_K+NRF24_FEC_MAX_M];
+	unsigned char i;
+
+	if(getPolledMode()==0)
+		setPolledMode(1); //RX FIFO is drained here
+
+	while(fecPendingCount>0 && fecAccept(fecPending[fecPendingHead])==1) //current block is read, next one starts
+	{
+		fecPendingHead = (fecPendingHead+1) % NRF24_FEC_PENDING;
+		fecPendingCount--;
+	}
+
+	for(i=0;i<3 && fecPendingCount<NRF24_FEC_PENDING;i++) //RX FIFO holds 3 packets, they wait there when pending places are full
+	{
+		size = pollReceive(packet, NULL);
+		if(size==0)
+			break;
+		if(size!=32 || (unsigned char)packet[0]!=FEC_MAGIC)
+			continue;
+		if(fecPendingCount>0 || fecAccept(packet)==0) //in order, behind the ones that wait
+		{
+			memcpy(fecPending[(fecPendingHead+fecPendingCount) % NRF24_FEC_PENDING], packet, 32);
+			fecPendingCount++;
+		}
+	}
+
+	if(fecRxActive==1 && fecRxM>0)
+	{
+		for(i=0;i<fecRxK+fecRxM;i++)
+			symbols[i] = fecSymbols[i];
+		fecStats.recovered += rsDecode(fecRxK, fecRxM, symbols, &fecPresent, FEC_SYMBOL);
+	}
+}
+
+/**
+  * @brief  Reads the next data packet of current block that is received or rebuilt.
+  *
+  * @param	data: Array to store the packet, at least 27 byte.
+  * @retval Size of packet, 0 if there is nothing new.
+  */
+unsigned char fecRead(char *data)
+{
+	unsigned char i;
+	unsigned char size;
+
+	if(fecRxActive==0)
+		return 0;
+
+	while(fecReadIndex<fecRxK)
+	{
+		i = fecReadIndex;
+		if((fecPresent & (1<<i))==0)
+		{
+			if(fecDecodable()==1)
+				return 0; //it can still be rebuilt, the next ones wait for it
+			fecReadIndex++; //lost, counted by fecEndBlock()
+			continue;
+		}
+		fecReadIndex++;
+		if(fecPadding & (1<<i))
+			continue;
+		size = fecSymbols[i][0];
+		if(size==0 || size>NRF24_FEC_MAX_DATA) //corrupted symbol
+		{
+			fecStats.discarded++;
+			continue;
+		}
+		memcpy(data, &fecSymbols[i][1], size);
+		return size;
+	}
+	return 0;
+}
+
+/**
+  * @brief  Reads FEC counters.
+  *
+  * @param	stats: Stores the counters.
+  * @retval NONE.
+  */
+void fecGetStats(NRF24_FecStats *stats)
+{
+	*stats = fecStats;
+}
+
+/**
+  * @brief  Queues parity packets of current block and starts the next block, TX queue has room for them.
+  *
+  * @param	used: Number of data packets of the block, less than k for a short block.
+  * @retval NONE.
+  */
+void fecSendParity(unsigned char used)
+{
+	char packet[32];
+	unsigned char row;
+
+	for(row=0;row<fecM;row++)
+	{
+		packet[0] = FEC_MAGIC;
+		packet[1] = fecTxBlock;
+		packet[2] = (used<<4) | (fecK+row);
+		packet[3] = (fecK<<4) | fecM;
+		memcpy(&packet[FEC_HEADER], fecParity[row], FEC_SYMBOL);
+		txEnqueueNoAck(packet, 32);
+	}
+
+	memset(fecParity, 0, sizeof(fecParity));
+	fecTxBlock++;
+	fecTxIndex = 0;
+	fecStats.blocks++;
+}
+
+/**
+  * @brief  Stores a received packet in current block, or starts a new block.
+  *
+  * @param	packet: Received packet, 32 bytes.
+  * @retval 1: packet is taken or dropped, 0: it is of a newer block and has to wait till fecRead() has read current block.
+  */
+bool fecAccept(char *packet)
+{
+	unsigned char block = packet[1];
+	unsigned char index = packet[2] & 0x0F;
+	unsigned char used = (unsigned char)packet[2] >> 4;
+	unsigned char k = (unsigned char)packet[3] >> 4;
+	unsigned char m = packet[3] & 0x0F;
+	unsigned char i;
+
+	if(k==0 || k>NRF24_FEC_MAX_K || m>NRF24_FEC_MAX_M || index>=k+m)
+		return 1;
+
+	if(fecRxActive==0 || block!=fecRxBlock)
+	{
+		if(fecRxActive==1 && (unsigned char)(block-fecRxBlock)>=128) //packet of an old block
+			return 1;
+		if(fecRxActive==1 && fecUnread()==1) //symbols of current block are read in order first
+		{
+			fecRxClosed = 1;
+			return 0;
+		}
+		fecEndBlock();
+		fecRxActive = 1;
+		fecRxBlock = block;
+		fecRxK = k;
+		fecRxM = m;
+		fecPresent = 0;
+		fecPadding = 0;
+		fecReadIndex = 0;
+		fecRxHighest = index;
+		fecRxClosed = 0;
+		fecStats.blocks++;
+	}
+	else if(k!=fecRxK || m!=fecRxM)
+	{
+		return 1; //sender has changed block size in the middle of a block
+	}
+
+	memcpy(fecSymbols[index], &packet[FEC_HEADER], FEC_SYMBOL);
+	fecPresent |= 1<<index;
+	if(index>fecRxHighest)
+		fecRxHighest = index;
+
+	if(index>=k && used>0 && used<k) //short block, the rest of data symbols are zero and not sent
+	{
+		for(i=used;i<k;i++)
+		{
+			memset(fecSymbols[i], 0, FEC_SYMBOL);
+			fecPresent |= 1<<i;
+			fecPadding |= 1<<i;
+		}
+	}
+	return 1;
+}
+
+/**
+  * @brief  Counts data packets of current block that were never received or rebuilt, and the ones
+  *         that are there but not read (fecInit() in the middle of a block).
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void fecEndBlock()
+{
+	unsigned char i;
+
+	if(fecRxActive==0)
+		return;
+	for(i=0;i<fecRxK;i++)
+	{
+		if((fecPresent & (1<<i))==0)
+			fecStats.lost++;
+		else if(i>=fecReadIndex && (fecPadding & (1<<i))==0)
+			fecStats.discarded++;
+	}
+}
+
+/**
+  * @brief  Tells if current block can still be rebuilt: received symbols plus the ones that are not
+  *         sent yet (packets come in order of index) are at least k.
+  *
+  * @param	NONE.
+  * @retval 1: missing data symbols may still be rebuilt, 0: they are lost.
+  */
+bool fecDecodable()
+{
+	unsigned char i;
+	unsigned char count = fecRxK+fecRxM-1 - fecRxHighest; //not sent yet
+
+	if(fecRxClosed==1)
+		return 0;
+	for(i=0;i<fecRxK+fecRxM;i++)
+	{
+		if(fecPresent & (1<<i))
+			count++;
+	}
+	return count>=fecRxK;
+}
+
+/**
+  * @brief  Tells if current block has data symbols that fecRead() has not given yet.
+  *
+  * @param	NONE.
+  * @retval 1: fecRead() has more to give, 0: block is read.
+  */
+bool fecUnread()
+{
+	unsigned char i;
+
+	for(i=fecReadIndex;i<fecRxK;i++)
+	{
+		if((fecPresent & (1<<i)) && (fecPadding & (1<<i))==0)
+			return 1;
+	}
+	return 0;
+}
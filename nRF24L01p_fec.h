@@ -0,0 +1,76 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_fec.h
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Header file of cross packet FEC for broadcasts over nrf24L01p.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NRF24L01P_FEC_H
+#define __NRF24L01P_FEC_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p.h>
+#include <nRF24L01p_rs.h>
+
+#ifndef NRF24_FEC_MAX_K
+#define NRF24_FEC_MAX_K 8 //largest block of data packets (28 byte RAM each on receiver)
+#endif
+
+#ifndef NRF24_FEC_MAX_M
+#define NRF24_FEC_MAX_M 2 //largest number of parity packets per block (28 byte RAM each on both sides)
+#endif
+
+#ifndef NRF24_FEC_PENDING
+#define NRF24_FEC_PENDING 3 //packets of next block kept while current block is read (32 byte RAM each on receiver)
+#endif
+
+#define NRF24_FEC_MAX_DATA 27 //bytes of user data in a packet
+
+/* Exported types ------------------------------------------------------------*/
+
+/** 
+  * @brief	FEC Counters. Since fecInit().
+  */
+typedef struct {
+    unsigned int blocks; //blocks sent or seen by receiver
+    unsigned int recovered; //data packets rebuilt from parity
+    unsigned int lost; //data packets that could not be rebuilt
+    unsigned int discarded; //data packets received or rebuilt but not given to fecRead(): corrupted length, or block ended before they were read
+} NRF24_FecStats;
+
+/* Exported functions --------------------------------------------------------*/
+
+/* FEC functions *************************************************************/
+bool fecInit(unsigned char k, unsigned char m);
+bool fecSend(char *data, unsigned char size);
+bool fecFlush();
+void fecService();
+unsigned char fecRead(char *data);
+void fecGetStats(NRF24_FecStats *stats);
+
+#endif
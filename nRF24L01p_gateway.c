@@ -0,0 +1,387 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_gateway.c
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Multi-threaded Linux gateway over nrf24L01p spidev backend.
+  *    
+  *         This file provides functions to manage the following 
+  *         functionalities of a Linux collector with several radios
+  *           + Gateway functions
+  @verbatim     
+  ==============================================================================      
+                        ##### How to use this driver #####
+  ============================================================================== 
+  [..]
+   (#) Open and configure each radio as receiver by nRF24L01p_spidev.c and
+	   give it to gwAddRadio().
+
+   (#) Fill NRF24_GwConfig: number of workers, batch size, CPU of each
+	   thread and the handler that decodes and forwards a packet. Then
+	   gwInit() and gwStart(). The handler is called from worker threads,
+	   handlers of different workers run at the same time.
+
+   (#) gwStop() stops every thread, gwGetStats() counts packets of each
+	   radio and worker.
+
+     *** Pipeline ***    
+     =================================== 
+    [..]
+	  (+) One I/O thread per radio only waits for IRQ and reads RX FIFO,
+	      nothing is allocated per packet.
+	  (+) Each radio has one single producer single consumer ring to each
+	      worker, so neither side takes a lock. Head and tail are on their
+	      own cache lines and are published once per batch, or at once when
+	      RX FIFO is empty so a slow radio does not delay its packets.
+	  (+) Packets of a radio and pipe go to the same worker and keep their
+	      order, or with spread set, batches go round robin to all workers.
+	  (+) Workers take up to one batch from each of their rings in turn and
+	      sleep NRF24_GW_IDLE_SLEEP us when all are empty.
+	  (+) When a ring is full the packet is dropped and counted, RX FIFO of
+	      the radio has to be read anyway.
+  
+  @endverbatim
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#define _GNU_SOURCE //pthread_setaffinity_np
+#include <nRF24L01p.h>
+#include <nRF24L01p_spidev.h>
+#include <nRF24L01p_gateway.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+
+/* Private function prototypes -----------------------------------------------*/
+void *gwIoThread(void *arg);
+void *gwWorkerThread(void *arg);
+void gwSetCpu(pthread_t thread, int cpu);
+unsigned long long gwNanoseconds();
+
+/** @defgroup nrf24L01p_gateway Gateway functions
+ *  @brief   Gateway functions
+ *
+@verbatim
+ ===============================================================================
+						##### Gateway functions  #####
+ ===============================================================================
+    [..]
+    Producer writes slots then publishes head with release order, consumer
+    reads head with acquire order, handles slots and publishes tail with
+    release order. Indexes run freely, slot is index & (NRF24_GW_RING_SIZE-1).
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Resets the gateway and copies its configuration.
+  *
+  * @param	gw: Gateway.
+  * @param	config: Configuration, workers and batch are limited to valid values.
+  * @retval NONE.
+  */
+void gwInit(NRF24_Gateway *gw, NRF24_GwConfig *config)
+{
+	memset(gw, 0, sizeof(NRF24_Gateway));
+	gw->config = *config;
+	if(gw->config.workers==0)
+		gw->config.workers = 1;
+	if(gw->config.workers>NRF24_GW_MAX_WORKERS)
+		gw->config.workers = NRF24_GW_MAX_WORKERS;
+	if(gw->config.batch==0)
+		gw->config.batch = 1;
+	if(gw->config.batch>NRF24_GW_RING_SIZE)
+		gw->config.batch = NRF24_GW_RING_SIZE;
+}
+
+/**
+  * @brief  Adds a configured receiver to the gateway, before gwStart().
+  *
+  * @param	gw: Gateway.
+  * @param	radio: Radio of nRF24L01p_spidev.c, configured as receiver.
+  * @retval Index of the radio in packets, -1 if there are NRF24_GW_MAX_RADIOS radios already.
+  */
+int gwAddRadio(NRF24_Gateway *gw, NRF24_Spidev *radio)
+{
+	if(gw->radios==NRF24_GW_MAX_RADIOS || gw->running==1)
+		return -1;
+	gw->radio[gw->radios] = radio;
+	return gw->radios++;
+}
+
+/**
+  * @brief  Allocates rings and starts one I/O thread per radio and the workers.
+  *
+  * @param	gw: Gateway.
+  * @retval 1: started, 0: memory or threads could not be made.
+  */
+bool gwStart(NRF24_Gateway *gw)
+{
+	unsigned char i;
+
+	gw->ring = calloc(NRF24_GW_MAX_RADIOS*NRF24_GW_MAX_WORKERS, sizeof(NRF24_GwRing)); //the only allocation
+	if(gw->ring==NULL)
+		return 0;
+	gw->running = 1;
+	gw->ioStopped = 0; //set by a gwStop() before
+	gw->ioThreads = 0;
+	gw->workerThreads = 0;
+
+	for(i=0;i<gw->config.workers;i++)
+	{
+		gw->workerArg[i].gw = gw;
+		gw->workerArg[i].index = i;
+		if(pthread_create(&gw->workerThread[i], NULL, gwWorkerThread, &gw->workerArg[i])!=0)
+		{
+			gwStop(gw); //only started threads are joined
+			return 0;
+		}
+		gw->workerThreads++;
+		gwSetCpu(gw->workerThread[i], gw->config.workerCpu[i]);
+	}
+
+	for(i=0;i<gw->radios;i++)
+	{
+		gw->ioArg[i].gw = gw;
+		gw->ioArg[i].index = i;
+		if(pthread_create(&gw->ioThread[i], NULL, gwIoThread, &gw->ioArg[i])!=0)
+		{
+			gwStop(gw);
+			return 0;
+		}
+		gw->ioThreads++;
+		gwSetCpu(gw->ioThread[i], gw->config.radioCpu[i]);
+	}
+	return 1;
+}
+
+/**
+  * @brief  Stops every thread, packets left in rings are handled first. Radios are not closed.
+  *
+  * @param	gw: Gateway.
+  * @retval NONE.
+  */
+void gwStop(NRF24_Gateway *gw)
+{
+	unsigned char i;
+
+	if(gw->ring==NULL)
+		return;
+
+	__atomic_store_n(&gw->running, 0, __ATOMIC_RELEASE);
+	for(i=0;i<gw->ioThreads;i++)
+		pthread_join(gw->ioThread[i], NULL); //I/O threads wait for IRQ 10ms at most
+	__atomic_store_n(&gw->ioStopped, 1, __ATOMIC_RELEASE);
+	for(i=0;i<gw->workerThreads;i++)
+		pthread_join(gw->workerThread[i], NULL);
+	gw->ioThreads = 0;
+	gw->workerThreads = 0;
+
+	free(gw->ring);
+	gw->ring = NULL;
+}
+
+/**
+  * @brief  Copies counters of the gateway.
+  *
+  * @param	gw: Gateway.
+  * @param	stats: Stores the counters.
+  * @retval NONE.
+  */
+void gwGetStats(NRF24_Gateway *gw, NRF24_GwStats *stats)
+{
+	unsigned char i;
+
+	memset(stats, 0, sizeof(NRF24_GwStats));
+	for(i=0;i<NRF24_GW_MAX_RADIOS;i++)
+	{
+		stats->received[i] = __atomic_load_n(&gw->stats.received[i], __ATOMIC_RELAXED);
+		stats->dropped[i] = __atomic_load_n(&gw->stats.dropped[i], __ATOMIC_RELAXED);
+	}
+	for(i=0;i<NRF24_GW_MAX_WORKERS;i++)
+		stats->handled[i] = __atomic_load_n(&gw->stats.handled[i], __ATOMIC_RELAXED);
+}
+
+/**
+  * @brief  I/O thread of a radio: waits for IRQ, reads RX FIFO into rings of workers.
+  *
+  * @param	arg: NRF24_GwThread of the radio.
+  * @retval NULL.
+  */
+void *gwIoThread(void *arg)
+{
+	NRF24_Gateway *gw = ((NRF24_GwThread*)arg)->gw;
+	unsigned char index = ((NRF24_GwThread*)arg)->index;
+	NRF24_Spidev *radio = gw->radio[index];
+	NRF24_GwRing *rings = &gw->ring[index*NRF24_GW_MAX_WORKERS];
+	unsigned int head[NRF24_GW_MAX_WORKERS] = {0}; //next slot of each ring, published after a batch
+	unsigned int unpublished = 0;
+	unsigned long received = 0; //counters are published with the batch, I/O threads do not share cache lines per packet
+	unsigned long dropped = 0;
+	unsigned char next = 0; //worker of next batch in spread mode
+	unsigned char worker;
+	unsigned char w;
+	NRF24_GwPacket packet;
+
+	while(__atomic_load_n(&gw->running, __ATOMIC_ACQUIRE))
+	{
+		if(spidevRxPending(radio)==0 && spidevWaitIrq(radio, 10)==0)
+			continue;
+
+		packet.length = spidevReceive(radio, packet.data, &packet.pipe);
+		if(packet.length==0)
+			continue;
+		packet.time = gwNanoseconds();
+		packet.radio = index;
+		received++;
+
+		if(gw->config.spread==1)
+			worker = next;
+		else
+			worker = (index+packet.pipe) % gw->config.workers; //packets of a radio and pipe stay in order
+		if(head[worker]-__atomic_load_n(&rings[worker].tail, __ATOMIC_ACQUIRE) >= NRF24_GW_RING_SIZE)
+		{
+			dropped++; //worker is behind
+			__atomic_store_n(&gw->stats.dropped[index], dropped, __ATOMIC_RELAXED);
+			if(unpublished>0) //ring may be full of packets the worker cannot see yet
+			{
+				for(w=0;w<gw->config.workers;w++)
+					__atomic_store_n(&rings[w].head, head[w], __ATOMIC_RELEASE);
+				__atomic_store_n(&gw->stats.received[index], received, __ATOMIC_RELAXED);
+				unpublished = 0;
+				next = (next+1) % gw->config.workers;
+			}
+			continue;
+		}
+		rings[worker].slot[head[worker] & (NRF24_GW_RING_SIZE-1)] = packet;
+		head[worker]++;
+		unpublished++;
+
+		if(unpublished>=gw->config.batch || spidevRxPending(radio)==0) //nothing waits in RX FIFO, do not keep packets back
+		{
+			for(w=0;w<gw->config.workers;w++)
+				__atomic_store_n(&rings[w].head, head[w], __ATOMIC_RELEASE);
+			__atomic_store_n(&gw->stats.received[index], received, __ATOMIC_RELAXED);
+			unpublished = 0;
+			next = (next+1) % gw->config.workers;
+		}
+	}
+
+	for(w=0;w<gw->config.workers;w++)
+		__atomic_store_n(&rings[w].head, head[w], __ATOMIC_RELEASE);
+	__atomic_store_n(&gw->stats.received[index], received, __ATOMIC_RELAXED);
+	return NULL;
+}
+
+/**
+  * @brief  Worker thread: takes batches from its ring of each radio and calls handler.
+  *
+  * @param	arg: NRF24_GwThread of the worker.
+  * @retval NULL.
+  */
+void *gwWorkerThread(void *arg)
+{
+	NRF24_Gateway *gw = ((NRF24_GwThread*)arg)->gw;
+	unsigned char index = ((NRF24_GwThread*)arg)->index;
+	NRF24_GwRing *ring;
+	unsigned int head;
+	unsigned int tail;
+	unsigned int taken;
+	unsigned long handled;
+	unsigned long total = 0;
+	unsigned char r;
+	bool stopping = 0;
+	struct timespec idle;
+
+	idle.tv_sec = 0;
+	idle.tv_nsec = NRF24_GW_IDLE_SLEEP*1000L;
+
+	while(1)
+	{
+		handled = 0;
+		for(r=0;r<gw->radios;r++)
+		{
+			ring = &gw->ring[r*NRF24_GW_MAX_WORKERS+index];
+			tail = ring->tail;
+			head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+			for(taken=0;tail!=head && taken<gw->config.batch;taken++)
+			{
+				gw->config.handler(&ring->slot[tail & (NRF24_GW_RING_SIZE-1)], gw->config.context);
+				tail++;
+			}
+			if(taken>0)
+				__atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+			handled += taken;
+		}
+		total += handled;
+		__atomic_store_n(&gw->stats.handled[index], total, __ATOMIC_RELAXED);
+
+		if(handled==0)
+		{
+			if(stopping==1)
+				break; //I/O threads are stopped and every ring is empty
+			stopping = __atomic_load_n(&gw->ioStopped, __ATOMIC_ACQUIRE); //one more pass takes last packets
+			if(stopping==0)
+				nanosleep(&idle, NULL);
+		}
+	}
+	return NULL;
+}
+
+/**
+  * @brief  Binds a thread to a CPU.
+  *
+  * @param	thread: Thread.
+  * @param	cpu: CPU number, -1 leaves the thread on any CPU.
+  * @retval NONE.
+  */
+void gwSetCpu(pthread_t thread, int cpu)
+{
+	cpu_set_t set;
+
+	if(cpu<0)
+		return;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	pthread_setaffinity_np(thread, sizeof(set), &set);
+}
+
+/**
+  * @brief  Monotonic time.
+  *
+  * @param	NONE.
+  * @retval ns.
+  */
+unsigned long long gwNanoseconds()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long)now.tv_sec*1000000000ULL + now.tv_nsec;
+}
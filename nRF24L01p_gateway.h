@@ -0,0 +1,150 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_gateway.h
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Header file of multi-threaded Linux gateway over nrf24L01p spidev backend.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NRF24L01P_GATEWAY_H
+#define __NRF24L01P_GATEWAY_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p.h>
+#include <nRF24L01p_spidev.h>
+#include <pthread.h>
+
+#ifndef NRF24_GW_MAX_RADIOS
+#define NRF24_GW_MAX_RADIOS 8
+#endif
+
+#ifndef NRF24_GW_MAX_WORKERS
+#define NRF24_GW_MAX_WORKERS 8
+#endif
+
+#ifndef NRF24_GW_RING_SIZE
+#define NRF24_GW_RING_SIZE 256 //packets in each radio to worker ring, power of 2
+#endif
+
+#if (NRF24_GW_RING_SIZE & (NRF24_GW_RING_SIZE-1))!=0
+#error "NRF24_GW_RING_SIZE has to be a power of 2"
+#endif
+
+#ifndef NRF24_GW_IDLE_SLEEP
+#define NRF24_GW_IDLE_SLEEP 50 //us a worker sleeps when every ring is empty
+#endif
+
+#define NRF24_GW_CACHE_LINE 64
+
+/* Exported types ------------------------------------------------------------*/
+
+/** 
+  * @brief	Gateway Packet. A received packet with the radio it is heard on.
+  */
+typedef struct {
+    unsigned long long time; //ns, CLOCK_MONOTONIC when it is read from RX FIFO
+    unsigned char radio; //index returned by gwAddRadio()
+    unsigned char pipe;
+    unsigned char length;
+    char data[32];
+} NRF24_GwPacket;
+
+/** 
+  * @brief	Packet Handler. Decodes and forwards a packet, called from worker threads.
+  */
+typedef void (*NRF24_GwHandler)(NRF24_GwPacket *packet, void *context);
+
+/** 
+  * @brief	Gateway Configuration.
+  */
+typedef struct {
+    unsigned char workers; //worker threads, 1 to NRF24_GW_MAX_WORKERS
+    unsigned int batch; //packets an I/O thread publishes together and a worker takes from a ring at once
+    bool spread; //0: packets of a radio and pipe always go to the same worker, in order. 1: batches go round robin to workers
+    int radioCpu[NRF24_GW_MAX_RADIOS]; //CPU of each I/O thread, -1: any
+    int workerCpu[NRF24_GW_MAX_WORKERS]; //CPU of each worker, -1: any
+    NRF24_GwHandler handler;
+    void *context; //given to handler
+} NRF24_GwConfig;
+
+/** 
+  * @brief	SPSC Ring. Single producer (I/O thread) single consumer (worker) queue without locks.
+  */
+typedef struct {
+    unsigned int head; //written by producer only
+    char padHead[NRF24_GW_CACHE_LINE-sizeof(unsigned int)];
+    unsigned int tail; //written by consumer only
+    char padTail[NRF24_GW_CACHE_LINE-sizeof(unsigned int)];
+    NRF24_GwPacket slot[NRF24_GW_RING_SIZE];
+} NRF24_GwRing;
+
+/** 
+  * @brief	Gateway Counters.
+  */
+typedef struct {
+    unsigned long received[NRF24_GW_MAX_RADIOS]; //packets read by I/O thread of each radio
+    unsigned long dropped[NRF24_GW_MAX_RADIOS]; //packets read while the ring of their worker was full
+    unsigned long handled[NRF24_GW_MAX_WORKERS]; //packets given to handler by each worker
+} NRF24_GwStats;
+
+/** 
+  * @brief	Thread Argument. Gateway and index of the radio or worker of a thread.
+  */
+typedef struct {
+    struct NRF24_GatewayStruct *gw;
+    unsigned char index;
+} NRF24_GwThread;
+
+/** 
+  * @brief	Gateway.
+  */
+typedef struct NRF24_GatewayStruct {
+    NRF24_GwConfig config;
+    unsigned char radios;
+    NRF24_Spidev *radio[NRF24_GW_MAX_RADIOS];
+    NRF24_GwRing *ring; //radios x workers rings, ring[radio*NRF24_GW_MAX_WORKERS+worker]
+    pthread_t ioThread[NRF24_GW_MAX_RADIOS];
+    pthread_t workerThread[NRF24_GW_MAX_WORKERS];
+    NRF24_GwThread ioArg[NRF24_GW_MAX_RADIOS];
+    NRF24_GwThread workerArg[NRF24_GW_MAX_WORKERS];
+    unsigned char ioThreads; //started threads, gwStop() joins only these
+    unsigned char workerThreads;
+    volatile bool running; //I/O threads run
+    volatile bool ioStopped; //I/O threads are stopped, workers stop when rings are empty
+    NRF24_GwStats stats;
+} NRF24_Gateway;
+
+/* Exported functions --------------------------------------------------------*/
+
+/* Gateway functions *********************************************************/
+void gwInit(NRF24_Gateway *gw, NRF24_GwConfig *config);
+int gwAddRadio(NRF24_Gateway *gw, NRF24_Spidev *radio);
+bool gwStart(NRF24_Gateway *gw);
+void gwStop(NRF24_Gateway *gw);
+void gwGetStats(NRF24_Gateway *gw, NRF24_GwStats *stats);
+
+#endif
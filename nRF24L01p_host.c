@@ -0,0 +1,344 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_host.c
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   ATmega88 pins, SPI and delays of one simulated node.
+  *    
+  *         This file provides functions to run nRF24L01p.c on nRF24L01p_sim.c
+  *           + Host functions
+  @verbatim     
+  ==============================================================================      
+                        ##### How to use this driver #####
+  ============================================================================== 
+  [..]
+   (#) nRF24L01p_host.sh builds this file into every copy of the driver,
+	   so each node has its own pins, SREG and PCMSK0. The program of a node
+	   is hostMain(), it calls setTimestampSource(hostMicros) where
+	   TestAtmega88.c starts its Timer1 clock.
+
+   (#) #asm("cli") and #asm("sei") of CodeVision are turned into hostCli()
+	   and hostSei(), interrupt [PC_INT0] is dropped and pin_change_isr0()
+	   is called from here like the pin change interrupt of IRQ would be.
+  
+  @endverbatim
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p_host.h>
+
+/* Private define ------------------------------------------------------------*/
+#define R_RX_PAYLOAD 0x61
+#define R_RX_PL_WID 0x60
+#define NOP 0xFF
+
+/* Private variables ---------------------------------------------------------*/
+unsigned char SREG = 0x00; //interrupts are disabled after reset
+NRF24_SimNode *hostNode;
+
+unsigned char hostCe = 0; //pins as written by the program
+unsigned char hostCsn = 1;
+unsigned char hostCeSeen = 0; //pins as last given to the chip
+unsigned char hostCsnSeen = 1;
+unsigned char hostPcmsk = 0x00; //PCMSK0
+unsigned char hostPcifWrite = 0x00; //PCIFR as written by the program, its ones clear flags
+unsigned char hostPcif = 0x00; //PCIFR flags
+bool hostIrqLow = 0; //IRQ at last check of pin change
+
+bool hostFrame = 0; //SPI frame is open
+bool hostRead = 0; //instruction of the frame shifts data out
+unsigned char hostBytes[33]; //bytes sent in the frame
+unsigned char hostLength = 0;
+unsigned char hostAnswer[32]; //bytes shifted out after STATUS
+unsigned char hostStatus;
+
+/* Private function prototypes -----------------------------------------------*/
+void hostPins();
+void hostAdvance(double us);
+void hostWait(double us);
+double hostInterrupt();
+
+/** @defgroup nrf24L01p_host Host functions
+ *  @brief   Host functions
+ *
+@verbatim
+ ===============================================================================
+						##### Host functions  #####
+ ===============================================================================
+    [..]
+    Every call moves time of the node, the chip sees writes of CE and CSN
+    at the next call. The pin change interrupt is taken where an AVR could
+    take it: in delays, clock reads and IRQ reads outside of an SPI frame.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  CE pin, used by the CE macro.
+  *
+  * @param	NONE.
+  * @retval Pin to read or write.
+  */
+unsigned char *hostCePin()
+{
+	hostPins();
+	return &hostCe;
+}
+
+/**
+  * @brief  CSN pin, used by the CSN macro.
+  *
+  * @param	NONE.
+  * @retval Pin to read or write.
+  */
+unsigned char *hostCsnPin()
+{
+	hostPins();
+	return &hostCsn;
+}
+
+/**
+  * @brief  Reads IRQ pin, used by the IRQ macro.
+  *
+  * @param	NONE.
+  * @retval 0: an unmasked flag is set, 1: no flag.
+  */
+unsigned char hostIrq()
+{
+	hostWait(NRF24_SIM_PIN);
+	return simIrq(hostNode) ? 0 : 1;
+}
+
+/**
+  * @brief  PCMSK0 register, used by the PCMSK0 macro.
+  *
+  * @param	NONE.
+  * @retval Register to read or write.
+  */
+unsigned char *hostPcmsk0()
+{
+	hostPins();
+	return &hostPcmsk;
+}
+
+/**
+  * @brief  PCIFR register, used by the PCIFR macro. Ones written to it clear flags at the next call.
+  *
+  * @param	NONE.
+  * @retval Register to write.
+  */
+unsigned char *hostPcifr()
+{
+	hostPins();
+	hostPcifWrite = 0;
+	return &hostPcifWrite;
+}
+
+/**
+  * @brief  Sends a byte on SPI and returns the byte shifted in, like spi() of CodeVision.
+  *
+  * @param	data: Byte to send.
+  * @retval Byte from the chip.
+  */
+unsigned char spi(unsigned char data)
+{
+	hostPins();
+	hostAdvance(NRF24_SIM_SPI_BYTE);
+	if(hostFrame==0) //first byte after CSN low is the instruction
+	{
+		hostFrame = 1;
+		hostLength = 0;
+		hostRead = (data<0x20 || data==R_RX_PAYLOAD || data==R_RX_PL_WID);
+		hostStatus = simSpiRead(hostNode, hostRead ? data : NOP, hostAnswer);
+		hostBytes[hostLength++] = data;
+		return hostStatus;
+	}
+	if(hostLength<sizeof(hostBytes))
+		hostBytes[hostLength++] = data;
+	return hostRead ? hostAnswer[(hostLength-2)%32] : 0;
+}
+
+/**
+  * @brief  Busy waits, like delay_us() of CodeVision. Interrupts make it longer.
+  *
+  * @param	us: Time to wait.
+  * @retval NONE.
+  */
+void delay_us(unsigned int us)
+{
+	hostWait(us);
+}
+
+/**
+  * @brief  Busy waits, like delay_ms() of CodeVision. Interrupts make it longer.
+  *
+  * @param	ms: Time to wait.
+  * @retval NONE.
+  */
+void delay_ms(unsigned int ms)
+{
+	hostWait(ms*1000.0);
+}
+
+/**
+  * @brief  Disables interrupts, #asm("cli").
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void hostCli()
+{
+	SREG &= 0x7F;
+}
+
+/**
+  * @brief  Enables interrupts, #asm("sei"). A pending interrupt is taken at once.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void hostSei()
+{
+	SREG |= 0x80;
+	hostPins();
+	hostInterrupt();
+}
+
+/**
+  * @brief  Clock of the node in us, for setTimestampSource(). A read takes NRF24_SIM_POLL.
+  *
+  * @param	NONE.
+  * @retval Time in us.
+  */
+unsigned long hostMicros()
+{
+	hostWait(NRF24_SIM_POLL);
+	return (unsigned long)hostNode->now;
+}
+
+/**
+  * @brief  Entry of a copy of the program, nRF24L01p_host.sh renames it for each node.
+  *
+  * @param	node: Node of this copy.
+  * @retval NONE.
+  */
+void hostEntry(NRF24_SimNode *node)
+{
+	hostNode = node;
+	hostPcmsk = (1<<PCINT0); //pin change interrupt of IRQ, as set by TestAtmega88.c
+	hostMain(node->arg);
+}
+
+/**
+  * @}
+  */
+
+/*
+ * gives writes of CE and CSN to the chip, CSN high ends an SPI frame,
+ * then a change of IRQ sets PCIF0 if PCINT0 is enabled
+ */
+void hostPins()
+{
+	bool low;
+
+	if(hostCe!=hostCeSeen)
+	{
+		hostCeSeen = hostCe;
+		simSetCe(hostNode, hostCe!=0);
+	}
+	if(hostCsn!=hostCsnSeen)
+	{
+		hostCsnSeen = hostCsn;
+		if(hostCsn!=0 && hostFrame==1)
+		{
+			hostFrame = 0;
+			if(hostRead==0)
+				simSpiWrite(hostNode, hostBytes[0], &hostBytes[1], hostLength-1);
+		}
+	}
+	low = simIrq(hostNode);
+	if(low!=hostIrqLow)
+	{
+		hostIrqLow = low;
+		if(hostPcmsk & (1<<PCINT0))
+			hostPcif |= (1<<PCIF0);
+	}
+	hostPcif &= ~hostPcifWrite;
+	hostPcifWrite = 0;
+}
+
+/*
+ * time of the node moves on, without interrupts
+ */
+void hostAdvance(double us)
+{
+	double target = hostNode->now + us;
+
+	while(hostNode->now<target)
+		simStep(hostNode, target);
+}
+
+/*
+ * time of the node moves on, interrupts are taken and make it longer
+ */
+void hostWait(double us)
+{
+	double target;
+
+	hostPins();
+	target = hostNode->now + us;
+	while(1)
+	{
+		target += hostInterrupt();
+		if(hostNode->now>=target)
+			return;
+		simStep(hostNode, target);
+	}
+}
+
+/*
+ * pending pin change interrupt is taken if global interrupts are enabled, not inside an SPI frame
+ */
+double hostInterrupt()
+{
+	double start = hostNode->now;
+
+	if(hostFrame==1)
+		return 0;
+	hostPins();
+	if((hostPcif & (1<<PCIF0)) && (SREG & 0x80))
+	{
+		hostPcif &= ~(1<<PCIF0); //flag is cleared when the interrupt is taken
+		SREG &= 0x7F;
+		hostAdvance(NRF24_SIM_ISR);
+		pin_change_isr0();
+		hostPins();
+		SREG |= 0x80;
+	}
+	return hostNode->now - start;
+}
@@ -0,0 +1,71 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_host.h
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Header file of nRF24L01p_host.c module.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NRF24L01P_HOST_H
+#define __NRF24L01P_HOST_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p_sim.h>
+
+/* Hardware of TestAtmega88.c, nRF24L01p_host.sh puts this file in front of each source of a node */
+#define flash const
+#define CE (*hostCePin()) //a write is seen by the chip at the next SPI byte, delay or clock read
+#define CSN (*hostCsnPin())
+#define IRQ hostIrq()
+#define PCMSK0 (*hostPcmsk0())
+#define PCIFR (*hostPcifr()) //write 1 to clear, as on AVR
+#define PCINT0 0
+#define PCIF0 0
+
+extern unsigned char SREG; //only bit 7 (I) is used
+extern NRF24_SimNode *hostNode;
+
+/* Exported functions --------------------------------------------------------*/
+
+/* Host functions ************************************************************/
+unsigned char *hostCePin();
+unsigned char *hostCsnPin();
+unsigned char hostIrq();
+unsigned char *hostPcmsk0();
+unsigned char *hostPcifr();
+unsigned char spi(unsigned char data);
+void delay_us(unsigned int us);
+void delay_ms(unsigned int ms);
+void hostCli();
+void hostSei();
+unsigned long hostMicros();
+void hostEntry(NRF24_SimNode *node);
+
+void pin_change_isr0(void); //of nRF24L01p.c
+void hostMain(int arg); //program of the node, defined by the host program
+
+#endif
@@ -0,0 +1,100 @@
+#!/bin/sh
+# Builds nRF24L01p.c and modules for the host, with nRF24L01p_host.c in place of the ATmega88.
+#
+#   sh nRF24L01p_host.sh <program> <nodes> [module.c ...] [-Dname=value ...]
+#       builds ./<program> from <program>.c: its HOST_NODE part, the driver and
+#       the modules are copied once per node, the rest runs the nodes on
+#       nRF24L01p_sim.c.
+#   sh nRF24L01p_host.sh profiles
+#       compiles and links the driver in each build profile and prints its size
+#       (x86-64 code, for comparing profiles; AVR sizes are in the CodeVision report).
+#
+# CC, CFLAGS and HOST_BUILD (directory of objects, host-build by default) can be set.
+
+set -e
+SRC=$(cd "$(dirname "$0")" && pwd)
+OUT=${HOST_BUILD:-host-build}
+CC=${CC:-gcc}
+CFLAGS=${CFLAGS:--O2 -Wall -Wno-pointer-sign -Wno-unknown-pragmas -Wno-switch -Wno-unused-but-set-variable}
+mkdir -p "$OUT"
+
+# CodeVision syntax the host compiler does not know
+hostSource() {
+	sed -e 's/#asm("cli")/hostCli();/' -e 's/#asm("sei")/hostSei();/' \
+		-e 's/interrupt \[[A-Z_0-9]*\] //' \
+		-e '/#include <\(mega88a\|delay\|spi\|sleep\)\.h>/d' "$SRC/$1" > "$OUT/$1"
+}
+
+# compiles a source of a node
+hostCompile() {
+	$CC $CFLAGS $FLAGS -I"$SRC" -include "$SRC/nRF24L01p_host.h" -c "$1" -o "$2"
+}
+
+if [ "$1" = "profiles" ]; then
+	hostSource nRF24L01p.c
+	printf 'void hostMain(int arg){}\nint main(void){return 0;}\n' > "$OUT/profile_main.c"
+	printf '%-8s %8s %8s %8s\n' profile text data bss
+	for profile in full both tx rx; do
+		case $profile in
+			full) FLAGS="";;
+			both) FLAGS="-DNRF24_PROFILE";;
+			tx) FLAGS="-DNRF24_PROFILE -DNRF24_PROFILE_ROLES=1";;
+			rx) FLAGS="-DNRF24_PROFILE -DNRF24_PROFILE_ROLES=2";;
+		esac
+		hostCompile "$OUT/nRF24L01p.c" "$OUT/driver_$profile.o"
+		hostCompile "$SRC/nRF24L01p_host.c" "$OUT/host_$profile.o"
+		$CC $CFLAGS -I"$SRC" -o "$OUT/profile_$profile" "$OUT/profile_main.c" "$OUT/driver_$profile.o" \
+			"$OUT/host_$profile.o" "$SRC/nRF24L01p_sim.c"
+		size "$OUT/driver_$profile.o" | awk -v p=$profile 'NR==2 {printf "%-8s %8s %8s %8s\n", p, $1, $2, $3}'
+	done
+	exit 0
+fi
+
+if [ $# -lt 2 ]; then
+	echo "usage: sh nRF24L01p_host.sh <program> <nodes> [module.c ...] [-Dname=value ...] | profiles" >&2
+	exit 1
+fi
+PROGRAM=$1
+NODES=$2
+shift 2
+MODULES=""
+FLAGS=""
+for arg in "$@"; do
+	case $arg in
+		-*) FLAGS="$FLAGS $arg";;
+		*) MODULES="$MODULES $arg";;
+	esac
+done
+
+# one relocatable object holds a node: program, driver, modules and pins
+OBJECTS=""
+for source in nRF24L01p.c $MODULES; do
+	hostSource $source
+	hostCompile "$OUT/$source" "$OUT/${source%.c}.o"
+	OBJECTS="$OBJECTS $OUT/${source%.c}.o"
+done
+hostCompile "$SRC/nRF24L01p_host.c" "$OUT/nRF24L01p_host.o"
+$CC -DHOST_NODE $CFLAGS $FLAGS -I"$SRC" -include "$SRC/nRF24L01p_host.h" -c "$SRC/$PROGRAM.c" -o "$OUT/${PROGRAM}_node.o"
+ld -r -o "$OUT/node.o" $OBJECTS "$OUT/nRF24L01p_host.o" "$OUT/${PROGRAM}_node.o"
+
+# each copy keeps only its entry global, under its own name
+echo '#include <nRF24L01p_sim.h>' > "$OUT/nodes.c"
+TABLE=""
+i=0
+while [ $i -lt $NODES ]; do
+	objcopy -G hostEntry "$OUT/node.o" "$OUT/node_local.o"
+	objcopy --redefine-sym hostEntry=hostEntry$i "$OUT/node_local.o" "$OUT/node$i.o"
+	echo "void hostEntry$i(NRF24_SimNode *node);" >> "$OUT/nodes.c"
+	TABLE="$TABLE hostEntry$i,"
+	i=$((i+1))
+done
+echo "NRF24_SimEntry simEntries[] = {$TABLE};" >> "$OUT/nodes.c"
+echo "int simEntryCount = $NODES;" >> "$OUT/nodes.c"
+
+i=0
+COPIES=""
+while [ $i -lt $NODES ]; do
+	COPIES="$COPIES $OUT/node$i.o"
+	i=$((i+1))
+done
+$CC $CFLAGS $FLAGS -I"$SRC" -o "$PROGRAM" "$SRC/$PROGRAM.c" "$SRC/nRF24L01p_sim.c" "$OUT/nodes.c" $COPIES
@@ -0,0 +1,260 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_lpl.c
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Low power listening MAC over nrf24L01p driver.
+  *    
+  *         This file provides firmware functions to manage the following 
+  *         functionalities of duty cycled receivers
+  *           + LPL functions
+  @verbatim     
+  ==============================================================================      
+                        ##### How to use this driver #####
+  ============================================================================== 
+  [..]
+   (#) Initialize the module by nRF_Config(), then call lplInit() with the
+	   same mode. It enables auto acknowledge, a receiver goes to Power Down.
+
+   (#) In case of Receiver:
+	   Wake the MCU up every interval ms by its own timer (watchdog, timer 2
+	   in asynchronous mode) and call lplCheck(). nrf24 listens for window
+	   us, if a carrier or a packet is seen it stays in RX for hold ms, then
+	   goes back to Power Down. lplCheck() returns 1 when a packet is in the
+	   buffer of driver, read it by readRxFIFO().
+
+   (#) In case of Transmitter:
+	   lplSend() repeats the packet as wake-up preamble until it is
+	   acknowledged, or for one full interval. Receiver gets only one copy,
+	   repeats keep the same PID and are dropped by nrf24 of receiver.
+
+     *** Average current ***    
+     =================================== 
+    [..]
+	  A check costs 1.5ms of crystal start up (Standby-I current) and
+	  130us + window of RX current (13.5mA). With default 200ms interval and
+	  1ms window receiver is in RX for 0.6% of time, about 100 times less
+	  than continuous RX, at the price of up to 200ms latency and a sender
+	  that is busy for the whole interval in the worst case.
+  
+  @endverbatim
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <mega88a.h>
+#include <nRF24L01p.h>
+#include <nRF24L01p_lpl.h>
+#include <stdio.h>
+#include <delay.h>
+
+/* Private define ------------------------------------------------------------*/
+/* Instruction Memories */
+#define R_REGISTER 0x00
+#define W_TX_PAYLOAD 0xA0
+#define FLUSH_TX 0xE1
+
+/* Register Memories */
+#define CONFIG 0x00
+
+#define LPL_ATTEMPT_TIMEOUT 2000 //us, one try of a 32 byte packet at 250Kbps including 130us settling and ACK wait
+#define LPL_POLL_STEP 10 //us, IRQ pin is sampled with this step
+
+/* Private variables ---------------------------------------------------------*/
+NRF24_LplConfig lplConfig = {NRF24_LPL_INTERVAL, NRF24_LPL_WINDOW, NRF24_LPL_HOLD, 0, NRF24_LPL_UNTIL_ACK};
+Mode lplMode; //mode given to lplInit
+unsigned int lplAttempts = 0; //number of tries of last lplSend
+
+/** @defgroup nrf24L01p_lpl LPL functions
+ *  @brief   LPL functions
+ *
+@verbatim
+ ===============================================================================
+							##### LPL functions  #####
+ ===============================================================================
+    [..]
+    Receiver keeps nrf24 in Power Down and checks the channel on a schedule
+    of the application. Sender does not know when receiver listens, so every
+    packet is repeated back to back for at least one interval; auto
+    retransmit of nrf24 is disabled (ARC=0, ARD=250us) and each repeat is a
+    CE pulse on the payload that stays in TX FIFO after MAX_RT.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Prepares the module for low power listening, nRF_Config() must be called before.
+  *
+  * @param	mode: Mode of operation, Transmitter or Receiver.
+  * @retval NONE.
+  */
+void lplInit(Mode mode)
+{
+	lplMode = mode;
+	setAutoAck(1); //repeats stop when receiver acknowledges
+	setRetransmit(0, 0); //one try per CE pulse, wait 250us for ACK
+
+	if(mode==NRF24_RECEIVER)
+		setPowerState(NRF24_POWER_DOWN);
+}
+
+/**
+  * @brief  Changes interval, window, hold time and repeat policy.
+  *
+  * @param	config: New configuration.
+  * @retval NONE.
+  */
+void lplSetConfig(NRF24_LplConfig *config)
+{
+	lplConfig = *config;
+	if(lplConfig.window<LPL_POLL_STEP)
+		lplConfig.window = LPL_POLL_STEP;
+}
+
+/**
+  * @brief  Reads current configuration.
+  *
+  * @param	config: Stores current configuration.
+  * @retval NONE.
+  */
+void lplGetConfig(NRF24_LplConfig *config)
+{
+	*config = lplConfig;
+}
+
+/**
+  * @brief  Listens to the channel once, called by receiver every interval ms.
+  *
+  * @param	NONE.
+  * @retval 1: a packet is received and can be read by readRxFIFO(), 0: nothing is received.
+  */
+bool lplCheck()
+{
+	unsigned int elapsed;
+	bool carrier = 0;
+
+	if(bytesAvailable()>0) //last packet is not read, it would be dropped
+		return 1;
+
+	setPowerState(NRF24_RX_MODE); //crystal start up and RX settling
+	delay_us(40); //RPD is valid after 170us in RX mode
+
+	for(elapsed=0; elapsed<lplConfig.window; elapsed+=LPL_POLL_STEP)
+	{
+		if(bytesAvailable()>0 || getCarrierDetect()==1)
+		{
+			carrier = 1;
+			break;
+		}
+		delay_us(LPL_POLL_STEP);
+	}
+
+	if(carrier==1) //sender is repeating, wait for one complete copy
+	{
+		for(elapsed=0; elapsed<lplConfig.hold && bytesAvailable()==0; elapsed++)
+			delay_ms(1);
+	}
+
+	setPowerState(NRF24_POWER_DOWN);
+	return bytesAvailable()>0;
+}
+
+/**
+  * @brief  Sends a packet to a duty cycled receiver, repeats it until it is acknowledged or repeat time is over.
+  *         TX queue must be empty, IRQ is polled while the packet is repeated, then polled mode
+  *         and interrupt mask are restored.
+  *
+  * @param	data: data to be sent.
+  * @param	size: size of data, 1 to 32.
+  * @retval 1: packet is acknowledged, 0: no acknowledge in repeat time.
+  */
+bool lplSend(char *data, unsigned char size)
+{
+	unsigned long elapsed = 0; //us
+	unsigned long repeatTime;
+	unsigned int wait;
+	unsigned char status;
+	bool acked = 0;
+	bool polled;
+	char config[1];
+
+	lplAttempts = 0;
+	if(lplMode!=NRF24_TRANSMITTER || size==0 || size>32 || txQueueFree()<NRF24_TX_QUEUE_SIZE || txLaneFree(NRF24_LANE_HIGH)<NRF24_TX_HIGH_QUEUE_SIZE)
+		return 0;
+
+	repeatTime = lplConfig.repeatTime;
+	if(repeatTime==0)
+		repeatTime = lplConfig.interval + lplConfig.window/1000 + 1;
+	repeatTime *= 1000;
+
+	polled = getPolledMode();
+	writeCommand(R_REGISTER+CONFIG, config, 1); //interrupt mask of caller
+	setPolledMode(1); //flags are handled here, not by pin_change_isr0
+	setPowerState(NRF24_STANDBY_I);
+	setInterruptMask(0, 1, 1);
+	writeCommand(FLUSH_TX, NULL, 0);
+	writeCommand(W_TX_PAYLOAD, data, size); //stays in TX FIFO after MAX_RT, so every repeat is a CE pulse
+
+	while(elapsed<repeatTime)
+	{
+		CE = 1;
+		delay_us(15); //CE is 1 for more than 10us
+		CE = 0;
+		lplAttempts++;
+
+		for(wait=0; wait<LPL_ATTEMPT_TIMEOUT && IRQ==1; wait+=LPL_POLL_STEP)
+			delay_us(LPL_POLL_STEP);
+		elapsed += wait + 15;
+
+		status = getStatus();
+		clearInterruptFlag(0, 1, 1);
+		if(status & 0x20) //TX_DS, ACK is received and payload is removed from TX FIFO
+		{
+			acked = 1;
+			if(lplConfig.policy==NRF24_LPL_UNTIL_ACK)
+				break;
+			writeCommand(W_TX_PAYLOAD, data, size); //new PID, receivers still asleep get their own copy
+		}
+	}
+
+	writeCommand(FLUSH_TX, NULL, 0);
+	setInterruptMask((config[0]&0x40)==0, (config[0]&0x20)==0, (config[0]&0x10)==0);
+	if(polled==0)
+		setPolledMode(0); //clears the flags of the repeats first
+	return acked;
+}
+
+/**
+  * @brief  Number of tries of last lplSend(), shows how long sender has waited for receiver.
+  *
+  * @param	NONE.
+  * @retval Number of tries.
+  */
+unsigned int lplGetAttempts()
+{
+	return lplAttempts;
+}
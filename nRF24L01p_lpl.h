@@ -0,0 +1,80 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_lpl.h
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Header file of low power listening MAC over nrf24L01p.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NRF24L01P_LPL_H
+#define __NRF24L01P_LPL_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p.h>
+
+#ifndef NRF24_LPL_INTERVAL
+#define NRF24_LPL_INTERVAL 200 //ms, default time between two channel checks of receiver
+#endif
+
+#ifndef NRF24_LPL_WINDOW
+#define NRF24_LPL_WINDOW 1000 //us, default time receiver listens on each check, longer than one repeat of sender
+#endif
+
+#ifndef NRF24_LPL_HOLD
+#define NRF24_LPL_HOLD 5 //ms, default time receiver stays in RX after carrier is detected
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+
+/** 
+  * @brief	Repeat Policy. When sender stops repeating the wake-up packet.
+  *         FULL_INTERVAL wakes every receiver of the address, one of them may get the packet twice.
+  */
+typedef enum {NRF24_LPL_UNTIL_ACK, NRF24_LPL_FULL_INTERVAL} NRF24_LplPolicy;
+
+/** 
+  * @brief	LPL Configuration. Both sides of a link must use the same interval.
+  */
+typedef struct {
+    unsigned int interval; //ms between two channel checks of receiver
+    unsigned int window; //us receiver listens on each check
+    unsigned int hold; //ms receiver stays in RX after carrier is detected
+    unsigned int repeatTime; //ms sender repeats a packet, 0: interval plus window
+    NRF24_LplPolicy policy;
+} NRF24_LplConfig;
+
+/* Exported functions --------------------------------------------------------*/
+
+/* LPL functions *************************************************************/
+void lplInit(Mode mode);
+void lplSetConfig(NRF24_LplConfig *config);
+void lplGetConfig(NRF24_LplConfig *config);
+bool lplCheck();
+bool lplSend(char *data, unsigned char size);
+unsigned int lplGetAttempts();
+
+#endif
@@ -0,0 +1,483 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_net.c
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Tree network layer over nrf24L01p driver.
+  *    
+  *         This file provides firmware functions to manage the following 
+  *         functionalities of multi-hop networks
+  *           + Network functions
+  @verbatim     
+  ==============================================================================      
+                        ##### How to use this driver #####
+  ============================================================================== 
+  [..]
+   (#) Every node has a position in a tree: root is 0, child k (1 to 5) of
+	   a node at depth d is its address plus k<<(3*d), e.g. 021 (octal) is
+	   child 2 of child 1 of root. Up to 5 levels under root.
+
+   (#) Call nRF_Config(NRF24_RECEIVER) and then netInit() with the address
+	   of this node. Data pipe k listens to child k, data pipe 0 to the
+	   parent, auto ACK is enabled on all of them. Receiver is in polled
+	   mode, IRQ service routine only runs while the queue is sent.
+
+   (#) netSend() queues a frame to any node, netService() has to be called
+	   in main loop, at least once per 3 frames a node may receive: it
+	   forwards frames of other nodes and sends queued ones, the application
+	   only sees frames to this node by netRead(). Relays need nothing else.
+
+     *** Frame ***    
+     =================================== 
+    [..]
+	  | to:2 | from:2 | id | type | payload, up to 26 bytes |
+	  to and from are LSB first.
+
+     *** Radio addresses ***    
+     =================================== 
+    [..]
+	  | 0xE7 | 0x4E | node MSB | node LSB | pipe byte |
+	  Child k sends to pipe k of its parent, parent sends to pipe 0 of its
+	  child, so every link is a pipe of the receiver and no address is
+	  shared.
+  
+  @endverbatim
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p.h>
+#include <nRF24L01p_net.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define W_REGISTER 0x20
+#define EN_AA 0x01
+#define EN_RXADDR 0x02
+#define RX_ADDR_P1 0x0B
+#define DYNPD 0x1C
+
+#define NET_PREFIX0 0xE7 //MSB of every radio address of the network
+#define NET_PREFIX1 0x4E
+
+/* Private variables ---------------------------------------------------------*/
+flash unsigned char netPipeByte[6] = {0x3C, 0x5A, 0x69, 0x96, 0xA5, 0xC3}; //LSB of radio address of each pipe, no long runs of one bit
+
+/* Private function prototypes -----------------------------------------------*/
+bool netEnqueue(NRF24_NetNode *node, char *frame, unsigned char length);
+bool netDeliver(NRF24_NetNode *node, char *frame, unsigned char length);
+void netReceive(NRF24_NetNode *node, char *frame, unsigned char length);
+unsigned char netForward(NRF24_NetNode *node, char *frame, unsigned char length);
+void netComplete(NRF24_NetNode *node, NRF24_TxStatus status);
+
+/** @defgroup nrf24L01p_net Network functions
+ *  @brief   Network functions
+ *
+@verbatim
+ ===============================================================================
+						##### Network functions  #####
+ ===============================================================================
+    [..]
+    Routes are kept in a table of NRF24_NET_ROUTES entries in RAM of the
+    node: netInit() puts the subtree of each child and a default route to
+    the parent, netAddRoute() puts static routes in front of them. Frames are
+    stored in one queue and sent one by one with auto retransmit. Each call
+    of netService() puts at most one frame on air or checks the one on air,
+    it does not wait for the ACK. Receiver is off while the queue is sent,
+    senders retry until it is back.
+    Frames come back to back from up to 6 neighbours, the single packet
+    buffer of IRQ service routine would flush RX FIFO behind it after the
+    packets are acknowledged, so receiver reads up to 3 frames straight
+    from RX FIFO by pollReceive() on each netService().
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Starts the network layer, data pipes and routes of this node.
+  *         nrf24 has to be configured as receiver by nRF_Config().
+  *
+  * @param	node: State of this node.
+  * @param	address: Position in tree.
+  * @retval 1: started, 0: address is not a valid position.
+  */
+bool netInit(NRF24_NetNode *node, unsigned int address)
+{
+	char radio[5];
+	char data[1];
+	unsigned int rest = address;
+	unsigned char depth = 0;
+	unsigned char k;
+
+	while(rest!=0) //digits are 1 to 5 from LSB, then zeros
+	{
+		if((rest&0x07)==0 || (rest&0x07)>5 || depth>=NRF24_NET_MAX_DEPTH)
+			return 0;
+		rest >>= 3;
+		depth++;
+	}
+
+	memset(node, 0, sizeof(NRF24_NetNode));
+	node->address = address;
+	node->depth = depth;
+	setAddressWidth(NRF24_5Byte); //netPipeAddress() gives 5 bytes
+
+	//routes, children are in front of the default route
+	if(depth>0)
+		netAddRoute(node, 0, 0, NRF24_NET_PARENT);
+	for(k=1;k<=5 && depth<NRF24_NET_MAX_DEPTH;k++)
+		netAddRoute(node, address | ((unsigned int)k<<(3*depth)), (1U<<(3*(depth+1)))-1, k);
+
+	//pipe 0 hears the parent, pipe k child k
+	netPipeAddress(address, 0, radio);
+	setBaseAddress(radio);
+	netPipeAddress(address, 1, radio);
+	writeCommand(W_REGISTER+RX_ADDR_P1, radio, 5);
+	for(k=2;k<=5;k++)
+	{
+		netPipeAddress(address, k, radio);
+		writeCommand(W_REGISTER+RX_ADDR_P1+k-1, &radio[4], 1); //only LSB, rest is same as pipe 1
+	}
+	data[0] = 0x3F;
+	writeCommand(W_REGISTER+EN_RXADDR, data, 1);
+	writeCommand(W_REGISTER+DYNPD, data, 1);
+	setAutoAck(1);
+	writeCommand(W_REGISTER+EN_AA, data, 1);
+	//ARD of 500us to 1250us, ACK fits in 500us at every data rate. Neighbours
+	//wait differently, so two senders that collide once do not retry in step
+	k = (depth>0) ? address>>(3*(depth-1)) : 0; //this node is child k of its parent
+	setRetransmit(1+(k+depth)%4, 15);
+	setPolledMode(1); //RX FIFO is drained by netService()
+
+	//peer 0 is this node's pipe of the parent, peer k is pipe 0 of child k
+	if(depth>0)
+	{
+		netPipeAddress(address & ~(0x07U<<(3*(depth-1))), address>>(3*(depth-1)), radio);
+		setPeerAddress(NRF24_NET_PARENT, radio);
+	}
+	for(k=1;k<=5 && depth<NRF24_NET_MAX_DEPTH;k++)
+	{
+		netPipeAddress(address | ((unsigned int)k<<(3*depth)), 0, radio);
+		setPeerAddress(k, radio);
+	}
+	return 1;
+}
+
+/**
+  * @brief  Adds a static route in front of the others.
+  *
+  * @param	node: State of this node.
+  * @param	destination: A node, or first node of a subtree.
+  * @param	mask: Bits of destination that have to match, 0xFFFF for one node.
+  * @param	via: NRF24_NET_PARENT or child 1 to 5.
+  * @retval 1: route is added, 0: table is full or via is not valid.
+  */
+bool netAddRoute(NRF24_NetNode *node, unsigned int destination, unsigned int mask, unsigned char via)
+{
+	if(node->routeCount>=NRF24_NET_ROUTES || via>5)
+		return 0;
+
+	memmove(&node->routes[1], &node->routes[0], node->routeCount*sizeof(NRF24_NetRoute));
+	node->routes[0].node = destination & mask;
+	node->routes[0].mask = mask;
+	node->routes[0].via = via;
+	node->routeCount++;
+	return 1;
+}
+
+/**
+  * @brief  Finds the neighbour a frame is sent to.
+  *
+  * @param	node: State of this node.
+  * @param	destination: Node the frame is for.
+  * @retval NRF24_NET_PARENT, child 1 to 5, or NRF24_NET_NO_ROUTE.
+  */
+unsigned char netRoute(NRF24_NetNode *node, unsigned int destination)
+{
+	unsigned char i;
+
+	for(i=0;i<node->routeCount;i++)
+	{
+		if((destination & node->routes[i].mask)==node->routes[i].node)
+			return node->routes[i].via;
+	}
+	return NRF24_NET_NO_ROUTE;
+}
+
+/**
+  * @brief  Queues a frame to a node, it is sent by netService().
+  *
+  * @param	node: State of this node.
+  * @param	to: Destination node.
+  * @param	type: Defined by the application.
+  * @param	data: Payload.
+  * @param	size: Size of payload, 1 to NRF24_NET_MAX_PAYLOAD.
+  * @retval 1: frame is queued, 0: queue is full or size is not valid.
+  */
+bool netSend(NRF24_NetNode *node, unsigned int to, unsigned char type, char *data, unsigned char size)
+{
+	char frame[32];
+
+	if(size==0 || size>NRF24_NET_MAX_PAYLOAD)
+		return 0;
+
+	frame[0] = to;
+	frame[1] = to>>8;
+	frame[2] = node->address;
+	frame[3] = node->address>>8;
+	frame[4] = node->nextId++;
+	frame[5] = type;
+	memcpy(&frame[NRF24_NET_HEADER], data, size);
+	node->stats.sent++;
+
+	if(to==node->address)
+		return netDeliver(node, frame, NRF24_NET_HEADER+size);
+	return netEnqueue(node, frame, NRF24_NET_HEADER+size);
+}
+
+/**
+  * @brief  Takes received frames and sends queued ones. Has to be called in main loop.
+  *
+  * @param	node: State of this node.
+  * @retval 1: a frame to this node is waiting for netRead(), 0: inbox is empty.
+  */
+bool netService(NRF24_NetNode *node)
+{
+	char frame[32];
+	unsigned char length;
+	unsigned char i;
+	NRF24_TxStatus status;
+
+	if(node->sending==0) //receiver in polled mode
+	{
+		for(i=0;i<3;i++) //RX FIFO holds 3 packets
+		{
+			length = pollReceive(frame, NULL);
+			if(length==0)
+				break;
+			netReceive(node, frame, length);
+		}
+		if(i==3)
+			return node->inboxCount>0; //more may wait, they are read before receiver goes off
+	}
+	if((length=bytesAvailable())>0) //came in while switching role, IRQ service routine took it with first TX_DS
+	{
+		readRxFIFO(frame, length);
+		netReceive(node, frame, length);
+	}
+
+	if(node->ticket!=0) //frame at head of queue is on air
+	{
+		status = getTxStatus(node->ticket); //completed by IRQ service routine
+		if(status==NRF24_TX_PENDING)
+			return node->inboxCount>0;
+		netComplete(node, status);
+	}
+
+	while(node->queueCount>0 && node->ticket==0)
+	{
+		if(node->sending==0)
+		{
+			switchRole(NRF24_TRANSMITTER);
+			setPolledMode(0); //tickets are completed by IRQ service routine
+			node->sending = 1;
+		}
+		node->ticket = netForward(node, node->queue[node->queueHead], node->queueLength[node->queueHead]);
+		if(node->ticket==0) //no route or not queued, frame is dropped
+		{
+			node->queueHead = (node->queueHead+1) % NRF24_NET_QUEUE_SIZE;
+			node->queueCount--;
+		}
+	}
+	if(node->ticket==0 && node->sending==1)
+	{
+		setPolledMode(1);
+		switchRole(NRF24_RECEIVER);
+		node->sending = 0;
+	}
+
+	return node->inboxCount>0;
+}
+
+/**
+  * @brief  Reads the oldest frame to this node.
+  *
+  * @param	node: State of this node.
+  * @param	from: Stores the sender, can be NULL.
+  * @param	type: Stores the type, can be NULL.
+  * @param	data: Array to store the payload, at least NRF24_NET_MAX_PAYLOAD byte.
+  * @retval Size of payload, 0 if there is no frame.
+  */
+unsigned char netRead(NRF24_NetNode *node, unsigned int *from, unsigned char *type, char *data)
+{
+	char *frame = node->inbox[node->inboxHead];
+	unsigned char size;
+
+	if(node->inboxCount==0)
+		return 0;
+
+	size = node->inboxLength[node->inboxHead] - NRF24_NET_HEADER;
+	if(from!=NULL)
+		*from = (unsigned char)frame[2] | ((unsigned int)(unsigned char)frame[3]<<8);
+	if(type!=NULL)
+		*type = frame[5];
+	memcpy(data, &frame[NRF24_NET_HEADER], size);
+	node->inboxHead = (node->inboxHead+1) % NRF24_NET_INBOX_SIZE;
+	node->inboxCount--;
+	return size;
+}
+
+/**
+  * @brief  Radio address of a data pipe of a node.
+  *
+  * @param	address: Position of the node in tree.
+  * @param	pipe: Data pipe, 0 to 5.
+  * @param	radio: Stores 5 bytes, first byte is MSB.
+  * @retval NONE.
+  */
+void netPipeAddress(unsigned int address, unsigned char pipe, char *radio)
+{
+	radio[0] = NET_PREFIX0;
+	radio[1] = NET_PREFIX1;
+	radio[2] = address>>8;
+	radio[3] = address;
+	radio[4] = netPipeByte[pipe];
+}
+
+/**
+  * @brief  Copies a frame to the store and forward queue.
+  *
+  * @param	node: State of this node.
+  * @param	frame: The frame.
+  * @param	length: Size of the frame.
+  * @retval 1: frame is queued, 0: queue is full.
+  */
+bool netEnqueue(NRF24_NetNode *node, char *frame, unsigned char length)
+{
+	unsigned char index;
+
+	if(node->queueCount>=NRF24_NET_QUEUE_SIZE)
+	{
+		node->stats.queueDrops++;
+		return 0;
+	}
+	index = (node->queueHead+node->queueCount) % NRF24_NET_QUEUE_SIZE;
+	memcpy(node->queue[index], frame, length);
+	node->queueLength[index] = length;
+	node->queueCount++;
+	return 1;
+}
+
+/**
+  * @brief  Keeps a received frame in the inbox or in the store and forward queue.
+  *
+  * @param	node: State of this node.
+  * @param	frame: The frame.
+  * @param	length: Size of the frame.
+  * @retval NONE.
+  */
+void netReceive(NRF24_NetNode *node, char *frame, unsigned char length)
+{
+	if(length<=NRF24_NET_HEADER)
+		return; //not a frame of this layer
+	if(((unsigned char)frame[0] | ((unsigned int)(unsigned char)frame[1]<<8))==node->address)
+		netDeliver(node, frame, length);
+	else
+		netEnqueue(node, frame, length);
+}
+
+/**
+  * @brief  Copies a frame to this node to the inbox.
+  *
+  * @param	node: State of this node.
+  * @param	frame: The frame.
+  * @param	length: Size of the frame.
+  * @retval 1: frame is kept, 0: inbox is full.
+  */
+bool netDeliver(NRF24_NetNode *node, char *frame, unsigned char length)
+{
+	unsigned char index;
+
+	if(node->inboxCount>=NRF24_NET_INBOX_SIZE)
+	{
+		node->stats.queueDrops++;
+		return 0;
+	}
+	index = (node->inboxHead+node->inboxCount) % NRF24_NET_INBOX_SIZE;
+	memcpy(node->inbox[index], frame, length);
+	node->inboxLength[index] = length;
+	node->inboxCount++;
+	node->stats.received++;
+	return 1;
+}
+
+/**
+  * @brief  Queues a frame to the next hop, does not wait for ACK or MAX_RT. nrf24 has to be transmitter.
+  *
+  * @param	node: State of this node.
+  * @param	frame: The frame.
+  * @param	length: Size of the frame.
+  * @retval Ticket of the packet, 0: no route or TX queue is full.
+  */
+unsigned char netForward(NRF24_NetNode *node, char *frame, unsigned char length)
+{
+	unsigned char via = netRoute(node, (unsigned char)frame[0] | ((unsigned int)(unsigned char)frame[1]<<8));
+	unsigned char ticket;
+
+	if(via==NRF24_NET_NO_ROUTE)
+	{
+		node->stats.noRoute++;
+		return 0;
+	}
+
+	if(selectPeer(via)==0 || (ticket=txEnqueue(frame, length))==0)
+	{
+		node->stats.failures++;
+		return 0;
+	}
+	return ticket;
+}
+
+/**
+  * @brief  Counts the result of the frame at head of queue and removes it.
+  *
+  * @param	node: State of this node.
+  * @param	status: Result of its ticket, not NRF24_TX_PENDING.
+  * @retval NONE.
+  */
+void netComplete(NRF24_NetNode *node, NRF24_TxStatus status)
+{
+	char *frame = node->queue[node->queueHead];
+
+	if(status!=NRF24_TX_DELIVERED)
+		node->stats.failures++;
+	else if(((unsigned char)frame[2] | ((unsigned int)(unsigned char)frame[3]<<8))!=node->address)
+		node->stats.forwarded++;
+	node->queueHead = (node->queueHead+1) % NRF24_NET_QUEUE_SIZE;
+	node->queueCount--;
+	node->ticket = 0;
+}
@@ -0,0 +1,125 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_net.h
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Header file of tree network layer over nrf24L01p.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NRF24L01P_NET_H
+#define __NRF24L01P_NET_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p.h>
+
+#ifndef __CODEVISIONAVR__
+#define flash const //tables are in flash on AVR, const elsewhere
+#endif
+
+#ifndef NRF24_NET_QUEUE_SIZE
+#define NRF24_NET_QUEUE_SIZE 4 //frames waiting to be sent or forwarded (33 byte RAM each)
+#endif
+
+#ifndef NRF24_NET_INBOX_SIZE
+#define NRF24_NET_INBOX_SIZE 2 //frames to this node waiting for netRead() (33 byte RAM each)
+#endif
+
+#ifndef NRF24_NET_ROUTES
+#define NRF24_NET_ROUTES 8 //routing table entries, netInit() uses 6 of them
+#endif
+
+#if NRF24_PEER_TABLE_SIZE<6
+#error "nRF24L01p_net.c needs NRF24_PEER_TABLE_SIZE of 6 (parent and 5 children), define it in project settings"
+#endif
+
+#ifdef NRF24_PROFILE
+#error "nRF24L01p_net.c sets addresses of data pipes at run time, build it without NRF24_PROFILE"
+#endif
+
+#define NRF24_NET_HEADER 6 //to, from, id and type
+#define NRF24_NET_MAX_PAYLOAD (32-NRF24_NET_HEADER)
+#define NRF24_NET_MAX_DEPTH 5 //levels under root, 3 address bits each
+#define NRF24_NET_PARENT 0 //via of routes to the parent, 1 to 5 are children
+#define NRF24_NET_NO_ROUTE 0xFF
+
+/* Exported types ------------------------------------------------------------*/
+
+/** 
+  * @brief	Route. Frames whose destination matches node in the bits of mask are sent via a neighbour.
+  */
+typedef struct {
+    unsigned int node;
+    unsigned int mask;
+    unsigned char via; //NRF24_NET_PARENT or child 1 to 5
+} NRF24_NetRoute;
+
+/** 
+  * @brief	Network Counters. Since netInit().
+  */
+typedef struct {
+    unsigned int sent; //frames given to netSend()
+    unsigned int received; //frames to this node
+    unsigned int forwarded; //frames of other nodes sent on
+    unsigned int queueDrops; //frames dropped because queue or inbox was full, received ones after their ACK
+    unsigned int failures; //frames next hop did not acknowledge
+    unsigned int noRoute; //frames no route matched
+} NRF24_NetStats;
+
+/** 
+  * @brief	Network Node. State of this node, one per device.
+  */
+typedef struct {
+    unsigned int address; //position in tree, 3 bits per level from LSB, 0 is root
+    unsigned char depth; //levels under root
+    NRF24_NetRoute routes[NRF24_NET_ROUTES]; //first match is used
+    unsigned char routeCount;
+    char queue[NRF24_NET_QUEUE_SIZE][32]; //store and forward queue, frames of this node too
+    unsigned char queueLength[NRF24_NET_QUEUE_SIZE];
+    unsigned char queueHead;
+    unsigned char queueCount;
+    unsigned char ticket; //of the frame at head of queue while it is on air, 0 if none
+    bool sending; //nrf24 is switched to transmitter for the queue
+    char inbox[NRF24_NET_INBOX_SIZE][32];
+    unsigned char inboxLength[NRF24_NET_INBOX_SIZE];
+    unsigned char inboxHead;
+    unsigned char inboxCount;
+    unsigned char nextId;
+    NRF24_NetStats stats;
+} NRF24_NetNode;
+
+/* Exported functions --------------------------------------------------------*/
+
+/* Network functions *********************************************************/
+bool netInit(NRF24_NetNode *node, unsigned int address);
+bool netAddRoute(NRF24_NetNode *node, unsigned int destination, unsigned int mask, unsigned char via);
+unsigned char netRoute(NRF24_NetNode *node, unsigned int destination);
+bool netSend(NRF24_NetNode *node, unsigned int to, unsigned char type, char *data, unsigned char size);
+bool netService(NRF24_NetNode *node);
+unsigned char netRead(NRF24_NetNode *node, unsigned int *from, unsigned char *type, char *data);
+void netPipeAddress(unsigned int address, unsigned char pipe, char *radio);
+
+#endif
@@ -0,0 +1,411 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_rate.c
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Data rate adaptation over nrf24L01p driver.
+  *    
+  *         This file provides firmware functions to manage the following 
+  *         functionalities of links with changing distance
+  *           + Rate adaptation functions
+  @verbatim     
+  ==============================================================================      
+                        ##### How to use this driver #####
+  ============================================================================== 
+  [..]
+   (#) Call rateInit() on both sides after nRF_Config(), auto acknowledge is
+	   enabled and both start at NRF24_RATE_FALLBACK. A us clock has to be
+	   given to setTimestampSource() on receiver.
+
+   (#) In case of Transmitter:
+	   Send by txEnqueue() or txEnqueueLane() and call rateService() in main
+	   loop. It reads delivered, failed and retransmit counters of TX lanes
+	   and moves to the rate with the best goodput.
+
+   (#) In case of Receiver:
+	   Read packets by rateRead() instead of readRxFIFO(), it handles rate
+	   change frames of sender, and call rateService() in main loop.
+
+     *** Algorithm ***    
+     =================================== 
+    [..]
+	  As Minstrel: success probability of a transmission is measured for
+	  each window of packets (delivered / (delivered+failed+retransmits))
+	  and averaged (EWMA, 1/4). Retransmits are read once per TX interrupt,
+	  so in coalescing mode they are scaled from the observed packets to
+	  the whole window. Goodput of a rate is probability times
+	  payload over time of one try (settling, packet, ACK). Every
+	  NRF24_RATE_PROBE_EVERY windows, one window is sent at a neighbouring
+	  rate, then the best measured rate is kept.
+	  A change is a high priority frame at old rate; sender changes when it
+	  is acknowledged, receiver when it reads it. If it goes wrong, sender
+	  falls back after NRF24_RATE_MAX_FAIL failed packets in a row and
+	  receiver after NRF24_RATE_SILENCE us without packets.
+  
+  @endverbatim
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <mega88a.h>
+#include <nRF24L01p.h>
+#include <nRF24L01p_rate.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define RATE_MAGIC 0xE7 //first byte of rate change frame
+#define RATE_FRAME_SIZE 3
+
+/* Private variables ---------------------------------------------------------*/
+flash unsigned int rateTryTime[3] = {1740, 630, 450}; //us of one try of 32 byte packet with ACK, indexed by NRF24_BaudRate
+
+Mode rateMode;
+NRF24_BaudRate rateCurrent = NRF24_RATE_FALLBACK;
+unsigned char rateProbability[3]; //EWMA of success probability, 0 to 255
+bool rateKnown[3]; //rate is measured at least once
+unsigned int rateLastDelivered = 0; //lane counters at last rateService()
+unsigned int rateLastFailed = 0;
+unsigned int rateLastRetries = 0;
+unsigned int rateLastObserved = 0;
+unsigned int rateWindowDelivered = 0; //counters of current window
+unsigned int rateWindowFailed = 0;
+unsigned int rateWindowRetries = 0;
+unsigned int rateWindowObserved = 0; //packets whose retransmits are known
+unsigned char rateFailRun = 0; //failed packets in a row
+unsigned char rateWindows = 0; //windows since last probe
+bool rateProbing = 0; //current window is a probe
+bool rateProbeUp = 1; //direction of next probe
+unsigned char rateTicket = 0; //ticket of rate change frame, 0 if none
+NRF24_BaudRate ratePending; //rate of rate change frame
+unsigned char rateSeq = 0; //sequence of rate change frames
+unsigned long rateLastRx = 0; //receiver: time of last packet
+unsigned int rateSwitches = 0;
+unsigned int rateFallbacks = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+void rateSet(NRF24_BaudRate rate);
+void rateRequest(NRF24_BaudRate rate);
+void rateEndWindow();
+NRF24_BaudRate rateBest();
+unsigned int rateGoodput(NRF24_BaudRate rate);
+
+/** @defgroup nrf24L01p_rate Rate adaptation functions
+ *  @brief   Rate adaptation functions
+ *
+@verbatim
+ ===============================================================================
+					##### Rate adaptation functions  #####
+ ===============================================================================
+    [..]
+    Counters of TX lanes are read, so nothing is added to the send path.
+    Packets that are in TX FIFO while the rate changes may fail once, they
+    are counted in the next window.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Starts rate adaptation, both sides go to NRF24_RATE_FALLBACK.
+  *
+  * @param	mode: Mode of operation, Transmitter or Receiver.
+  * @retval NONE.
+  */
+void rateInit(Mode mode)
+{
+	NRF24_LaneStats high;
+	NRF24_LaneStats bulk;
+
+	rateMode = mode;
+	memset(rateProbability, 0, sizeof(rateProbability));
+	memset(rateKnown, 0, sizeof(rateKnown));
+	rateWindowDelivered = 0;
+	rateWindowFailed = 0;
+	rateWindowRetries = 0;
+	rateWindowObserved = 0;
+	rateFailRun = 0;
+	rateWindows = 0;
+	rateProbing = 0;
+	rateTicket = 0;
+
+	getLaneStats(NRF24_LANE_HIGH, &high);
+	getLaneStats(NRF24_LANE_BULK, &bulk);
+	rateLastDelivered = high.delivered + bulk.delivered;
+	rateLastFailed = high.failed + bulk.failed;
+	rateLastRetries = high.retries + bulk.retries;
+	rateLastObserved = high.observed + bulk.observed;
+
+	setAutoAck(1); //delivery and retransmits are only known with ACK
+	setRetransmit(1, 3); //500us, enough for ACK at 250Kbps
+	rateSet(NRF24_RATE_FALLBACK);
+	rateLastRx = getTimestamp();
+}
+
+/**
+  * @brief  Updates statistics and changes rate, has to be called in main loop on both sides.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void rateService()
+{
+	NRF24_LaneStats high;
+	NRF24_LaneStats bulk;
+	unsigned int delivered;
+	unsigned int failed;
+	unsigned int retries;
+	unsigned int observed;
+	NRF24_TxStatus status;
+
+	if(rateMode==NRF24_RECEIVER)
+	{
+		if(rateCurrent!=NRF24_RATE_FALLBACK && getTimestamp()-rateLastRx >= NRF24_RATE_SILENCE)
+		{
+			rateSet(NRF24_RATE_FALLBACK); //sender is lost or has fallen back
+			rateFallbacks++;
+			rateLastRx = getTimestamp();
+		}
+		return;
+	}
+
+	getLaneStats(NRF24_LANE_HIGH, &high);
+	getLaneStats(NRF24_LANE_BULK, &bulk);
+	delivered = high.delivered + bulk.delivered - rateLastDelivered;
+	failed = high.failed + bulk.failed - rateLastFailed;
+	retries = high.retries + bulk.retries - rateLastRetries;
+	observed = high.observed + bulk.observed - rateLastObserved;
+	rateLastDelivered += delivered;
+	rateLastFailed += failed;
+	rateLastRetries += retries;
+	rateLastObserved += observed;
+
+	if(rateTicket!=0) //rate change frame is on its way
+	{
+		status = getTxStatus(rateTicket);
+		if(status==NRF24_TX_DELIVERED) //receiver has it, move together
+		{
+			rateTicket = 0;
+			rateSet(ratePending);
+			rateSwitches++;
+			return;
+		}
+		if(status!=NRF24_TX_PENDING) //not acknowledged, stay
+		{
+			rateTicket = 0;
+			rateProbing = 0;
+		}
+	}
+
+	if(failed>0 && delivered==0)
+		rateFailRun += failed;
+	else if(delivered>0)
+		rateFailRun = 0;
+	if(rateFailRun>=NRF24_RATE_MAX_FAIL && rateCurrent!=NRF24_RATE_FALLBACK) //link is lost, receiver falls back on silence
+	{
+		rateKnown[rateCurrent] = 1;
+		rateProbability[rateCurrent] = 0;
+		rateSet(NRF24_RATE_FALLBACK);
+		rateFallbacks++;
+		return;
+	}
+
+	rateWindowDelivered += delivered;
+	rateWindowFailed += failed;
+	rateWindowRetries += retries;
+	rateWindowObserved += observed;
+	if(rateTicket==0 && rateWindowDelivered+rateWindowFailed >= NRF24_RATE_WINDOW)
+		rateEndWindow();
+}
+
+/**
+  * @brief  Reads a received packet, rate change frames are handled and not returned.
+  *
+  * @param	data: Array to store the packet, at least 32 byte.
+  * @retval Size of packet, 0 if there is no packet for application.
+  */
+unsigned char rateRead(char *data)
+{
+	unsigned char size = bytesAvailable();
+
+	if(size==0)
+		return 0;
+	readRxFIFO(data, size);
+	rateLastRx = getTimestamp();
+
+	if(size==RATE_FRAME_SIZE && (unsigned char)data[0]==RATE_MAGIC)
+	{
+		if((unsigned char)data[1]<=NRF24_2Mbps && data[1]!=rateCurrent)
+		{
+			rateSet((NRF24_BaudRate)data[1]);
+			rateSwitches++;
+		}
+		return 0;
+	}
+	return size;
+}
+
+/**
+  * @brief  Current data rate.
+  *
+  * @param	NONE.
+  * @retval Data rate.
+  */
+NRF24_BaudRate rateGet()
+{
+	return rateCurrent;
+}
+
+/**
+  * @brief  Reads probability and goodput of every rate.
+  *
+  * @param	stats: Stores the statistics.
+  * @retval NONE.
+  */
+void rateGetStats(NRF24_RateStats *stats)
+{
+	unsigned char r;
+
+	stats->current = rateCurrent;
+	for(r=NRF24_250Kbps;r<=NRF24_2Mbps;r++)
+	{
+		stats->probability[r] = rateProbability[r];
+		stats->goodput[r] = rateGoodput((NRF24_BaudRate)r);
+	}
+	stats->switches = rateSwitches;
+	stats->fallbacks = rateFallbacks;
+}
+
+/**
+  * @brief  Changes data rate of this side and starts a new window.
+  *
+  * @param	rate: New data rate.
+  * @retval NONE.
+  */
+void rateSet(NRF24_BaudRate rate)
+{
+	setBaudRate(rate);
+	rateCurrent = rate;
+	rateWindowDelivered = 0;
+	rateWindowFailed = 0;
+	rateWindowRetries = 0;
+	rateWindowObserved = 0;
+	rateFailRun = 0;
+}
+
+/**
+  * @brief  Sends a rate change frame at current rate, sender changes when it is acknowledged.
+  *
+  * @param	rate: New data rate.
+  * @retval NONE.
+  */
+void rateRequest(NRF24_BaudRate rate)
+{
+	char frame[RATE_FRAME_SIZE];
+
+	frame[0] = RATE_MAGIC;
+	frame[1] = rate;
+	frame[2] = rateSeq++; //PID alone would drop a frame that equals the previous one
+	rateTicket = txEnqueueLane(frame, RATE_FRAME_SIZE, NRF24_LANE_HIGH, 0);
+	ratePending = rate;
+}
+
+/**
+  * @brief  Updates probability of current rate, then probes or moves to the best rate.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void rateEndWindow()
+{
+	unsigned int packets = rateWindowDelivered + rateWindowFailed;
+	unsigned long retries = rateWindowRetries;
+	unsigned char probability;
+	NRF24_BaudRate best;
+
+	if(rateWindowObserved>0 && rateWindowObserved<packets) //only last packet of each TX interrupt is observed
+		retries = retries * packets / rateWindowObserved;
+	probability = ((unsigned long)rateWindowDelivered*255) / (packets + retries);
+
+	if(rateKnown[rateCurrent]==1)
+		rateProbability[rateCurrent] = ((unsigned int)rateProbability[rateCurrent]*3 + probability) / 4;
+	else
+		rateProbability[rateCurrent] = probability;
+	rateKnown[rateCurrent] = 1;
+	rateWindowDelivered = 0;
+	rateWindowFailed = 0;
+	rateWindowRetries = 0;
+	rateWindowObserved = 0;
+
+	best = rateBest();
+	if(rateProbing==0 && ++rateWindows>=NRF24_RATE_PROBE_EVERY)
+	{
+		rateWindows = 0;
+		if(rateCurrent==NRF24_2Mbps)
+			rateProbeUp = 0;
+		else if(rateCurrent==NRF24_250Kbps)
+			rateProbeUp = 1;
+		rateProbing = 1;
+		rateRequest(rateProbeUp ? rateCurrent+1 : rateCurrent-1);
+		rateProbeUp = !rateProbeUp;
+		return;
+	}
+
+	rateProbing = 0;
+	if(best!=rateCurrent)
+		rateRequest(best);
+}
+
+/**
+  * @brief  Measured rate with the highest goodput.
+  *
+  * @param	NONE.
+  * @retval Data rate.
+  */
+NRF24_BaudRate rateBest()
+{
+	NRF24_BaudRate best = rateCurrent;
+	unsigned char r;
+
+	for(r=NRF24_250Kbps;r<=NRF24_2Mbps;r++)
+	{
+		if(rateKnown[r]==1 && rateGoodput((NRF24_BaudRate)r) > rateGoodput(best))
+			best = (NRF24_BaudRate)r;
+	}
+	return best;
+}
+
+/**
+  * @brief  Estimated goodput of a rate from its probability.
+  *
+  * @param	rate: Data rate.
+  * @retval kbps of payload, 0 if rate is not measured.
+  */
+unsigned int rateGoodput(NRF24_BaudRate rate)
+{
+	if(rateKnown[rate]==0)
+		return 0;
+	return ((unsigned long)rateProbability[rate] * 1004) / rateTryTime[rate]; //probability/255 * 256 bit * 1000 / us
+}
@@ -0,0 +1,79 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_rate.h
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Header file of data rate adaptation over nrf24L01p.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NRF24L01P_RATE_H
+#define __NRF24L01P_RATE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p.h>
+
+#ifndef NRF24_RATE_WINDOW
+#define NRF24_RATE_WINDOW 32 //packets per statistics window
+#endif
+
+#ifndef NRF24_RATE_PROBE_EVERY
+#define NRF24_RATE_PROBE_EVERY 10 //windows between two probes of a neighbouring rate
+#endif
+
+#ifndef NRF24_RATE_MAX_FAIL
+#define NRF24_RATE_MAX_FAIL 3 //failed packets in a row before both sides fall back
+#endif
+
+#ifndef NRF24_RATE_SILENCE
+#define NRF24_RATE_SILENCE 500000 //us without any packet before receiver falls back
+#endif
+
+#define NRF24_RATE_FALLBACK NRF24_250Kbps //rate both sides meet at when the link is lost
+
+/* Exported types ------------------------------------------------------------*/
+
+/** 
+  * @brief	Rate Statistics. Success probability of a transmission at each rate.
+  */
+typedef struct {
+    NRF24_BaudRate current;
+    unsigned char probability[3]; //0 to 255, indexed by NRF24_BaudRate
+    unsigned int goodput[3]; //estimated kbps of 32 byte packets, 0 if rate is not measured yet
+    unsigned int switches; //rate changes agreed with peer
+    unsigned int fallbacks; //times link was lost and fallback rate is used
+} NRF24_RateStats;
+
+/* Exported functions --------------------------------------------------------*/
+
+/* Rate adaptation functions *************************************************/
+void rateInit(Mode mode);
+void rateService();
+unsigned char rateRead(char *data);
+NRF24_BaudRate rateGet();
+void rateGetStats(NRF24_RateStats *stats);
+
+#endif
@@ -0,0 +1,348 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_rs.c
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   GF(256) Reed-Solomon kernels for packet erasure coding.
+  *    
+  *         This file provides functions to manage the following 
+  *         functionalities of forward error correction
+  *           + GF(256) functions
+  *           + Reed-Solomon functions
+  @verbatim     
+  ==============================================================================      
+                        ##### How to use this driver #####
+  ============================================================================== 
+  [..]
+   (#) A block is k data symbols and m parity symbols of the same length.
+	   Parity symbol j is sum of c(j,i)*data(i), sums are XOR and products
+	   are in GF(256) with polynomial 0x11D. With m=1 every coefficient is
+	   1 (plain XOR parity), otherwise it is the Cauchy matrix
+	   c(j,i) = 1/((k+j)+i), so any k symbols of a block rebuild the rest.
+
+   (#) These functions do not use nrf24, nRF24L01p_fec.c puts them over
+	   sendData(); TestFecHost.c measures them on a PC.
+
+     *** Cost ***    
+     =================================== 
+    [..]
+	  Products use log/antilog tables (768 byte in flash), one table read
+	  per byte and coefficient. A lost packet costs k multiply-adds to
+	  rebuild, encoding costs m multiply-adds per data byte.
+  
+  @endverbatim
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p_rs.h>
+
+/* Private variables ---------------------------------------------------------*/
+flash unsigned char gfExp[512] = { //alpha^i, twice so that log(a)+log(b) needs no modulo
+	0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1D, 0x3A, 0x74, 0xE8, 0xCD, 0x87, 0x13, 0x26,
+	0x4C, 0x98, 0x2D, 0x5A, 0xB4, 0x75, 0xEA, 0xC9, 0x8F, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xC0,
+	0x9D, 0x27, 0x4E, 0x9C, 0x25, 0x4A, 0x94, 0x35, 0x6A, 0xD4, 0xB5, 0x77, 0xEE, 0xC1, 0x9F, 0x23,
+	0x46, 0x8C, 0x05, 0x0A, 0x14, 0x28, 0x50, 0xA0, 0x5D, 0xBA, 0x69, 0xD2, 0xB9, 0x6F, 0xDE, 0xA1,
+	0x5F, 0xBE, 0x61, 0xC2, 0x99, 0x2F, 0x5E, 0xBC, 0x65, 0xCA, 0x89, 0x0F, 0x1E, 0x3C, 0x78, 0xF0,
+	0xFD, 0xE7, 0xD3, 0xBB, 0x6B, 0xD6, 0xB1, 0x7F, 0xFE, 0xE1, 0xDF, 0xA3, 0x5B, 0xB6, 0x71, 0xE2,
+	0xD9, 0xAF, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0D, 0x1A, 0x34, 0x68, 0xD0, 0xBD, 0x67, 0xCE,
+	0x81, 0x1F, 0x3E, 0x7C, 0xF8, 0xED, 0xC7, 0x93, 0x3B, 0x76, 0xEC, 0xC5, 0x97, 0x33, 0x66, 0xCC,
+	0x85, 0x17, 0x2E, 0x5C, 0xB8, 0x6D, 0xDA, 0xA9, 0x4F, 0x9E, 0x21, 0x42, 0x84, 0x15, 0x2A, 0x54,
+	0xA8, 0x4D, 0x9A, 0x29, 0x52, 0xA4, 0x55, 0xAA, 0x49, 0x92, 0x39, 0x72, 0xE4, 0xD5, 0xB7, 0x73,
+	0xE6, 0xD1, 0xBF, 0x63, 0xC6, 0x91, 0x3F, 0x7E, 0xFC, 0xE5, 0xD7, 0xB3, 0x7B, 0xF6, 0xF1, 0xFF,
+	0xE3, 0xDB, 0xAB, 0x4B, 0x96, 0x31, 0x62, 0xC4, 0x95, 0x37, 0x6E, 0xDC, 0xA5, 0x57, 0xAE, 0x41,
+	0x82, 0x19, 0x32, 0x64, 0xC8, 0x8D, 0x07, 0x0E, 0x1C, 0x38, 0x70, 0xE0, 0xDD, 0xA7, 0x53, 0xA6,
+	0x51, 0xA2, 0x59, 0xB2, 0x79, 0xF2, 0xF9, 0xEF, 0xC3, 0x9B, 0x2B, 0x56, 0xAC, 0x45, 0x8A, 0x09,
+	0x12, 0x24, 0x48, 0x90, 0x3D, 0x7A, 0xF4, 0xF5, 0xF7, 0xF3, 0xFB, 0xEB, 0xCB, 0x8B, 0x0B, 0x16,
+	0x2C, 0x58, 0xB0, 0x7D, 0xFA, 0xE9, 0xCF, 0x83, 0x1B, 0x36, 0x6C, 0xD8, 0xAD, 0x47, 0x8E, 0x01,
+	0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1D, 0x3A, 0x74, 0xE8, 0xCD, 0x87, 0x13, 0x26, 0x4C,
+	0x98, 0x2D, 0x5A, 0xB4, 0x75, 0xEA, 0xC9, 0x8F, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xC0, 0x9D,
+	0x27, 0x4E, 0x9C, 0x25, 0x4A, 0x94, 0x35, 0x6A, 0xD4, 0xB5, 0x77, 0xEE, 0xC1, 0x9F, 0x23, 0x46,
+	0x8C, 0x05, 0x0A, 0x14, 0x28, 0x50, 0xA0, 0x5D, 0xBA, 0x69, 0xD2, 0xB9, 0x6F, 0xDE, 0xA1, 0x5F,
+	0xBE, 0x61, 0xC2, 0x99, 0x2F, 0x5E, 0xBC, 0x65, 0xCA, 0x89, 0x0F, 0x1E, 0x3C, 0x78, 0xF0, 0xFD,
+	0xE7, 0xD3, 0xBB, 0x6B, 0xD6, 0xB1, 0x7F, 0xFE, 0xE1, 0xDF, 0xA3, 0x5B, 0xB6, 0x71, 0xE2, 0xD9,
+	0xAF, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0D, 0x1A, 0x34, 0x68, 0xD0, 0xBD, 0x67, 0xCE, 0x81,
+	0x1F, 0x3E, 0x7C, 0xF8, 0xED, 0xC7, 0x93, 0x3B, 0x76, 0xEC, 0xC5, 0x97, 0x33, 0x66, 0xCC, 0x85,
+	0x17, 0x2E, 0x5C, 0xB8, 0x6D, 0xDA, 0xA9, 0x4F, 0x9E, 0x21, 0x42, 0x84, 0x15, 0x2A, 0x54, 0xA8,
+	0x4D, 0x9A, 0x29, 0x52, 0xA4, 0x55, 0xAA, 0x49, 0x92, 0x39, 0x72, 0xE4, 0xD5, 0xB7, 0x73, 0xE6,
+	0xD1, 0xBF, 0x63, 0xC6, 0x91, 0x3F, 0x7E, 0xFC, 0xE5, 0xD7, 0xB3, 0x7B, 0xF6, 0xF1, 0xFF, 0xE3,
+	0xDB, 0xAB, 0x4B, 0x96, 0x31, 0x62, 0xC4, 0x95, 0x37, 0x6E, 0xDC, 0xA5, 0x57, 0xAE, 0x41, 0x82,
+	0x19, 0x32, 0x64, 0xC8, 0x8D, 0x07, 0x0E, 0x1C, 0x38, 0x70, 0xE0, 0xDD, 0xA7, 0x53, 0xA6, 0x51,
+	0xA2, 0x59, 0xB2, 0x79, 0xF2, 0xF9, 0xEF, 0xC3, 0x9B, 0x2B, 0x56, 0xAC, 0x45, 0x8A, 0x09, 0x12,
+	0x24, 0x48, 0x90, 0x3D, 0x7A, 0xF4, 0xF5, 0xF7, 0xF3, 0xFB, 0xEB, 0xCB, 0x8B, 0x0B, 0x16, 0x2C,
+	0x58, 0xB0, 0x7D, 0xFA, 0xE9, 0xCF, 0x83, 0x1B, 0x36, 0x6C, 0xD8, 0xAD, 0x47, 0x8E, 0x01, 0x02
+};
+
+flash unsigned char gfLog[256] = { //log of alpha, gfLog[0] is not used
+	0x00, 0x00, 0x01, 0x19, 0x02, 0x32, 0x1A, 0xC6, 0x03, 0xDF, 0x33, 0xEE, 0x1B, 0x68, 0xC7, 0x4B,
+	0x04, 0x64, 0xE0, 0x0E, 0x34, 0x8D, 0xEF, 0x81, 0x1C, 0xC1, 0x69, 0xF8, 0xC8, 0x08, 0x4C, 0x71,
+	0x05, 0x8A, 0x65, 0x2F, 0xE1, 0x24, 0x0F, 0x21, 0x35, 0x93, 0x8E, 0xDA, 0xF0, 0x12, 0x82, 0x45,
+	0x1D, 0xB5, 0xC2, 0x7D, 0x6A, 0x27, 0xF9, 0xB9, 0xC9, 0x9A, 0x09, 0x78, 0x4D, 0xE4, 0x72, 0xA6,
+	0x06, 0xBF, 0x8B, 0x62, 0x66, 0xDD, 0x30, 0xFD, 0xE2, 0x98, 0x25, 0xB3, 0x10, 0x91, 0x22, 0x88,
+	0x36, 0xD0, 0x94, 0xCE, 0x8F, 0x96, 0xDB, 0xBD, 0xF1, 0xD2, 0x13, 0x5C, 0x83, 0x38, 0x46, 0x40,
+	0x1E, 0x42, 0xB6, 0xA3, 0xC3, 0x48, 0x7E, 0x6E, 0x6B, 0x3A, 0x28, 0x54, 0xFA, 0x85, 0xBA, 0x3D,
+	0xCA, 0x5E, 0x9B, 0x9F, 0x0A, 0x15, 0x79, 0x2B, 0x4E, 0xD4, 0xE5, 0xAC, 0x73, 0xF3, 0xA7, 0x57,
+	0x07, 0x70, 0xC0, 0xF7, 0x8C, 0x80, 0x63, 0x0D, 0x67, 0x4A, 0xDE, 0xED, 0x31, 0xC5, 0xFE, 0x18,
+	0xE3, 0xA5, 0x99, 0x77, 0x26, 0xB8, 0xB4, 0x7C, 0x11, 0x44, 0x92, 0xD9, 0x23, 0x20, 0x89, 0x2E,
+	0x37, 0x3F, 0xD1, 0x5B, 0x95, 0xBC, 0xCF, 0xCD, 0x90, 0x87, 0x97, 0xB2, 0xDC, 0xFC, 0xBE, 0x61,
+	0xF2, 0x56, 0xD3, 0xAB, 0x14, 0x2A, 0x5D, 0x9E, 0x84, 0x3C, 0x39, 0x53, 0x47, 0x6D, 0x41, 0xA2,
+	0x1F, 0x2D, 0x43, 0xD8, 0xB7, 0x7B, 0xA4, 0x76, 0xC4, 0x17, 0x49, 0xEC, 0x7F, 0x0C, 0x6F, 0xF6,
+	0x6C, 0xA1, 0x3B, 0x52, 0x29, 0x9D, 0x55, 0xAA, 0xFB, 0x60, 0x86, 0xB1, 0xBB, 0xCC, 0x3E, 0x5A,
+	0xCB, 0x59, 0x5F, 0xB0, 0x9C, 0xA9, 0xA0, 0x51, 0x0B, 0xF5, 0x16, 0xEB, 0x7A, 0x75, 0x2C, 0xD7,
+	0x4F, 0xAE, 0xD5, 0xE9, 0xE6, 0xE7, 0xAD, 0xE8, 0x74, 0xD6, 0xF4, 0xEA, 0xA8, 0x50, 0x58, 0xAF
+};
+
+/** @defgroup nrf24L01p_rs GF(256) functions
+ *  @brief   GF(256) functions
+ *
+@verbatim
+ ===============================================================================
+							##### GF(256) functions  #####
+ ===============================================================================
+    [..]
+    Addition is XOR. Multiplication is alpha^(log(a)+log(b)), zero has no
+    logarithm and is checked before any table read.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Multiplies two elements of GF(256).
+  *
+  * @param	a: First element.
+  * @param	b: Second element.
+  * @retval a*b.
+  */
+unsigned char gfMul(unsigned char a, unsigned char b)
+{
+	if(a==0 || b==0)
+		return 0;
+	return gfExp[(unsigned int)gfLog[a] + gfLog[b]];
+}
+
+/**
+  * @brief  Inverse of an element of GF(256).
+  *
+  * @param	a: Element, not 0.
+  * @retval 1/a, 0 if a is 0.
+  */
+unsigned char gfInv(unsigned char a)
+{
+	if(a==0)
+		return 0;
+	return gfExp[255 - gfLog[a]];
+}
+
+/**
+  * @brief  Adds coef*src to dst byte by byte, the kernel of encoding and decoding.
+  *
+  * @param	dst: Symbol that is updated.
+  * @param	src: Symbol that is multiplied.
+  * @param	coef: Coefficient.
+  * @param	len: Length of symbols.
+  * @retval NONE.
+  */
+void gfMulAdd(unsigned char *dst, unsigned char *src, unsigned char coef, unsigned char len)
+{
+	unsigned char logCoef;
+	unsigned char i;
+
+	if(coef==0)
+		return;
+	if(coef==1) //XOR parity
+	{
+		for(i=0;i<len;i++)
+			dst[i] ^= src[i];
+		return;
+	}
+
+	logCoef = gfLog[coef];
+	for(i=0;i<len;i++)
+	{
+		if(src[i]!=0)
+			dst[i] ^= gfExp[(unsigned int)logCoef + gfLog[src[i]]];
+	}
+}
+
+/** @defgroup nrf24L01p_rs Reed-Solomon functions
+ *  @brief   Reed-Solomon functions
+ *
+@verbatim
+ ===============================================================================
+						##### Reed-Solomon functions  #####
+ ===============================================================================
+    [..]
+    symbols is an array of k+m pointers, data symbols first. Bit i of
+    present shows that symbol i is received, so k+m is at most 16.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Coefficient of a data symbol in a parity symbol.
+  *
+  * @param	k: Number of data symbols.
+  * @param	m: Number of parity symbols.
+  * @param	row: Parity symbol, 0 to m-1.
+  * @param	col: Data symbol, 0 to k-1.
+  * @retval Coefficient.
+  */
+unsigned char rsCoefficient(unsigned char k, unsigned char m, unsigned char row, unsigned char col)
+{
+	if(m==1)
+		return 1;
+	return gfInv((k+row) ^ col); //k+row is never equal to col, so it is never 1/0
+}
+
+/**
+  * @brief  Computes the parity symbols of a block.
+  *
+  * @param	k: Number of data symbols.
+  * @param	m: Number of parity symbols.
+  * @param	symbols: k data symbols followed by m parity symbols that are written.
+  * @param	len: Length of symbols.
+  * @retval NONE.
+  */
+void rsEncode(unsigned char k, unsigned char m, unsigned char **symbols, unsigned char len)
+{
+	unsigned char row;
+	unsigned char col;
+	unsigned char i;
+
+	for(row=0;row<m;row++)
+	{
+		for(i=0;i<len;i++)
+			symbols[k+row][i] = 0;
+		for(col=0;col<k;col++)
+			gfMulAdd(symbols[k+row], symbols[col], rsCoefficient(k, m, row, col), len);
+	}
+}
+
+/**
+  * @brief  Rebuilds lost data symbols from received ones. Parity symbols that are used are overwritten.
+  *
+  * @param	k: Number of data symbols.
+  * @param	m: Number of parity symbols, up to NRF24_RS_MAX_M.
+  * @param	symbols: k data symbols followed by m parity symbols.
+  * @param	present: Bit i is 1 if symbol i is received, bits of rebuilt symbols are set.
+  * @param	len: Length of symbols.
+  * @retval Number of rebuilt data symbols, 0 if nothing is lost or less than k symbols are received.
+  */
+unsigned char rsDecode(unsigned char k, unsigned char m, unsigned char **symbols, unsigned int *present, unsigned char len)
+{
+	unsigned char lost[NRF24_RS_MAX_M]; //data symbols to rebuild
+	unsigned char rows[NRF24_RS_MAX_M]; //parity symbols that are used
+	unsigned char a[NRF24_RS_MAX_M][NRF24_RS_MAX_M]; //coefficients of lost symbols in used parity
+	unsigned char inv[NRF24_RS_MAX_M][NRF24_RS_MAX_M];
+	unsigned char e = 0; //number of lost data symbols
+	unsigned char p = 0;
+	unsigned char r;
+	unsigned char c;
+	unsigned char i;
+	unsigned char t;
+	unsigned char pivot;
+
+	if(m>NRF24_RS_MAX_M)
+		return 0;
+
+	for(i=0;i<k;i++)
+	{
+		if((*present & (1<<i))==0)
+		{
+			if(e==m)
+				return 0; //more data symbols lost than parity symbols
+			lost[e++] = i;
+		}
+	}
+	if(e==0)
+		return 0;
+	for(i=0;i<m && p<e;i++)
+	{
+		if(*present & (1<<(k+i)))
+			rows[p++] = i;
+	}
+	if(p<e)
+		return 0; //less than k symbols are received
+
+	//syndrome: take received data symbols out of each used parity symbol
+	for(r=0;r<e;r++)
+	{
+		for(i=0;i<k;i++)
+		{
+			if(*present & (1<<i))
+				gfMulAdd(symbols[k+rows[r]], symbols[i], rsCoefficient(k, m, rows[r], i), len);
+		}
+		for(c=0;c<e;c++)
+		{
+			a[r][c] = rsCoefficient(k, m, rows[r], lost[c]);
+			inv[r][c] = (r==c) ? 1 : 0;
+		}
+	}
+
+	//invert a by Gauss-Jordan elimination, any square part of Cauchy matrix is invertible
+	for(c=0;c<e;c++)
+	{
+		for(r=c;r<e && a[r][c]==0;r++);
+		for(i=0;i<e;i++) //swap rows r and c
+		{
+			t = a[c][i]; a[c][i] = a[r][i]; a[r][i] = t;
+			t = inv[c][i]; inv[c][i] = inv[r][i]; inv[r][i] = t;
+		}
+		pivot = gfInv(a[c][c]);
+		for(i=0;i<e;i++)
+		{
+			a[c][i] = gfMul(a[c][i], pivot);
+			inv[c][i] = gfMul(inv[c][i], pivot);
+		}
+		for(r=0;r<e;r++)
+		{
+			if(r!=c && a[r][c]!=0)
+			{
+				t = a[r][c];
+				for(i=0;i<e;i++)
+				{
+					a[r][i] ^= gfMul(t, a[c][i]);
+					inv[r][i] ^= gfMul(t, inv[c][i]);
+				}
+			}
+		}
+	}
+
+	//lost symbol c is sum of inv[c][r]*syndrome(r)
+	for(c=0;c<e;c++)
+	{
+		for(i=0;i<len;i++)
+			symbols[lost[c]][i] = 0;
+		for(r=0;r<e;r++)
+			gfMulAdd(symbols[lost[c]], symbols[k+rows[r]], inv[c][r], len);
+		*present |= 1<<lost[c];
+	}
+
+	return e;
+}
@@ -0,0 +1,54 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_rs.h
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Header file of GF(256) Reed-Solomon kernels for packet erasure coding.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NRF24L01P_RS_H
+#define __NRF24L01P_RS_H
+
+#ifndef __CODEVISIONAVR__
+#define flash const //tables are in flash on AVR, const elsewhere
+#endif
+
+#define NRF24_RS_MAX_M 4 //largest number of parity symbols rsDecode() can use
+
+/* Exported functions --------------------------------------------------------*/
+
+/* GF(256) functions *********************************************************/
+unsigned char gfMul(unsigned char a, unsigned char b);
+unsigned char gfInv(unsigned char a);
+void gfMulAdd(unsigned char *dst, unsigned char *src, unsigned char coef, unsigned char len);
+
+/* Reed-Solomon functions ****************************************************/
+unsigned char rsCoefficient(unsigned char k, unsigned char m, unsigned char row, unsigned char col);
+void rsEncode(unsigned char k, unsigned char m, unsigned char **symbols, unsigned char len);
+unsigned char rsDecode(unsigned char k, unsigned char m, unsigned char **symbols, unsigned int *present, unsigned char len);
+
+#endif
@@ -0,0 +1,1130 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_sim.c
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Timed nrf24L01p and air model for host programs.
+  *    
+  *         This file provides functions to run nodes on simulated radios
+  *           + Simulator functions
+  *           + Chip functions
+  @verbatim     
+  ==============================================================================      
+                        ##### How to use this driver #####
+  ============================================================================== 
+  [..]
+   (#) Each node is an MCU running its own copy of nRF24L01p.c and of the
+	   application, built by nRF24L01p_host.sh. The copy talks to its chip
+	   by nRF24L01p_host.c, which turns spi(), CE, CSN, IRQ and the delays of
+	   CodeVision into calls of this file.
+
+   (#) simInit() clears the air, simAddNode() adds a node that starts in
+	   hostMain() of its copy, simRun() runs all of them to a time. Run each
+	   scenario by simIsolated(), so every node starts from power on RAM;
+	   it returns 0 when the scenario crashed, main can exit with failure.
+
+     *** Simulation ***    
+     ===================================
+    [..]
+	  (+) Registers, FIFOs, STATUS flags and IRQ are the same as on the chip.
+	      130us settling, power up, air time of preamble, address, packet
+	      control field, payload and CRC, ACK wait (ARD), retransmits
+	      (ARC), MAX_RT, ACK payloads, NOACK, PID duplicate filter, RPD,
+	      REUSE_TX_PL and RX FIFO overflow are modelled.
+	  (+) All nodes hear each other. Two frames overlapping on a channel are
+	      both lost, simSetLoss() loses frames at random on top of that.
+	  (+) MCU time is counted for SPI bytes, clock reads, IRQ pin reads,
+	      delays and interrupt entry, other code runs in no time. Interrupts
+	      are taken between SPI frames.
+	  (+) A node runs at most NRF24_SIM_SETTLE ahead of the slowest one, no
+	      frame can reach the air sooner, so nodes need no locks and the
+	      result is the same on every run.
+  
+  @endverbatim
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p_sim.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/* Private define ------------------------------------------------------------*/
+#define W_REGISTER 0x20
+#define R_RX_PAYLOAD 0x61
+#define R_RX_PL_WID 0x60
+#define W_TX_PAYLOAD 0xA0
+#define W_TX_PAYLOAD_NOACK 0xB0
+#define W_ACK_PAYLOAD 0xA8
+#define FLUSH_TX 0xE1
+#define FLUSH_RX 0xE2
+#define REUSE_TX_PL 0xE3
+#define NOP 0xFF
+
+#define CONFIG 0x00
+#define EN_AA 0x01
+#define EN_RXADDR 0x02
+#define SETUP_AW 0x03
+#define SETUP_RETR 0x04
+#define RF_CH 0x05
+#define RF_SETUP 0x06
+#define STATUS 0x07
+#define OBSERVE_TX 0x08
+#define RPD 0x09
+#define RX_ADDR_P0 0x0A
+#define RX_ADDR_P1 0x0B
+#define TX_ADDR 0x10
+#define RX_PW_P0 0x11
+#define FIFO_STATUS 0x17
+#define DYNPD 0x1C
+#define FEATURE 0x1D
+
+#define SIM_FRAMES 1024 //frames kept for collision and carrier checks
+#define SIM_EVENTS 256
+#define SIM_MAX_AIR 1400.0 //us, longest frame (32 byte at 250Kbps)
+
+#define SIM_TX_START 0
+#define SIM_TX_END 1
+#define SIM_ACK_START 2
+#define SIM_ACK_END 3
+#define SIM_ACK_TIMEOUT 4
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+	int from; //node that sends it
+	int to; //node an ACK is for, -1 for packets
+	double start;
+	double end;
+	unsigned char channel;
+	unsigned char rate; //RF_DR_LOW and RF_DR_HIGH bits of RF_SETUP
+	unsigned char crc; //CRC bytes
+	unsigned char width; //address bytes
+	unsigned char address[5];
+	unsigned char data[32];
+	unsigned char size;
+	unsigned char pid;
+	bool noAck;
+	bool corrupt; //overlapped by another frame
+} SimFrame;
+
+typedef struct {
+	double time;
+	unsigned long order; //events of the same time run in the order they are made
+	unsigned char type;
+	int node;
+	unsigned long frame; //number of the frame
+	unsigned int generation; //txGeneration of the sender when it is made
+	int peer; //SIM_ACK_START: node the ACK is for
+	unsigned char pipe;
+} SimEvent;
+
+/* Private variables ---------------------------------------------------------*/
+NRF24_SimNode simNodes[NRF24_SIM_MAX_NODES];
+int simCount = 0;
+NRF24_SimNode *simCurrent = NULL; //node whose code runs, NULL in scheduler
+ucontext_t simMain;
+double simEnd = 0;
+bool simStopped = 0;
+double simLoss = 0;
+unsigned long simSeed = 1;
+
+SimFrame simFrames[SIM_FRAMES];
+unsigned long simFrameCount = 0; //frames made, frame n is in simFrames[n%SIM_FRAMES]
+
+SimEvent simEvents[SIM_EVENTS]; //binary heap, earliest first
+int simEventCount = 0;
+unsigned long simEventOrder = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+void simStart(int index);
+void simSchedule(double time, unsigned char type, int node, unsigned long frame, unsigned int generation, int peer, unsigned char pipe);
+void simPop(SimEvent *event);
+void simProcess(SimEvent *event);
+void simChipReset(NRF24_SimChip *chip);
+unsigned char simStatus(NRF24_SimChip *chip);
+unsigned char simFifoStatus(NRF24_SimChip *chip);
+unsigned char simCrcBytes(NRF24_SimChip *chip);
+unsigned char simAddressWidth(NRF24_SimChip *chip);
+double simAirTime(unsigned char width, unsigned char size, unsigned char crc, unsigned char rate);
+bool simCarrier(NRF24_SimNode *node, double time);
+int simMatch(NRF24_SimChip *chip, unsigned char *address, unsigned char width);
+unsigned int simCrc(unsigned char *data, unsigned char size);
+void simUpdate(NRF24_SimNode *node, double time);
+void simKick(NRF24_SimNode *node, double time);
+void simTxStart(NRF24_SimNode *node, double time);
+SimFrame *simNewFrame(NRF24_SimNode *node, double time);
+void simCollide(SimFrame *frame);
+void simHear(NRF24_SimNode *node, SimFrame *frame, unsigned int generation);
+void simAckStart(NRF24_SimNode *node, SimEvent *event);
+void simAckEnd(SimEvent *event);
+void simTxDone(NRF24_SimNode *node, double time);
+void simTxPop(NRF24_SimChip *chip, unsigned char index);
+
+/** @defgroup nrf24L01p_sim Simulator functions
+ *  @brief   Simulator functions
+ *
+@verbatim
+ ===============================================================================
+						##### Simulator functions  #####
+ ===============================================================================
+    [..]
+    Nodes are coroutines. The scheduler takes the node that is furthest
+    behind and lets it run to the next event of the air or to
+    NRF24_SIM_SETTLE after the second slowest node, whichever is first.
+    An event is done when every node has reached its time, so a node never
+    sees the air before the others have done their part of it.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Removes all nodes, frames and events.
+  *
+  * @param	seed: Seed of random losses.
+  * @retval NONE.
+  */
+void simInit(unsigned long seed)
+{
+	simCount = 0;
+	simCurrent = NULL;
+	simStopped = 0;
+	simLoss = 0;
+	simSeed = seed;
+	simFrameCount = 0;
+	simEventCount = 0;
+	simEventOrder = 0;
+}
+
+/**
+  * @brief  Adds a node, its chip is powered down with reset values.
+  *
+  * @param	entry: Entry of the copy of the program, one of simEntries[].
+  * @param	arg: Given to hostMain() of the node.
+  * @retval The node, NULL if there are NRF24_SIM_MAX_NODES of them.
+  */
+NRF24_SimNode *simAddNode(NRF24_SimEntry entry, int arg)
+{
+	NRF24_SimNode *node;
+
+	if(simCount>=NRF24_SIM_MAX_NODES)
+		return NULL;
+	node = &simNodes[simCount];
+	if(node->stack==NULL)
+		node->stack = malloc(NRF24_SIM_STACK);
+	if(node->stack==NULL)
+		return NULL;
+
+	node->index = simCount;
+	node->arg = arg;
+	node->now = 0;
+	node->limit = 0;
+	node->parked = 0;
+	node->entry = entry;
+	simChipReset(&node->chip);
+
+	getcontext(&node->context);
+	node->context.uc_stack.ss_sp = node->stack;
+	node->context.uc_stack.ss_size = NRF24_SIM_STACK;
+	node->context.uc_link = NULL;
+	makecontext(&node->context, (void (*)(void))simStart, 1, simCount);
+	simCount++;
+	return node;
+}
+
+/**
+  * @brief  Runs nodes and air till end, or till simStop() is called.
+  *
+  * @param	end: Time in us.
+  * @retval NONE.
+  */
+void simRun(double end)
+{
+	NRF24_SimNode *first;
+	double second;
+	double next;
+	SimEvent event;
+	int i;
+
+	simEnd = end;
+	while(simStopped==0)
+	{
+		first = NULL; //slowest node
+		second = NRF24_SIM_NEVER;
+		for(i=0;i<simCount;i++)
+		{
+			if(simNodes[i].parked==1)
+				continue;
+			if(first==NULL || simNodes[i].now<first->now)
+			{
+				if(first!=NULL)
+					second = first->now;
+				first = &simNodes[i];
+			}
+			else if(simNodes[i].now<second)
+				second = simNodes[i].now;
+		}
+
+		next = (simEventCount>0) ? simEvents[0].time : NRF24_SIM_NEVER;
+		if(first==NULL || next<=first->now) //every node has reached the event
+		{
+			if(next>simEnd)
+				break;
+			simPop(&event);
+			simProcess(&event);
+			continue;
+		}
+
+		first->limit = next;
+		if(second+NRF24_SIM_SETTLE<first->limit)
+			first->limit = second+NRF24_SIM_SETTLE;
+		if(simEnd<first->limit)
+			first->limit = simEnd;
+		simCurrent = first;
+		swapcontext(&simMain, &first->context);
+		simCurrent = NULL;
+	}
+}
+
+/**
+  * @brief  Ends simRun() as soon as the calling node gives up the CPU.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void simStop()
+{
+	simStopped = 1;
+	simEnd = -1; //every node is parked at its next step
+}
+
+/**
+  * @brief  Runs a scenario in a child process, nodes of the copies start from their power on RAM.
+  *
+  * @param	scenario: Function that adds nodes, runs them and prints results.
+  * @param	arg: Given to scenario.
+  * @retval 1: scenario has ended, 0: child could not be started, was killed (crash of a node) or exited with an error, a message is printed.
+  */
+bool simIsolated(void (*scenario)(int arg), int arg)
+{
+	pid_t child;
+	int status;
+
+	fflush(stdout);
+	child = fork();
+	if(child==0)
+	{
+		scenario(arg);
+		fflush(stdout);
+		_exit(0);
+	}
+	if(child<0 || waitpid(child, &status, 0)!=child)
+	{
+		fprintf(stderr, "scenario %d could not be run\n", arg);
+		return 0;
+	}
+	if(WIFSIGNALED(status))
+	{
+		fprintf(stderr, "scenario %d is killed by signal %d\n", arg, WTERMSIG(status));
+		return 0;
+	}
+	if(!WIFEXITED(status) || WEXITSTATUS(status)!=0)
+	{
+		fprintf(stderr, "scenario %d exited with %d\n", arg, WEXITSTATUS(status));
+		return 0;
+	}
+	return 1;
+}
+
+/**
+  * @brief  Sets probability of a frame to be lost by a receiver without any collision.
+  *
+  * @param	loss: 0 to 1.
+  * @retval NONE.
+  */
+void simSetLoss(double loss)
+{
+	simLoss = loss;
+}
+
+/**
+  * @brief  Node by index, in the order they are added.
+  *
+  * @param	index: 0 to simNodeCount()-1.
+  * @retval The node.
+  */
+NRF24_SimNode *simNode(int index)
+{
+	return &simNodes[index];
+}
+
+/**
+  * @brief  Number of nodes.
+  *
+  * @param	NONE.
+  * @retval Number of nodes.
+  */
+int simNodeCount()
+{
+	return simCount;
+}
+
+/**
+  * @brief  Random number of the simulation, the same on every run with the same seed.
+  *
+  * @param	NONE.
+  * @retval 0 to 32767.
+  */
+unsigned long simRandom()
+{
+	simSeed = simSeed*1103515245UL + 12345UL;
+	return (simSeed>>16) & 0x7FFF;
+}
+
+/**
+  * @}
+  */
+
+/** @defgroup nrf24L01p_sim Chip functions
+ *  @brief   Chip functions
+ *
+@verbatim
+ ===============================================================================
+						##### Chip functions  #####
+ ===============================================================================
+    [..]
+    Called by nRF24L01p_host.c of a node, at the time of the node. The node
+    is behind every event that is not done yet, so the chip is up to date.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Moves time of a node toward target, gives up the CPU when it reaches its limit.
+  *
+  * @param	node: Node of the caller.
+  * @param	target: Time in us.
+  * @retval NONE, time of node is target or it has given up the CPU and the caller has to check its interrupts.
+  */
+void simStep(NRF24_SimNode *node, double target)
+{
+	if(target>node->now)
+		node->now = (target<node->limit) ? target : node->limit;
+	if(node->now>=node->limit)
+	{
+		if(node->now>=simEnd)
+			node->parked = 1;
+		swapcontext(&node->context, &simMain);
+	}
+}
+
+/**
+  * @brief  Starts an SPI frame. A read instruction is done here, STATUS is shifted out for any other one.
+  *
+  * @param	node: Node of the caller.
+  * @param	ins: First byte of the frame.
+  * @param	data: Array of 32 byte, stores bytes shifted out after STATUS.
+  * @retval STATUS.
+  */
+unsigned char simSpiRead(NRF24_SimNode *node, unsigned char ins, unsigned char *data)
+{
+	NRF24_SimChip *chip = &node->chip;
+	unsigned char status = simStatus(chip);
+	unsigned char address = ins & 0x1F;
+	unsigned char i;
+
+	memset(data, 0, 32);
+	if(ins<W_REGISTER) //R_REGISTER
+	{
+		if(address==RX_ADDR_P0 || address==RX_ADDR_P1)
+			memcpy(data, chip->rxAddress[address-RX_ADDR_P0], 5);
+		else if(address==TX_ADDR)
+			memcpy(data, chip->txAddress, 5);
+		else if(address==STATUS)
+			data[0] = status;
+		else if(address==FIFO_STATUS)
+			data[0] = simFifoStatus(chip);
+		else if(address==OBSERVE_TX)
+			data[0] = (chip->plos<<4) | chip->arc;
+		else if(address==RPD)
+			data[0] = (chip->rpd==1 || simCarrier(node, node->now)) ? 1 : 0;
+		else if(address<sizeof(chip->reg))
+			data[0] = chip->reg[address];
+	}
+	else if(ins==R_RX_PAYLOAD && chip->rxCount>0)
+	{
+		memcpy(data, chip->rxFifo[0], chip->rxWidth[0]);
+		for(i=1;i<chip->rxCount;i++) //payload is deleted from RX FIFO after it is read
+		{
+			memcpy(chip->rxFifo[i-1], chip->rxFifo[i], 32);
+			chip->rxWidth[i-1] = chip->rxWidth[i];
+			chip->rxPipe[i-1] = chip->rxPipe[i];
+		}
+		chip->rxCount--;
+	}
+	else if(ins==R_RX_PL_WID && chip->rxCount>0)
+	{
+		data[0] = chip->rxWidth[0];
+	}
+	return status;
+}
+
+/**
+  * @brief  Ends an SPI frame of a write instruction.
+  *
+  * @param	node: Node of the caller.
+  * @param	ins: First byte of the frame.
+  * @param	data: Bytes after instruction, in the order they are sent.
+  * @param	length: Number of bytes after instruction.
+  * @retval NONE.
+  */
+void simSpiWrite(NRF24_SimNode *node, unsigned char ins, unsigned char *data, unsigned char length)
+{
+	NRF24_SimChip *chip = &node->chip;
+	unsigned char address = ins & 0x1F;
+	unsigned char kind;
+
+	if(ins>=W_REGISTER && ins<0x40)
+	{
+		if(length==0)
+			return;
+		if(address==STATUS)
+			chip->reg[STATUS] &= ~(data[0]&0x70); //write 1 to clear
+		else if(address==RX_ADDR_P0 || address==RX_ADDR_P1)
+			memcpy(chip->rxAddress[address-RX_ADDR_P0], data, (length<5) ? length : 5);
+		else if(address==TX_ADDR)
+			memcpy(chip->txAddress, data, (length<5) ? length : 5);
+		else if(address==CONFIG)
+		{
+			if((data[0]&0x02) && !(chip->reg[CONFIG]&0x02))
+				chip->poweredAt = node->now + NRF24_SIM_POWER_UP;
+			else if(!(data[0]&0x02))
+				chip->poweredAt = NRF24_SIM_NEVER;
+			chip->reg[CONFIG] = data[0];
+		}
+		else if(address<sizeof(chip->reg) && address!=OBSERVE_TX && address!=RPD && address!=FIFO_STATUS) //read only
+		{
+			chip->reg[address] = data[0];
+			if(address==RF_CH)
+				chip->plos = 0;
+		}
+	}
+	else if((ins==W_TX_PAYLOAD || ins==W_TX_PAYLOAD_NOACK || (ins&0xF8)==W_ACK_PAYLOAD) && length>0 && length<=32)
+	{
+		if(ins==W_TX_PAYLOAD)
+			kind = 0;
+		else if(ins==W_TX_PAYLOAD_NOACK)
+			kind = 1;
+		else
+			kind = 2 + (ins&0x07);
+		if((kind==1 && !(chip->reg[FEATURE]&0x01)) || (kind>=2 && !(chip->reg[FEATURE]&0x02)))
+			return; //EN_DYN_ACK or EN_ACK_PAY is not set, instruction is not known
+		if(chip->txCount<3)
+		{
+			memcpy(chip->txFifo[chip->txCount], data, length);
+			chip->txWidth[chip->txCount] = length;
+			chip->txKind[chip->txCount] = kind;
+			chip->txCount++;
+		}
+		if(kind<2)
+			chip->reuse = 0;
+	}
+	else if(ins==FLUSH_TX)
+	{
+		chip->txCount = 0;
+		chip->reuse = 0;
+		chip->newPacket = 1;
+		if(chip->txBusy==1) //frame on air is finished, its result is lost
+		{
+			chip->txBusy = 0;
+			chip->txGeneration++;
+		}
+	}
+	else if(ins==FLUSH_RX)
+	{
+		chip->rxCount = 0;
+	}
+	else if(ins==REUSE_TX_PL)
+	{
+		if(chip->txCount>0)
+			chip->reuse = 1;
+	}
+	simUpdate(node, node->now);
+}
+
+/**
+  * @brief  Drives CE of the chip of a node.
+  *
+  * @param	node: Node of the caller.
+  * @param	level: 1: high, 0: low.
+  * @retval NONE.
+  */
+void simSetCe(NRF24_SimNode *node, bool level)
+{
+	node->chip.ce = level;
+	simUpdate(node, node->now);
+}
+
+/**
+  * @brief  Level of IRQ of the chip of a node.
+  *
+  * @param	node: Node of the caller.
+  * @retval 1: IRQ is low, an unmasked flag is set.
+  */
+bool simIrq(NRF24_SimNode *node)
+{
+	return (node->chip.reg[STATUS] & ~node->chip.reg[CONFIG] & 0x70)!=0; //MASK_x bits of CONFIG are at the same place as the flags
+}
+
+/**
+  * @}
+  */
+
+/*
+ * coroutine of a node, it is parked when its program returns
+ */
+void simStart(int index)
+{
+	NRF24_SimNode *node = &simNodes[index];
+
+	node->entry(node);
+	node->parked = 1;
+	while(1)
+		swapcontext(&node->context, &simMain);
+}
+
+void simSchedule(double time, unsigned char type, int node, unsigned long frame, unsigned int generation, int peer, unsigned char pipe)
+{
+	SimEvent event;
+	SimEvent swap;
+	int i = simEventCount;
+
+	if(simEventCount>=SIM_EVENTS)
+	{
+		printf("simulator: too many events\n");
+		exit(1);
+	}
+	event.time = time;
+	event.order = simEventOrder++;
+	event.type = type;
+	event.node = node;
+	event.frame = frame;
+	event.generation = generation;
+	event.peer = peer;
+	event.pipe = pipe;
+	simEvents[simEventCount++] = event;
+	while(i>0 && (simEvents[(i-1)/2].time>simEvents[i].time ||
+		(simEvents[(i-1)/2].time==simEvents[i].time && simEvents[(i-1)/2].order>simEvents[i].order)))
+	{
+		swap = simEvents[i];
+		simEvents[i] = simEvents[(i-1)/2];
+		simEvents[(i-1)/2] = swap;
+		i = (i-1)/2;
+	}
+	if(simCurrent!=NULL && time<simCurrent->limit) //running node stops at its own event
+		simCurrent->limit = time;
+}
+
+void simPop(SimEvent *event)
+{
+	SimEvent swap;
+	int i = 0;
+	int child;
+
+	*event = simEvents[0];
+	simEvents[0] = simEvents[--simEventCount];
+	while(1)
+	{
+		child = 2*i+1;
+		if(child>=simEventCount)
+			break;
+		if(child+1<simEventCount && (simEvents[child+1].time<simEvents[child].time ||
+			(simEvents[child+1].time==simEvents[child].time && simEvents[child+1].order<simEvents[child].order)))
+			child++;
+		if(simEvents[i].time<simEvents[child].time ||
+			(simEvents[i].time==simEvents[child].time && simEvents[i].order<simEvents[child].order))
+			break;
+		swap = simEvents[i];
+		simEvents[i] = simEvents[child];
+		simEvents[child] = swap;
+		i = child;
+	}
+}
+
+void simProcess(SimEvent *event)
+{
+	NRF24_SimNode *node = &simNodes[event->node];
+	NRF24_SimChip *chip = &node->chip;
+	SimFrame *frame = &simFrames[event->frame % SIM_FRAMES];
+	int i;
+
+	switch(event->type)
+	{
+		case SIM_TX_START:
+			if(event->generation==chip->txGeneration)
+				simTxStart(node, event->time);
+		break;
+
+		case SIM_TX_END:
+			simCollide(frame);
+			for(i=0;i<simCount;i++) //a frame is on air even if its sender has aborted
+				if(i!=event->node)
+					simHear(&simNodes[i], frame, event->generation);
+			if(event->generation!=chip->txGeneration)
+				break;
+			if(frame->noAck==0 && (chip->reg[EN_AA]&0x01)) //wait for ACK on pipe 0
+			{
+				chip->ackDeadline = event->time + ((chip->reg[SETUP_RETR]>>4)+1)*250.0;
+				simSchedule(chip->ackDeadline, SIM_ACK_TIMEOUT, event->node, 0, chip->txGeneration, 0, 0);
+			}
+			else
+				simTxDone(node, event->time);
+		break;
+
+		case SIM_ACK_START:
+			simAckStart(node, event);
+		break;
+
+		case SIM_ACK_END:
+			simAckEnd(event);
+		break;
+
+		case SIM_ACK_TIMEOUT:
+			if(event->generation!=chip->txGeneration)
+				break;
+			if(chip->tries>=(chip->reg[SETUP_RETR]&0x0F))
+			{
+				chip->reg[STATUS] |= 0x10; //MAX_RT, packet stays in TX FIFO
+				chip->arc = chip->tries;
+				if(chip->plos<15)
+					chip->plos++;
+				chip->txBusy = 0;
+				chip->txGeneration++;
+			}
+			else
+			{
+				chip->tries++; //retransmit ARD after the end of last try
+				simTxStart(node, event->time);
+			}
+		break;
+	}
+}
+
+void simChipReset(NRF24_SimChip *chip)
+{
+	memset(chip, 0, sizeof(NRF24_SimChip));
+	chip->reg[CONFIG] = 0x08;
+	chip->reg[EN_AA] = 0x3F;
+	chip->reg[EN_RXADDR] = 0x03;
+	chip->reg[SETUP_AW] = 0x03;
+	chip->reg[SETUP_RETR] = 0x03;
+	chip->reg[RF_CH] = 0x02;
+	chip->reg[RF_SETUP] = 0x0E;
+	chip->reg[0x0C] = 0xC3; //RX_ADDR_P2 to P5
+	chip->reg[0x0D] = 0xC4;
+	chip->reg[0x0E] = 0xC5;
+	chip->reg[0x0F] = 0xC6;
+	memset(chip->rxAddress[0], 0xE7, 5);
+	memset(chip->rxAddress[1], 0xC2, 5);
+	memset(chip->txAddress, 0xE7, 5);
+	chip->poweredAt = NRF24_SIM_NEVER;
+	chip->listenFrom = NRF24_SIM_NEVER;
+	chip->newPacket = 1;
+	chip->lastPid = 0xFF;
+}
+
+unsigned char simStatus(NRF24_SimChip *chip)
+{
+	unsigned char status = chip->reg[STATUS] & 0x70;
+
+	status |= (chip->rxCount>0) ? (chip->rxPipe[0]<<1) : 0x0E; //RX_P_NO, 7: RX FIFO empty
+	status |= (chip->txCount==3) ? 0x01 : 0x00; //TX_FULL
+	return status;
+}
+
+unsigned char simFifoStatus(NRF24_SimChip *chip)
+{
+	return (chip->reuse ? 0x40 : 0x00) | (chip->txCount==3 ? 0x20 : 0x00) | (chip->txCount==0 ? 0x10 : 0x00) |
+		(chip->rxCount==3 ? 0x02 : 0x00) | (chip->rxCount==0 ? 0x01 : 0x00);
+}
+
+/*
+ * CRC is forced on when any pipe has auto ACK
+ */
+unsigned char simCrcBytes(NRF24_SimChip *chip)
+{
+	if(!(chip->reg[CONFIG]&0x08) && !(chip->reg[EN_AA]&0x3F))
+		return 0;
+	return (chip->reg[CONFIG]&0x04) ? 2 : 1;
+}
+
+unsigned char simAddressWidth(NRF24_SimChip *chip)
+{
+	return (chip->reg[SETUP_AW]&0x03) + 2;
+}
+
+/*
+ * preamble, address, 9 bit packet control field, payload and CRC
+ */
+double simAirTime(unsigned char width, unsigned char size, unsigned char crc, unsigned char rate)
+{
+	double bits = (1+width+size+crc)*8 + 9;
+
+	if(rate&0x20)
+		return bits*4; //250Kbps
+	if(rate&0x08)
+		return bits/2; //2Mbps
+	return bits;
+}
+
+/*
+ * a frame of another node has been on the channel of a listening chip for NRF24_SIM_RPD
+ */
+bool simCarrier(NRF24_SimNode *node, double time)
+{
+	NRF24_SimChip *chip = &node->chip;
+	SimFrame *frame;
+	unsigned long n;
+
+	if(chip->listenFrom>time-NRF24_SIM_RPD)
+		return 0;
+	for(n=simFrameCount;n>0 && n+SIM_FRAMES>simFrameCount;n--)
+	{
+		frame = &simFrames[(n-1)%SIM_FRAMES];
+		if(frame->start<time-SIM_MAX_AIR)
+			break;
+		if(frame->from!=node->index && frame->channel==chip->reg[RF_CH] &&
+			frame->start<=time-NRF24_SIM_RPD && frame->end>time)
+			return 1;
+	}
+	return 0;
+}
+
+/*
+ * enabled data pipe whose address is the one of a frame, -1 if none
+ */
+int simMatch(NRF24_SimChip *chip, unsigned char *address, unsigned char width)
+{
+	unsigned char pipe;
+
+	for(pipe=0;pipe<6;pipe++)
+	{
+		if(!(chip->reg[EN_RXADDR]&(1<<pipe)))
+			continue;
+		if(pipe<2)
+		{
+			if(memcmp(chip->rxAddress[pipe], address, width)==0)
+				return pipe;
+		}
+		else if(chip->reg[RX_ADDR_P0+pipe]==address[0] && memcmp(&chip->rxAddress[1][1], &address[1], width-1)==0)
+			return pipe; //LSByte of its own, the rest of pipe 1
+	}
+	return -1;
+}
+
+unsigned int simCrc(unsigned char *data, unsigned char size)
+{
+	unsigned int crc = 0xFFFF;
+	unsigned char i;
+	unsigned char bit;
+
+	for(i=0;i<size;i++)
+	{
+		crc ^= (unsigned int)data[i]<<8;
+		for(bit=0;bit<8;bit++)
+			crc = (crc&0x8000) ? ((crc<<1)^0x1021)&0xFFFF : (crc<<1)&0xFFFF;
+	}
+	return crc;
+}
+
+/*
+ * state of chip after a change of registers, FIFOs or CE
+ */
+void simUpdate(NRF24_SimNode *node, double time)
+{
+	NRF24_SimChip *chip = &node->chip;
+	bool powered = (chip->reg[CONFIG]&0x02)!=0;
+	bool prx = (chip->reg[CONFIG]&0x01)!=0;
+
+	if(chip->acking==0)
+	{
+		if(powered && prx && chip->ce)
+		{
+			if(chip->listenFrom==NRF24_SIM_NEVER)
+			{
+				chip->listenFrom = ((time>chip->poweredAt) ? time : chip->poweredAt) + NRF24_SIM_SETTLE;
+				chip->rpd = 0;
+			}
+		}
+		else
+			chip->listenFrom = NRF24_SIM_NEVER;
+	}
+	if((powered==0 || prx) && chip->txBusy==1) //transmission is aborted
+	{
+		chip->txBusy = 0;
+		chip->txGeneration++;
+	}
+	simKick(node, time);
+}
+
+/*
+ * a PTX with CE high starts sending head of TX FIFO after settling
+ */
+void simKick(NRF24_SimNode *node, double time)
+{
+	NRF24_SimChip *chip = &node->chip;
+
+	if(chip->txBusy==1 || chip->ce==0 || chip->txCount==0 || chip->txKind[0]>=2)
+		return;
+	if((chip->reg[CONFIG]&0x03)!=0x02 || (chip->reg[STATUS]&0x10)) //PWR_UP and PTX, MAX_RT stops the TX FIFO
+		return;
+	chip->txBusy = 1;
+	chip->tries = 0;
+	simSchedule(((time>chip->poweredAt) ? time : chip->poweredAt) + NRF24_SIM_SETTLE, SIM_TX_START, node->index, 0, chip->txGeneration, 0, 0);
+}
+
+/*
+ * head of TX FIFO goes on air
+ */
+void simTxStart(NRF24_SimNode *node, double time)
+{
+	NRF24_SimChip *chip = &node->chip;
+	SimFrame *frame;
+
+	if(chip->txCount==0 || (chip->reg[CONFIG]&0x03)!=0x02)
+	{
+		chip->txBusy = 0;
+		return;
+	}
+	if(chip->newPacket==1) //PID of a retransmit or a reused packet stays the same
+	{
+		chip->pid = (chip->pid+1) & 0x03;
+		chip->newPacket = 0;
+	}
+	chip->arc = chip->tries;
+	chip->rpd = 0;
+
+	frame = simNewFrame(node, time);
+	memcpy(frame->address, chip->txAddress, 5);
+	memcpy(frame->data, chip->txFifo[0], chip->txWidth[0]);
+	frame->size = chip->txWidth[0];
+	frame->pid = chip->pid;
+	frame->noAck = (chip->txKind[0]==1);
+	frame->end = time + simAirTime(frame->width, frame->size, frame->crc, frame->rate);
+	simSchedule(frame->end, SIM_TX_END, node->index, simFrameCount-1, chip->txGeneration, 0, 0);
+}
+
+SimFrame *simNewFrame(NRF24_SimNode *node, double time)
+{
+	NRF24_SimChip *chip = &node->chip;
+	SimFrame *frame = &simFrames[simFrameCount % SIM_FRAMES];
+
+	memset(frame, 0, sizeof(SimFrame));
+	frame->from = node->index;
+	frame->to = -1;
+	frame->start = time;
+	frame->channel = chip->reg[RF_CH];
+	frame->rate = chip->reg[RF_SETUP] & 0x28;
+	frame->crc = simCrcBytes(chip);
+	frame->width = simAddressWidth(chip);
+	chip->sent++;
+	simFrameCount++;
+	return frame;
+}
+
+/*
+ * frames overlapping on a channel are lost
+ */
+void simCollide(SimFrame *frame)
+{
+	SimFrame *other;
+	unsigned long n;
+
+	for(n=simFrameCount;n>0 && n+SIM_FRAMES>simFrameCount;n--)
+	{
+		other = &simFrames[(n-1)%SIM_FRAMES];
+		if(other->start<frame->start-SIM_MAX_AIR)
+			break;
+		if(other!=frame && other->channel==frame->channel && other->start<frame->end && other->end>frame->start)
+			frame->corrupt = 1;
+	}
+}
+
+/*
+ * end of a packet at a node, a listening PRX stores it and answers by an ACK
+ */
+void simHear(NRF24_SimNode *node, SimFrame *frame, unsigned int generation)
+{
+	NRF24_SimChip *chip = &node->chip;
+	unsigned char width;
+	unsigned int crc;
+	int pipe;
+
+	if(frame->corrupt || chip->listenFrom>frame->start || !(chip->reg[CONFIG]&0x01))
+		return;
+	if(chip->reg[RF_CH]!=frame->channel || (chip->reg[RF_SETUP]&0x28)!=frame->rate ||
+		simCrcBytes(chip)!=frame->crc || simAddressWidth(chip)!=frame->width)
+		return;
+	pipe = simMatch(chip, frame->address, frame->width);
+	if(pipe<0)
+		return;
+	if(simLoss>0 && simRandom()<simLoss*32768)
+		return;
+	width = ((chip->reg[FEATURE]&0x04) && (chip->reg[DYNPD]&(1<<pipe))) ? frame->size : chip->reg[RX_PW_P0+pipe];
+	if(width!=frame->size) //static width of pipe is not the size of packet, CRC fails
+		return;
+
+	crc = simCrc(frame->data, frame->size);
+	if(frame->pid!=chip->lastPid || crc!=chip->lastCrc) //a copy of last packet is acknowledged but not stored
+	{
+		if(chip->rxCount==3)
+		{
+			chip->overflows++; //packet is lost and not acknowledged
+			return;
+		}
+		memcpy(chip->rxFifo[chip->rxCount], frame->data, frame->size);
+		chip->rxWidth[chip->rxCount] = frame->size;
+		chip->rxPipe[chip->rxCount] = pipe;
+		chip->rxCount++;
+		chip->reg[STATUS] |= 0x40; //RX_DR
+		chip->received++;
+		chip->lastPid = frame->pid;
+		chip->lastCrc = crc;
+	}
+	chip->rpd = 1;
+
+	if(frame->noAck==0 && (chip->reg[EN_AA]&(1<<pipe)))
+	{
+		chip->acking = 1;
+		chip->listenFrom = NRF24_SIM_NEVER;
+		simSchedule(frame->end+NRF24_SIM_SETTLE, SIM_ACK_START, node->index, 0, generation, frame->from, pipe);
+	}
+}
+
+/*
+ * PRX sends an ACK, with the first ACK payload of the pipe if there is one
+ */
+void simAckStart(NRF24_SimNode *node, SimEvent *event)
+{
+	NRF24_SimChip *chip = &node->chip;
+	SimFrame *frame = simNewFrame(node, event->time);
+	unsigned char i;
+
+	if(event->pipe<2)
+		memcpy(frame->address, chip->rxAddress[event->pipe], 5);
+	else
+	{
+		memcpy(frame->address, chip->rxAddress[1], 5);
+		frame->address[0] = chip->reg[RX_ADDR_P0+event->pipe];
+	}
+	frame->to = event->peer;
+	for(i=0;i<chip->txCount;i++)
+	{
+		if(chip->txKind[i]==2+event->pipe)
+		{
+			memcpy(frame->data, chip->txFifo[i], chip->txWidth[i]);
+			frame->size = chip->txWidth[i];
+			simTxPop(chip, i);
+			break;
+		}
+	}
+	frame->end = event->time + simAirTime(frame->width, frame->size, frame->crc, frame->rate);
+	simSchedule(frame->end, SIM_ACK_END, node->index, simFrameCount-1, event->generation, event->peer, event->pipe);
+}
+
+/*
+ * end of an ACK, PRX listens again and the PTX it is for has sent its packet
+ */
+void simAckEnd(SimEvent *event)
+{
+	NRF24_SimNode *node = &simNodes[event->node];
+	NRF24_SimNode *peer = &simNodes[event->peer];
+	NRF24_SimChip *chip = &peer->chip;
+	SimFrame *frame = &simFrames[event->frame % SIM_FRAMES];
+
+	simCollide(frame);
+	node->chip.acking = 0;
+	if(frame->size>0)
+		node->chip.reg[STATUS] |= 0x20; //TX_DS of PRX, ACK payload is sent
+	simUpdate(node, event->time); //back to RX after settling
+
+	if(chip->txBusy==0 || event->generation!=chip->txGeneration || event->time>chip->ackDeadline || frame->corrupt)
+		return;
+	if(chip->reg[RF_CH]!=frame->channel || (chip->reg[RF_SETUP]&0x28)!=frame->rate || simCrcBytes(chip)!=frame->crc ||
+		simAddressWidth(chip)!=frame->width || !(chip->reg[EN_RXADDR]&0x01) || memcmp(chip->rxAddress[0], frame->address, frame->width)!=0)
+		return; //ACK is heard on pipe 0
+	if(simLoss>0 && simRandom()<simLoss*32768)
+		return;
+
+	if(frame->size>0 && chip->rxCount<3) //ACK payload
+	{
+		memcpy(chip->rxFifo[chip->rxCount], frame->data, frame->size);
+		chip->rxWidth[chip->rxCount] = frame->size;
+		chip->rxPipe[chip->rxCount] = 0;
+		chip->rxCount++;
+		chip->reg[STATUS] |= 0x40; //RX_DR
+		chip->received++;
+	}
+	chip->rpd = 1;
+	simTxDone(peer, event->time);
+}
+
+/*
+ * packet is sent, next one follows if CE is still high
+ */
+void simTxDone(NRF24_SimNode *node, double time)
+{
+	NRF24_SimChip *chip = &node->chip;
+
+	chip->arc = chip->tries;
+	chip->reg[STATUS] |= 0x20; //TX_DS
+	chip->txBusy = 0;
+	chip->txGeneration++;
+	if(chip->reuse==0)
+	{
+		simTxPop(chip, 0);
+		chip->newPacket = 1;
+	}
+	simKick(node, time);
+}
+
+void simTxPop(NRF24_SimChip *chip, unsigned char index)
+{
+	unsigned char i;
+
+	for(i=index+1;i<chip->txCount;i++)
+	{
+		memcpy(chip->txFifo[i-1], chip->txFifo[i], 32);
+		chip->txWidth[i-1] = chip->txWidth[i];
+		chip->txKind[i-1] = chip->txKind[i];
+	}
+	chip->txCount--;
+}
@@ -0,0 +1,131 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_sim.h
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Header file of nRF24L01p_sim.c module.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NRF24L01P_SIM_H
+#define __NRF24L01P_SIM_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <ucontext.h>
+
+#define NRF24_SIM_MAX_NODES 32
+#define NRF24_SIM_STACK 65536 //byte of stack of each node
+#define NRF24_SIM_NEVER 1e18
+
+#define NRF24_SIM_SETTLE 130.0 //us, standby to TX or RX, and RX to TX for an ACK
+#define NRF24_SIM_POWER_UP 1500.0 //us, power down to standby
+#define NRF24_SIM_SPI_BYTE 2.0 //us, 8 bits at 4MHz as in TestAtmega88.c
+#define NRF24_SIM_POLL 1.0 //us, a read of the clock and the loop around it
+#define NRF24_SIM_PIN 0.25 //us, a read of IRQ pin
+#define NRF24_SIM_ISR 4.0 //us, entry and exit of an interrupt service routine
+#define NRF24_SIM_RPD 40.0 //us, carrier has to be on air so long before RPD is set
+
+/* Exported types ------------------------------------------------------------*/
+
+/** 
+  * @brief	Simulated Chip. Registers, FIFOs and ShockBurst state of one nrf24.
+  */
+typedef struct {
+    unsigned char reg[0x1E]; //one byte registers, indexed by address
+    unsigned char rxAddress[2][5]; //RX_ADDR_P0 and RX_ADDR_P1, in the order they are sent (LSByte first)
+    unsigned char txAddress[5];
+    unsigned char rxFifo[3][32];
+    unsigned char rxWidth[3];
+    unsigned char rxPipe[3];
+    unsigned char rxCount; //packets are kept in the order they are read
+    unsigned char txFifo[3][32];
+    unsigned char txWidth[3];
+    unsigned char txKind[3]; //0: packet, 1: NOACK packet, 2+pipe: ACK payload
+    unsigned char txCount; //packets are kept in the order they are sent
+    bool reuse; //REUSE_TX_PL is active
+    bool ce;
+    double poweredAt; //standby is reached, NRF24_SIM_NEVER while powered down
+    double listenFrom; //RX mode is settled, NRF24_SIM_NEVER while not listening
+    bool acking; //receiver is sending an ACK
+    bool txBusy; //a packet of TX FIFO is being sent, from settling to its result
+    unsigned int txGeneration; //events of an aborted transmission are ignored
+    unsigned char tries; //transmissions of current packet
+    unsigned char pid; //packet identity of current packet
+    bool newPacket; //next transmission is a new packet, not a retransmit
+    double ackDeadline; //end of ACK wait of last transmission
+    unsigned char lastPid; //PID and CRC of last received packet, a copy of it is not stored again
+    unsigned int lastCrc;
+    bool rpd; //latched when a packet is received
+    unsigned char plos; //OBSERVE_TX
+    unsigned char arc;
+    unsigned long sent; //frames put on air, ACKs included
+    unsigned long received; //packets stored in RX FIFO
+    unsigned long overflows; //packets lost because RX FIFO was full
+} NRF24_SimChip;
+
+/** 
+  * @brief	Simulated Node. An MCU running its own copy of the driver, with its chip.
+  */
+typedef struct NRF24_SimNode {
+    int index;
+    int arg; //given to hostMain() of the node
+    double now; //us, time of the MCU of the node
+    double limit; //node runs till now reaches limit, then other nodes and the air catch up
+    bool parked; //node is past end of the run or its program has returned
+    NRF24_SimChip chip;
+    ucontext_t context;
+    char *stack;
+    void (*entry)(struct NRF24_SimNode *node);
+} NRF24_SimNode;
+
+typedef void (*NRF24_SimEntry)(NRF24_SimNode *node);
+
+/* Exported functions --------------------------------------------------------*/
+
+/* Simulator functions *******************************************************/
+void simInit(unsigned long seed);
+NRF24_SimNode *simAddNode(NRF24_SimEntry entry, int arg);
+void simRun(double end);
+void simStop();
+bool simIsolated(void (*scenario)(int arg), int arg);
+void simSetLoss(double loss);
+NRF24_SimNode *simNode(int index);
+int simNodeCount();
+unsigned long simRandom();
+
+/* Node functions, called by nRF24L01p_host.c of each node ******************/
+void simStep(NRF24_SimNode *node, double target);
+unsigned char simSpiRead(NRF24_SimNode *node, unsigned char ins, unsigned char *data);
+void simSpiWrite(NRF24_SimNode *node, unsigned char ins, unsigned char *data, unsigned char length);
+void simSetCe(NRF24_SimNode *node, bool level);
+bool simIrq(NRF24_SimNode *node);
+
+/* Nodes of the program, listed by nRF24L01p_host.sh */
+extern NRF24_SimEntry simEntries[];
+extern int simEntryCount;
+
+#endif
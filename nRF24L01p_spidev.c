@@ -0,0 +1,726 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_spidev.c
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Linux spidev backend of nrf24L01p.
+  *    
+  *         This file provides firmware functions to manage the following 
+  *         functionalities of a nrf24 on a Linux board
+  *           + Initialization and configuration functions
+  *           + Input and Output operation functions
+  @verbatim     
+  ==============================================================================      
+                        ##### How to use this driver #####
+  ============================================================================== 
+  [..]
+   (#) Open the radio by spidevOpen() with the spidev device, the GPIO chip
+	   and the lines of CE and IRQ, e.g. "/dev/spidev0.0", "/dev/gpiochip0".
+	   For tests without hardware, spidevAttach() takes the sockets of an
+	   emulated chip made by emuStart() of nRF24L01p_emu.c.
+
+   (#) Configure it by spidevConfig() as transmitter or receiver. Address,
+	   CRC and dynamic payload length are the defaults of nRF_Config(), so
+	   the radio talks to AVR nodes of this driver.
+
+   (#) Receiver waits for IRQ by spidevWaitIrq() and reads packets by
+	   spidevReceive() while spidevRxPending() is 1. Transmitter uploads by
+	   spidevSend() and reads the result by spidevTxStatus() after IRQ.
+
+   (#) A sniffer uses spidevConfigPromiscuous() instead, it receives frames
+	   of any address as raw bits, see nRF24L01p_capture.c.
+
+     *** Batching ***    
+     =================================== 
+    [..]
+	  Every command of a sequence is one CSN frame (spi_ioc_transfer) and
+	  the whole sequence is one SPI_IOC_MESSAGE ioctl. A received packet is
+	  clear flags + R_RX_PL_WID + R_RX_PAYLOAD + FIFO_STATUS in one syscall,
+	  instead of one syscall per command. spidevSetBatching(radio, 0) sends
+	  every command alone, to measure the difference.
+  
+  @endverbatim
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p.h>
+#include <nRF24L01p_spidev.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/gpio.h>
+
+/* Private define ------------------------------------------------------------*/
+#define R_REGISTER 0x00
+#define W_REGISTER 0x20
+#define R_RX_PAYLOAD 0x61
+#define W_TX_PAYLOAD 0xA0
+#define FLUSH_TX 0xE1
+#define FLUSH_RX 0xE2
+#define R_RX_PL_WID 0x60
+
+#define CONFIG 0x00
+#define EN_AA 0x01
+#define EN_RXADDR 0x02
+#define SETUP_AW 0x03
+#define RF_CH 0x05
+#define RF_SETUP 0x06
+#define STATUS 0x07
+#define RPD 0x09
+#define RX_ADDR_P0 0x0A
+#define RX_ADDR_P1 0x0B
+#define TX_ADDR 0x10
+#define RX_PW_P0 0x11
+#define RX_PW_P1 0x12
+#define FIFO_STATUS 0x17
+#define DYNPD 0x1C
+#define FEATURE 0x1D
+
+/* Private variables ---------------------------------------------------------*/
+unsigned char spidevAddress[5] = {0x00,0x01,0x03,0x07,0x00}; //Base_Addrs of nRF24L01p.c
+unsigned char spidevNoise[2][2] = {{0x00,0xAA},{0x00,0x55}}; //addresses of promiscuous mode, preamble after noise
+
+/* Private function prototypes -----------------------------------------------*/
+unsigned char spidevCommand(NRF24_Spidev *radio, unsigned char ins, char *data, unsigned char size);
+bool spidevFlush(NRF24_Spidev *radio);
+bool spidevRun(NRF24_Spidev *radio, unsigned char first, unsigned char count);
+bool spidevSetCe(NRF24_Spidev *radio, bool level);
+unsigned char spidevRfSetup(NRF24_BaudRate rate);
+
+/** @defgroup nrf24L01p_spidev Initialization and configuration functions
+ *  @brief   Initialization and configuration functions
+ *
+@verbatim
+ ===============================================================================
+             ##### Initialization and configuration functions  #####
+ ===============================================================================
+    [..]
+    CE is a GPIO line handle and IRQ a GPIO line event of the GPIO character
+    device, so IRQ is waited for by poll() without busy polling a pin.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Opens spidev and requests CE and IRQ lines.
+  *
+  * @param	radio: Radio to open.
+  * @param	spiPath: spidev device, e.g. "/dev/spidev0.0".
+  * @param	chipPath: GPIO chip of CE and IRQ, e.g. "/dev/gpiochip0".
+  * @param	ceLine: Line offset of CE.
+  * @param	irqLine: Line offset of IRQ.
+  * @retval 1: opened, 0: failed (errno tells why).
+  */
+bool spidevOpen(NRF24_Spidev *radio, char *spiPath, char *chipPath, unsigned int ceLine, unsigned int irqLine)
+{
+	struct gpiohandle_request ce;
+	struct gpioevent_request irq;
+	unsigned char spiMode = SPI_MODE_0;
+	unsigned char bits = 8;
+	unsigned int speed = NRF24_SPIDEV_SPEED;
+	int chipFd;
+
+	memset(radio, 0, sizeof(NRF24_Spidev));
+	radio->ceFd = -1;
+	radio->irqFd = -1;
+	radio->batching = 1;
+
+	radio->spiFd = open(spiPath, O_RDWR);
+	if(radio->spiFd<0)
+		return 0;
+	if(ioctl(radio->spiFd, SPI_IOC_WR_MODE, &spiMode)<0 || ioctl(radio->spiFd, SPI_IOC_WR_BITS_PER_WORD, &bits)<0 ||
+		ioctl(radio->spiFd, SPI_IOC_WR_MAX_SPEED_HZ, &speed)<0)
+	{
+		spidevClose(radio);
+		return 0;
+	}
+
+	chipFd = open(chipPath, O_RDWR);
+	if(chipFd<0)
+	{
+		spidevClose(radio);
+		return 0;
+	}
+
+	memset(&ce, 0, sizeof(ce));
+	ce.lineoffsets[0] = ceLine;
+	ce.lines = 1;
+	ce.flags = GPIOHANDLE_REQUEST_OUTPUT;
+	ce.default_values[0] = 0; //Standby-I
+	strcpy(ce.consumer_label, "nrf24-ce");
+
+	memset(&irq, 0, sizeof(irq));
+	irq.lineoffset = irqLine;
+	irq.handleflags = GPIOHANDLE_REQUEST_INPUT;
+	irq.eventflags = GPIOEVENT_REQUEST_FALLING_EDGE; //IRQ is active low
+	strcpy(irq.consumer_label, "nrf24-irq");
+
+	if(ioctl(chipFd, GPIO_GET_LINEHANDLE_IOCTL, &ce)==0)
+		radio->ceFd = ce.fd;
+	if(ioctl(chipFd, GPIO_GET_LINEEVENT_IOCTL, &irq)==0)
+		radio->irqFd = irq.fd;
+	close(chipFd); //requested lines stay valid
+
+	if(radio->ceFd<0 || radio->irqFd<0)
+	{
+		spidevClose(radio);
+		return 0;
+	}
+	return 1;
+}
+
+/**
+  * @brief  Uses a fake spidev, e.g. sockets of an emulated chip, instead of a device.
+  *
+  * @param	radio: Radio to open.
+  * @param	spiFd: Seqpacket socket that takes NRF24_FAKE_XFER and NRF24_FAKE_CE messages.
+  * @param	irqFd: Socket that gets one byte on each falling edge of IRQ.
+  * @retval NONE.
+  */
+void spidevAttach(NRF24_Spidev *radio, int spiFd, int irqFd)
+{
+	memset(radio, 0, sizeof(NRF24_Spidev));
+	radio->spiFd = spiFd;
+	radio->ceFd = -1;
+	radio->irqFd = irqFd;
+	radio->fake = 1;
+	radio->batching = 1;
+}
+
+/**
+  * @brief  Releases spidev and GPIO lines, sockets of a fake spidev belong to the emulator.
+  *
+  * @param	radio: Radio to close.
+  * @retval NONE.
+  */
+void spidevClose(NRF24_Spidev *radio)
+{
+	if(radio->fake==0)
+	{
+		if(radio->spiFd>=0)
+			close(radio->spiFd);
+		if(radio->ceFd>=0)
+			close(radio->ceFd);
+		if(radio->irqFd>=0)
+			close(radio->irqFd);
+	}
+	radio->spiFd = -1;
+	radio->ceFd = -1;
+	radio->irqFd = -1;
+}
+
+/**
+  * @brief  Configures the radio like nRF_Config() does, by one batch of register writes.
+  *
+  * @param	radio: Radio to configure.
+  * @param	mode: Mode of operation, Transmitter or Receiver.
+  * @param	channel: RF channel, 0 to 125.
+  * @param	rate: Data rate.
+  * @retval 1: configured, 0: SPI failed.
+  */
+bool spidevConfig(NRF24_Spidev *radio, Mode mode, unsigned char channel, NRF24_BaudRate rate)
+{
+	char data[5];
+	struct timespec wait;
+
+	if(spidevSetCe(radio, 0)==0)
+		return 0;
+	radio->mode = mode;
+	radio->rxPending = 0;
+	radio->channel = (channel<=125) ? channel : 1;
+	radio->rate = rate;
+	radio->width = 0;
+
+	data[0] = 0x0C; //CRC 2 byte, power down
+	spidevCommand(radio, W_REGISTER+CONFIG, data, 1);
+	data[0] = 0x00; //auto ACK disabled
+	spidevCommand(radio, W_REGISTER+EN_AA, data, 1);
+	data[0] = 0x01; //data pipe 0
+	spidevCommand(radio, W_REGISTER+EN_RXADDR, data, 1);
+	data[0] = 0x01; //3 byte address
+	spidevCommand(radio, W_REGISTER+SETUP_AW, data, 1);
+	data[0] = radio->channel;
+	spidevCommand(radio, W_REGISTER+RF_CH, data, 1);
+	data[0] = spidevRfSetup(rate);
+	spidevCommand(radio, W_REGISTER+RF_SETUP, data, 1);
+	memcpy(data, spidevAddress, 5);
+	spidevCommand(radio, W_REGISTER+RX_ADDR_P0, data, 5);
+	spidevCommand(radio, W_REGISTER+TX_ADDR, data, 5);
+	data[0] = 0x01; //dynamic payload length on pipe 0
+	spidevCommand(radio, W_REGISTER+DYNPD, data, 1);
+	data[0] = 0x04; //EN_DPL
+	spidevCommand(radio, W_REGISTER+FEATURE, data, 1);
+	data[0] = 0x70; //clear interrupt flags
+	spidevCommand(radio, W_REGISTER+STATUS, data, 1);
+	spidevCommand(radio, FLUSH_TX, NULL, 0);
+	spidevCommand(radio, FLUSH_RX, NULL, 0);
+	if(mode==NRF24_TRANSMITTER)
+		data[0] = 0x40 | 0x0C | 0x02; //mask RX_DR, CRC 2 byte, PWR_UP, PTX
+	else
+		data[0] = 0x30 | 0x0C | 0x03; //mask TX_DS and MAX_RT, CRC 2 byte, PWR_UP, PRX
+	spidevCommand(radio, W_REGISTER+CONFIG, data, 1);
+	if(spidevFlush(radio)==0)
+		return 0;
+
+	wait.tv_sec = 0;
+	wait.tv_nsec = (NRF24_TPD2STBY+NRF24_TSTBY2A)*1000L; //crystal start up and settling
+	nanosleep(&wait, NULL);
+
+	//CE stays high: receiver listens, transmitter sends as soon as a packet is uploaded
+	return spidevSetCe(radio, 1);
+}
+
+/**
+  * @brief  Enables or Disables batching of commands.
+  *
+  * @param	radio: Radio.
+  * @param	param: 1: one SPI_IOC_MESSAGE per sequence, 0: one per command.
+  * @retval NONE.
+  */
+void spidevSetBatching(NRF24_Spidev *radio, bool param)
+{
+	radio->batching = param;
+}
+
+/**
+  * @brief  Configures the radio as a receiver of every frame on a channel, for packet capture.
+  *         Address width is 2 byte, which is not allowed by the datasheet (SETUP_AW 0), pipe 0 listens to
+  *         0x00,0xAA and pipe 1 to 0x00,0x55: noise before a preamble matches them, so frames of any address
+  *         are received. CRC and auto ACK are disabled and every packet is 32 byte of raw bits: the rest of the
+  *         preamble, address, packet control field, payload and CRC of the frame, then noise.
+  *
+  * @param	radio: Radio to configure.
+  * @param	channel: RF channel, 0 to 125.
+  * @param	rate: Data rate.
+  * @retval 1: configured, 0: SPI failed.
+  */
+bool spidevConfigPromiscuous(NRF24_Spidev *radio, unsigned char channel, NRF24_BaudRate rate)
+{
+	char data[2];
+	struct timespec wait;
+
+	if(spidevSetCe(radio, 0)==0)
+		return 0;
+	radio->mode = NRF24_RECEIVER;
+	radio->rxPending = 0;
+	radio->channel = (channel<=125) ? channel : 1;
+	radio->rate = rate;
+	radio->width = 32;
+
+	data[0] = 0x00; //CRC disabled, power down
+	spidevCommand(radio, W_REGISTER+CONFIG, data, 1);
+	data[0] = 0x00; //auto ACK disabled, a sniffer does not answer
+	spidevCommand(radio, W_REGISTER+EN_AA, data, 1);
+	data[0] = 0x03; //data pipes 0 and 1
+	spidevCommand(radio, W_REGISTER+EN_RXADDR, data, 1);
+	data[0] = 0x00; //2 byte address
+	spidevCommand(radio, W_REGISTER+SETUP_AW, data, 1);
+	data[0] = radio->channel;
+	spidevCommand(radio, W_REGISTER+RF_CH, data, 1);
+	data[0] = spidevRfSetup(rate);
+	spidevCommand(radio, W_REGISTER+RF_SETUP, data, 1);
+	memcpy(data, spidevNoise[0], 2);
+	spidevCommand(radio, W_REGISTER+RX_ADDR_P0, data, 2);
+	memcpy(data, spidevNoise[1], 2);
+	spidevCommand(radio, W_REGISTER+RX_ADDR_P1, data, 2);
+	data[0] = 32; //static payload width, the longest frame
+	spidevCommand(radio, W_REGISTER+RX_PW_P0, data, 1);
+	spidevCommand(radio, W_REGISTER+RX_PW_P1, data, 1);
+	data[0] = 0x00; //dynamic payload length disabled
+	spidevCommand(radio, W_REGISTER+DYNPD, data, 1);
+	spidevCommand(radio, W_REGISTER+FEATURE, data, 1);
+	data[0] = 0x70; //clear interrupt flags
+	spidevCommand(radio, W_REGISTER+STATUS, data, 1);
+	spidevCommand(radio, FLUSH_TX, NULL, 0);
+	spidevCommand(radio, FLUSH_RX, NULL, 0);
+	data[0] = 0x30 | 0x03; //mask TX_DS and MAX_RT, CRC disabled, PWR_UP, PRX
+	spidevCommand(radio, W_REGISTER+CONFIG, data, 1);
+	if(spidevFlush(radio)==0)
+		return 0;
+
+	wait.tv_sec = 0;
+	wait.tv_nsec = (NRF24_TPD2STBY+NRF24_TSTBY2A)*1000L;
+	nanosleep(&wait, NULL);
+	return spidevSetCe(radio, 1);
+}
+
+/**
+  * @brief  Enables or Disables reading of RPD with each packet, one more transfer in the batch of spidevReceive().
+  *
+  * @param	radio: Radio.
+  * @param	param: 1: RPD is read, see spidevGetRpd(), 0: not read.
+  * @retval NONE.
+  */
+void spidevSetRpd(NRF24_Spidev *radio, bool param)
+{
+	radio->readRpd = param;
+	radio->rpd = 0;
+}
+
+/** @defgroup nrf24L01p_spidev Input and Output operation functions
+ *  @brief   Input and Output operation functions
+ *
+@verbatim
+ ===============================================================================
+				##### Input and Output operation functions  #####
+ ===============================================================================
+    [..]
+    Payloads are sent and read last byte first, as writeCommand() does, so
+    packets of AVR nodes arrive in the same order they were given to sendData().
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Waits for the falling edge of IRQ.
+  *
+  * @param	radio: Radio.
+  * @param	timeout: ms to wait, -1 waits forever.
+  * @retval 1: IRQ is received, 0: timeout or error.
+  */
+bool spidevWaitIrq(NRF24_Spidev *radio, int timeout)
+{
+	struct pollfd fd;
+	struct gpioevent_data event;
+	unsigned char edge;
+
+	fd.fd = radio->irqFd;
+	fd.events = POLLIN;
+	fd.revents = 0;
+	if(poll(&fd, 1, timeout)<=0)
+		return 0;
+
+	radio->stats.gpio++;
+	if(radio->fake==1)
+		return read(radio->irqFd, &edge, 1)==1;
+	return read(radio->irqFd, &event, sizeof(event))==sizeof(event);
+}
+
+/**
+  * @brief  Indicates if packets are left in RX FIFO after last spidevReceive(), they do not make a new IRQ edge.
+  *
+  * @param	radio: Radio.
+  * @retval 1: RX FIFO is not empty.
+  */
+bool spidevRxPending(NRF24_Spidev *radio)
+{
+	return radio->rxPending;
+}
+
+/**
+  * @brief  Reads one packet by one batch: clear flags, R_RX_PL_WID, R_RX_PAYLOAD and FIFO_STATUS.
+  *         32 bytes are read in a batch, extra bytes after the payload are ignored. Call it after IRQ or while
+  *         spidevRxPending() is 1, so RX FIFO is not empty when the batch starts. With a static payload width
+  *         (promiscuous mode) R_RX_PL_WID is not sent, with spidevSetRpd() RPD is read after the payload.
+  *
+  * @param	radio: Radio.
+  * @param	data: Array to store received packet, at least 32 byte.
+  * @param	pipe: Stores data pipe number of the packet, can be NULL.
+  * @retval Size of received packet, 0 if nothing is received.
+  */
+unsigned char spidevReceive(NRF24_Spidev *radio, char *data, unsigned char *pipe)
+{
+	char clear[1];
+	unsigned char status;
+	unsigned char widthIndex = 0;
+	unsigned char payloadIndex;
+	unsigned char rpdIndex = 0;
+	unsigned char fifoIndex;
+	unsigned char rxPipe;
+	unsigned char width;
+	unsigned char i;
+
+	clear[0] = 0x70;
+	status = spidevCommand(radio, W_REGISTER+STATUS, clear, 1); //clear first, a packet arriving later makes a new edge
+	width = 32; //in a batch width is not known yet
+	if(radio->width!=0)
+		width = radio->width;
+	else
+		widthIndex = spidevCommand(radio, R_RX_PL_WID, NULL, 1);
+	if(radio->width==0 && radio->batching==0 && radio->rx[widthIndex][1]>0 && radio->rx[widthIndex][1]<=32)
+		width = radio->rx[widthIndex][1];
+	payloadIndex = spidevCommand(radio, R_RX_PAYLOAD, NULL, width);
+	if(radio->readRpd==1)
+		rpdIndex = spidevCommand(radio, R_REGISTER+RPD, NULL, 1); //latched when the packet was received
+	fifoIndex = spidevCommand(radio, R_REGISTER+FIFO_STATUS, NULL, 1);
+	if(spidevFlush(radio)==0)
+		return 0;
+
+	radio->rxPending = (radio->rx[fifoIndex][1] & 0x01)==0; //RX_EMPTY
+	rxPipe = (radio->rx[status][0]>>1) & 0x07; //RX_P_NO before the read
+	if(rxPipe>5)
+		return 0;
+
+	if(radio->width==0)
+		width = radio->rx[widthIndex][1];
+	if(width==0 || width>32) //packet is corrupted
+	{
+		spidevCommand(radio, FLUSH_RX, NULL, 0);
+		spidevFlush(radio);
+		radio->rxPending = 0;
+		return 0;
+	}
+
+	for(i=0;i<width;i++)
+		data[i] = radio->rx[payloadIndex][width-i]; //LSByte first
+	if(pipe!=NULL)
+		*pipe = rxPipe;
+	if(radio->readRpd==1)
+		radio->rpd = radio->rx[rpdIndex][1] & 0x01;
+	radio->stats.received++;
+	return width;
+}
+
+/**
+  * @brief  Uploads a packet to TX FIFO by one batch, CE is high so it is sent at once.
+  *
+  * @param	radio: Radio configured as transmitter.
+  * @param	data: data to be sent.
+  * @param	size: size of data, 1 to 32.
+  * @retval 1: uploaded, 0: TX FIFO is full or SPI failed.
+  */
+bool spidevSend(NRF24_Spidev *radio, char *data, unsigned char size)
+{
+	unsigned char index;
+
+	if(size==0 || size>32)
+		return 0;
+
+	index = spidevCommand(radio, W_TX_PAYLOAD, data, size);
+	if(spidevFlush(radio)==0)
+		return 0;
+	if(radio->rx[index][0] & 0x01) //TX_FULL before the write, payload is ignored by nrf24
+		return 0;
+
+	radio->stats.sent++;
+	return 1;
+}
+
+/**
+  * @brief  Reads and clears TX flags, a failed packet is flushed.
+  *
+  * @param	radio: Radio configured as transmitter.
+  * @retval NRF24_TX_DELIVERED, NRF24_TX_MAX_RETRIES or NRF24_TX_PENDING.
+  */
+NRF24_TxStatus spidevTxStatus(NRF24_Spidev *radio)
+{
+	char clear[1];
+	unsigned char index;
+	unsigned char status;
+
+	clear[0] = 0x30; //TX_DS and MAX_RT
+	index = spidevCommand(radio, W_REGISTER+STATUS, clear, 1);
+	if(spidevFlush(radio)==0)
+		return NRF24_TX_UNKNOWN;
+
+	status = radio->rx[index][0];
+	if(status & 0x10) //MAX_RT, failed packet stays in TX FIFO till it is flushed
+	{
+		spidevCommand(radio, FLUSH_TX, NULL, 0);
+		spidevFlush(radio);
+		return NRF24_TX_MAX_RETRIES;
+	}
+	if(status & 0x20)
+		return NRF24_TX_DELIVERED;
+	return NRF24_TX_PENDING;
+}
+
+/**
+  * @brief  Tells RPD read with the last packet, if spidevSetRpd() is enabled.
+  *
+  * @param	radio: Radio.
+  * @retval 1: signal was stronger than -64dBm, 0: weaker or RPD is not read.
+  */
+bool spidevGetRpd(NRF24_Spidev *radio)
+{
+	return radio->rpd;
+}
+
+/**
+  * @brief  Copies counters of the radio.
+  *
+  * @param	radio: Radio.
+  * @param	stats: Stores the counters.
+  * @retval NONE.
+  */
+void spidevGetStats(NRF24_Spidev *radio, NRF24_SpidevStats *stats)
+{
+	*stats = radio->stats;
+}
+
+/**
+  * @brief  Adds a command to the batch, it is sent at once when batching is disabled.
+  *
+  * @param	radio: Radio.
+  * @param	ins: Instruction.
+  * @param	data: Bytes to write after instruction, NULL to read.
+  * @param	size: Number of bytes after instruction, 0 to 32.
+  * @retval Index of the command in rx, its first byte is STATUS.
+  */
+unsigned char spidevCommand(NRF24_Spidev *radio, unsigned char ins, char *data, unsigned char size)
+{
+	unsigned char index;
+	unsigned char i;
+
+	if(radio->count==NRF24_SPIDEV_MAX_XFERS)
+		spidevFlush(radio);
+	index = radio->count++;
+
+	radio->tx[index][0] = ins;
+	for(i=0;i<size;i++)
+		radio->tx[index][1+i] = (data!=NULL) ? data[size-1-i] : 0xFF; //LSByte first, NOP while reading
+	memset(&radio->xfer[index], 0, sizeof(struct spi_ioc_transfer));
+	radio->xfer[index].tx_buf = (unsigned long)radio->tx[index];
+	radio->xfer[index].rx_buf = (unsigned long)radio->rx[index];
+	radio->xfer[index].len = 1+size;
+	radio->xfer[index].speed_hz = NRF24_SPIDEV_SPEED;
+	radio->xfer[index].bits_per_word = 8;
+
+	if(radio->batching==0) //every command alone, answers stay where the caller reads them
+	{
+		if(spidevRun(radio, index, 1)==0)
+			radio->failed = 1;
+		radio->done = index+1;
+	}
+	return index;
+}
+
+/**
+  * @brief  Sends the commands that are not sent yet and starts a new batch.
+  *
+  * @param	radio: Radio.
+  * @retval 1: every command of the batch is sent, 0: failed.
+  */
+bool spidevFlush(NRF24_Spidev *radio)
+{
+	bool ok = (radio->failed==0);
+
+	if(radio->count>radio->done && spidevRun(radio, radio->done, radio->count-radio->done)==0)
+		ok = 0;
+	radio->count = 0;
+	radio->done = 0;
+	radio->failed = 0;
+	return ok;
+}
+
+/**
+  * @brief  Sends commands by one SPI_IOC_MESSAGE, CSN goes high between commands.
+  *
+  * @param	radio: Radio.
+  * @param	first: Index of first command.
+  * @param	count: Number of commands.
+  * @retval 1: sent, 0: failed.
+  */
+bool spidevRun(NRF24_Spidev *radio, unsigned char first, unsigned char count)
+{
+	unsigned char message[2+NRF24_SPIDEV_MAX_XFERS*34];
+	unsigned int length = 2;
+	unsigned int received = 0;
+	int answer;
+	unsigned char i;
+	bool ok;
+
+	if(radio->fake==1)
+	{
+		message[0] = NRF24_FAKE_XFER;
+		message[1] = count;
+		for(i=first;i<first+count;i++)
+		{
+			message[length++] = radio->xfer[i].len;
+			memcpy(&message[length], radio->tx[i], radio->xfer[i].len);
+			length += radio->xfer[i].len;
+		}
+		ok = send(radio->spiFd, message, length, 0)==(int)length;
+		answer = recv(radio->spiFd, message, sizeof(message), 0);
+		for(i=first;i<first+count && ok==1;i++)
+		{
+			memcpy(radio->rx[i], &message[received], radio->xfer[i].len);
+			received += radio->xfer[i].len;
+		}
+		ok = ok==1 && answer==(int)received;
+	}
+	else
+	{
+		for(i=first;i<first+count;i++)
+			radio->xfer[i].cs_change = (i+1<first+count); //CSN high between commands
+		ok = ioctl(radio->spiFd, SPI_IOC_MESSAGE(count), &radio->xfer[first])>=0;
+	}
+
+	radio->stats.batches++;
+	radio->stats.transfers += count;
+	for(i=first;i<first+count;i++)
+		radio->stats.bytes += radio->xfer[i].len;
+	return ok;
+}
+
+/**
+  * @brief  Drives CE.
+  *
+  * @param	radio: Radio.
+  * @param	level: 1: high, 0: low.
+  * @retval 1: done, 0: failed.
+  */
+bool spidevSetCe(NRF24_Spidev *radio, bool level)
+{
+	struct gpiohandle_data value;
+	unsigned char message[2];
+
+	radio->stats.gpio++;
+	if(radio->fake==1)
+	{
+		message[0] = NRF24_FAKE_CE;
+		message[1] = level;
+		return send(radio->spiFd, message, 2, 0)==2;
+	}
+
+	memset(&value, 0, sizeof(value));
+	value.values[0] = level;
+	return ioctl(radio->ceFd, GPIOHANDLE_SET_LINE_VALUES_IOCTL, &value)>=0;
+}
+
+/**
+  * @brief  RF_SETUP of a data rate at 0dBm.
+  *
+  * @param	rate: Data rate.
+  * @retval RF_SETUP value.
+  */
+unsigned char spidevRfSetup(NRF24_BaudRate rate)
+{
+	if(rate==NRF24_250Kbps)
+		return 0x06 | 0x20; //RF_DR_LOW
+	if(rate==NRF24_2Mbps)
+		return 0x06 | 0x08; //RF_DR_HIGH
+	return 0x06;
+}
@@ -0,0 +1,108 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_spidev.h
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Header file of Linux spidev backend of nrf24L01p.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NRF24L01P_SPIDEV_H
+#define __NRF24L01P_SPIDEV_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p.h>
+#include <linux/spi/spidev.h>
+
+#ifndef NRF24_SPIDEV_SPEED
+#define NRF24_SPIDEV_SPEED 8000000 //Hz, SPI clock, 10MHz is the maximum of nrf24
+#endif
+
+#define NRF24_SPIDEV_MAX_XFERS 16 //SPI transfers (CSN frames) in one SPI_IOC_MESSAGE batch
+
+#define NRF24_FAKE_XFER 0x01 //fake spidev message: [XFER, n, n x (length, bytes)], answer is the received bytes of all transfers
+#define NRF24_FAKE_CE 0x02 //fake spidev message: [CE, level], no answer
+
+/* Exported types ------------------------------------------------------------*/
+
+/** 
+  * @brief	Spidev Counters. Cost of the radio since it is opened.
+  */
+typedef struct {
+    unsigned long batches; //SPI_IOC_MESSAGE calls, one syscall each
+    unsigned long transfers; //CSN frames
+    unsigned long bytes; //bytes on SPI
+    unsigned long gpio; //CE writes and IRQ events read
+    unsigned long received; //packets returned by spidevReceive()
+    unsigned long sent; //packets uploaded by spidevSend()
+} NRF24_SpidevStats;
+
+/** 
+  * @brief	Spidev Radio. One nrf24 on a spidev device, the application keeps one per radio.
+  */
+typedef struct {
+    int spiFd; //spidev, or socket of fake spidev
+    int ceFd; //GPIO line handle of CE, -1 on fake spidev
+    int irqFd; //GPIO line event of IRQ (falling edge), or IRQ socket of fake spidev
+    bool fake; //spiFd is a fake spidev, see nRF24L01p_emu.c
+    bool batching; //commands are sent together by one SPI_IOC_MESSAGE
+    bool rxPending; //RX FIFO was not empty after last read
+    bool readRpd; //RPD is read with each packet
+    bool rpd; //RPD read with last packet
+    Mode mode;
+    unsigned char channel; //RF channel set by last configuration
+    NRF24_BaudRate rate; //data rate set by last configuration
+    unsigned char width; //payload width of every packet, 0: dynamic payload length
+    unsigned char count; //commands of current batch in xfer
+    unsigned char done; //commands of current batch that are sent already (batching disabled)
+    bool failed; //a command of current batch has failed
+    struct spi_ioc_transfer xfer[NRF24_SPIDEV_MAX_XFERS];
+    unsigned char tx[NRF24_SPIDEV_MAX_XFERS][33];
+    unsigned char rx[NRF24_SPIDEV_MAX_XFERS][33];
+    NRF24_SpidevStats stats;
+} NRF24_Spidev;
+
+/* Exported functions --------------------------------------------------------*/
+
+/* Initialization and configuration functions ********************************/
+bool spidevOpen(NRF24_Spidev *radio, char *spiPath, char *chipPath, unsigned int ceLine, unsigned int irqLine);
+void spidevAttach(NRF24_Spidev *radio, int spiFd, int irqFd);
+void spidevClose(NRF24_Spidev *radio);
+bool spidevConfig(NRF24_Spidev *radio, Mode mode, unsigned char channel, NRF24_BaudRate rate);
+void spidevSetBatching(NRF24_Spidev *radio, bool param);
+bool spidevConfigPromiscuous(NRF24_Spidev *radio, unsigned char channel, NRF24_BaudRate rate);
+void spidevSetRpd(NRF24_Spidev *radio, bool param);
+
+/* Input and Output operation functions **************************************/
+bool spidevWaitIrq(NRF24_Spidev *radio, int timeout);
+bool spidevRxPending(NRF24_Spidev *radio);
+unsigned char spidevReceive(NRF24_Spidev *radio, char *data, unsigned char *pipe);
+bool spidevSend(NRF24_Spidev *radio, char *data, unsigned char size);
+NRF24_TxStatus spidevTxStatus(NRF24_Spidev *radio);
+bool spidevGetRpd(NRF24_Spidev *radio);
+void spidevGetStats(NRF24_Spidev *radio, NRF24_SpidevStats *stats);
+
+#endif
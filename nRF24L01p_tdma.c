@@ -0,0 +1,365 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_tdma.c
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   TDMA slot scheduler over nrf24L01p driver.
+  *    
+  *         This file provides firmware functions to manage the following 
+  *         functionalities of many-to-one collection
+  *           + TDMA functions
+  @verbatim     
+  ==============================================================================      
+                        ##### How to use this driver #####
+  ============================================================================== 
+  [..]
+   (#) Both sides need a clock in us given to setTimestampSource(), e.g.
+	   timer 1 with overflow count. Configure the collector and every node
+	   as receiver by nRF_Config(), on the same channel and address.
+
+   (#) Collector: call tdmaStartCollector() with number of node slots, slot
+	   length and guard time, then tdmaService() in main loop. It sends a
+	   beacon at start of each frame and receives the rest of the time, read
+	   packets of nodes by readRxFIFO() or RX_READY events as before.
+
+   (#) Node: call tdmaStartNode() with the slot assigned to it (1 to
+	   slots), then tdmaService() in main loop. Packets are queued at any
+	   time by txEnqueue(), they are sent only inside the slot. Every packet
+	   received by a node is taken as beacon.
+
+     *** Frame ***    
+     =================================== 
+    [..]
+	  | slot 0: beacon | slot 1 | slot 2 | ... | slot n |
+	  Each node slot is guard + packets + guard. Guard has to cover jitter
+	  of tdmaService() calls, clock drift over a frame and the time on air
+	  of the last packet of slot. Slot 0 has to be longer than beacon
+	  upload, settling and time on air (about 600us at 1Mbps).
+  
+  @endverbatim
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <mega88a.h>
+#include <nRF24L01p.h>
+#include <nRF24L01p_tdma.h>
+#include <delay.h>
+
+/* Private define ------------------------------------------------------------*/
+#define TDMA_BEACON 0xB7 //first byte of beacon packet
+
+/* Private variables ---------------------------------------------------------*/
+NRF24_TdmaRole tdmaRole = NRF24_TDMA_OFF;
+unsigned char tdmaSlots = 0; //number of node slots in a frame, slot 0 is beacon
+unsigned int tdmaSlotTime = 0; //us
+unsigned int tdmaGuard = 0; //us
+unsigned char tdmaSlot = 0; //slot of this node
+unsigned char tdmaFrame = 0; //sequence number of current frame
+unsigned long tdmaFrameStart = 0; //local time of start of current frame
+unsigned long tdmaFrameLength = 0; //local us of a frame, corrected by drift on nodes
+unsigned long tdmaRemoteStart = 0; //collector time of last received beacon
+unsigned long tdmaLocalStart = 0; //node time of last received beacon
+unsigned char tdmaBeaconFrame = 0; //frame number of last received beacon
+unsigned char tdmaMissed = NRF24_TDMA_MAX_MISSED; //frames since last beacon, node is not synced till first beacon
+bool tdmaSlotOpen = 0; //node is transmitter in its slot
+NRF24_TdmaStats tdmaStats;
+
+/* Private function prototypes -----------------------------------------------*/
+void tdmaSendBeacon();
+void tdmaReceiveBeacon();
+void tdmaCloseSlot();
+
+/** @defgroup nrf24L01p_tdma TDMA functions
+ *  @brief   TDMA functions
+ *
+@verbatim
+ ===============================================================================
+							##### TDMA functions  #####
+ ===============================================================================
+    [..]
+    Collector timestamps each beacon with its own clock when it starts the
+    transmission; a node timestamps the IRQ of beacon in pin_change_isr0 and
+    moves its frame start there. Collector time of two beacons against node
+    time of the same beacons gives the drift of node clock, so a node can
+    keep its slot for NRF24_TDMA_MAX_MISSED frames without beacon.
+    Auto acknowledge is disabled, there is nobody to collide with.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Starts sending beacons as collector, the module is kept as receiver between beacons.
+  *
+  * @param	slots: Number of node slots in a frame, 1 to 255.
+  * @param	slotTime: Length of every slot in us, beacon slot included.
+  * @param	guard: Time at start and end of a node slot that nothing is sent, in us.
+  * @retval NONE.
+  */
+void tdmaStartCollector(unsigned char slots, unsigned int slotTime, unsigned int guard)
+{
+	tdmaStop();
+	setAutoAck(0);
+	switchRole(NRF24_RECEIVER);
+
+	tdmaSlots = slots;
+	tdmaSlotTime = slotTime;
+	tdmaGuard = guard;
+	tdmaFrameLength = (unsigned long)(slots+1) * slotTime;
+	tdmaFrameStart = getTimestamp() - tdmaFrameLength; //first beacon is sent by next tdmaService()
+	tdmaRole = NRF24_TDMA_COLLECTOR;
+}
+
+/**
+  * @brief  Starts as node, the module listens until a beacon is received.
+  *
+  * @param	slot: Slot of this node, 1 to number of slots of collector, 0 is not valid.
+  * @retval NONE.
+  */
+void tdmaStartNode(unsigned char slot)
+{
+	if(slot==0) //slot 0 belongs to beacon
+		return;
+
+	tdmaStop();
+	setAutoAck(0);
+	switchRole(NRF24_RECEIVER);
+
+	tdmaSlot = slot;
+	tdmaMissed = NRF24_TDMA_MAX_MISSED; //not synced
+	tdmaRole = NRF24_TDMA_NODE;
+}
+
+/**
+  * @brief  Stops TDMA, the module stays receiver and queued packets stay in TX queue.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void tdmaStop()
+{
+	if(tdmaSlotOpen==1)
+		tdmaCloseSlot();
+	tdmaRole = NRF24_TDMA_OFF;
+	tdmaStats.beacons = 0;
+	tdmaStats.missed = 0;
+	tdmaStats.slots = 0;
+	tdmaStats.drift = 0;
+}
+
+/**
+  * @brief  Runs the schedule, has to be called in main loop as often as possible.
+  *         Timing error of slots is the time between two calls.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void tdmaService()
+{
+	unsigned long now;
+	unsigned long offset;
+	unsigned long slotStart;
+
+	if(tdmaRole==NRF24_TDMA_COLLECTOR)
+	{
+		if(getTimestamp()-tdmaFrameStart >= tdmaFrameLength)
+			tdmaSendBeacon();
+		return;
+	}
+	if(tdmaRole!=NRF24_TDMA_NODE)
+		return;
+
+	if(bytesAvailable()>0)
+		tdmaReceiveBeacon();
+
+	now = getTimestamp();
+	if(tdmaMissed<NRF24_TDMA_MAX_MISSED && now-tdmaFrameStart >= tdmaFrameLength+tdmaGuard) //beacon should have come
+	{
+		tdmaFrameStart += tdmaFrameLength; //keep the schedule by own clock
+		tdmaFrame++;
+		tdmaMissed++;
+		tdmaStats.missed++;
+	}
+
+	if(tdmaMissed>=NRF24_TDMA_MAX_MISSED) //not synced, only listen
+	{
+		if(tdmaSlotOpen==1)
+			tdmaCloseSlot();
+		return;
+	}
+
+	offset = now - tdmaFrameStart;
+	slotStart = (unsigned long)tdmaSlot * tdmaSlotTime;
+	if(offset>=slotStart+tdmaGuard && offset<slotStart+tdmaSlotTime-tdmaGuard)
+	{
+		if(tdmaSlotOpen==0)
+		{
+			tdmaSlotOpen = 1;
+			tdmaStats.slots++;
+			switchRole(NRF24_TRANSMITTER); //queued packets are sent back to back
+		}
+	}
+	else if(tdmaSlotOpen==1)
+	{
+		tdmaCloseSlot();
+	}
+}
+
+/**
+  * @brief  Indicates if node follows the beacons of a collector, always 1 for collector.
+  *
+  * @param	NONE.
+  * @retval 1: synced, 0: waiting for beacon.
+  */
+bool tdmaSynced()
+{
+	if(tdmaRole==NRF24_TDMA_COLLECTOR)
+		return 1;
+	return tdmaRole==NRF24_TDMA_NODE && tdmaMissed<NRF24_TDMA_MAX_MISSED;
+}
+
+/**
+  * @brief  Sequence number of current frame, same on collector and synced nodes.
+  *
+  * @param	NONE.
+  * @retval Frame number.
+  */
+unsigned char tdmaGetFrame()
+{
+	return tdmaFrame;
+}
+
+/**
+  * @brief  Reads TDMA counters.
+  *
+  * @param	stats: Stores the counters.
+  * @retval NONE.
+  */
+void tdmaGetStats(NRF24_TdmaStats *stats)
+{
+	*stats = tdmaStats;
+}
+
+/**
+  * @brief  Sends beacon of a new frame and listens again.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void tdmaSendBeacon()
+{
+	char beacon[NRF24_TDMA_BEACON_SIZE];
+	unsigned long stamp;
+
+	tdmaFrameStart += tdmaFrameLength;
+	stamp = getTimestamp();
+	if(stamp-tdmaFrameStart >= tdmaFrameLength) //service was late for more than a frame
+		tdmaFrameStart = stamp;
+	tdmaFrame++;
+
+	beacon[0] = TDMA_BEACON;
+	beacon[1] = tdmaFrame;
+	beacon[2] = tdmaSlots;
+	beacon[3] = 0;
+	beacon[8] = tdmaSlotTime;
+	beacon[9] = tdmaSlotTime>>8;
+	beacon[10] = tdmaGuard;
+	beacon[11] = tdmaGuard>>8;
+
+	switchRole(NRF24_TRANSMITTER);
+	stamp = getTimestamp(); //send time, not frame start, node measures drift from NRF24_TDMA_BEACON_LATENCY after it
+	beacon[4] = stamp;
+	beacon[5] = stamp>>8;
+	beacon[6] = stamp>>16;
+	beacon[7] = stamp>>24;
+	sendData(beacon, NRF24_TDMA_BEACON_SIZE);
+	delay_us(NRF24_TDMA_BEACON_AIRTIME); //beacon has to leave before PRIM_RX is set
+	switchRole(NRF24_RECEIVER);
+	tdmaStats.beacons++;
+}
+
+/**
+  * @brief  Reads the received packet as beacon and moves frame start of node to it.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void tdmaReceiveBeacon()
+{
+	char beacon[32];
+	unsigned char size = bytesAvailable();
+	unsigned long localStart = getRxTimestamp() - NRF24_TDMA_BEACON_LATENCY;
+	unsigned long remoteStart;
+	unsigned char frames;
+	long error;
+
+	readRxFIFO(beacon, size);
+	if(size!=NRF24_TDMA_BEACON_SIZE || (unsigned char)beacon[0]!=TDMA_BEACON || (unsigned char)beacon[2]<tdmaSlot)
+		return; //not a beacon, or this slot is not in the frame
+
+	remoteStart = (unsigned char)beacon[4];
+	remoteStart |= (unsigned long)(unsigned char)beacon[5]<<8;
+	remoteStart |= (unsigned long)(unsigned char)beacon[6]<<16;
+	remoteStart |= (unsigned long)(unsigned char)beacon[7]<<24;
+	frames = beacon[1] - tdmaBeaconFrame;
+
+	tdmaSlots = beacon[2];
+	tdmaSlotTime = (unsigned char)beacon[8] | ((unsigned int)(unsigned char)beacon[9]<<8);
+	tdmaGuard = (unsigned char)beacon[10] | ((unsigned int)(unsigned char)beacon[11]<<8);
+
+	if(tdmaMissed<NRF24_TDMA_MAX_MISSED && frames>0 && frames<=NRF24_TDMA_MAX_MISSED)
+	{
+		//node time minus collector time between two beacons is drift of node clock
+		error = (long)((localStart-tdmaLocalStart) - (remoteStart-tdmaRemoteStart)) / frames;
+		tdmaStats.drift = error;
+	}
+	else
+	{
+		tdmaStats.drift = 0; //first beacon, or too many frames to trust
+	}
+	tdmaFrameLength = (unsigned long)(tdmaSlots+1) * tdmaSlotTime + tdmaStats.drift;
+
+	tdmaFrame = beacon[1];
+	tdmaFrameStart = localStart;
+	tdmaBeaconFrame = beacon[1];
+	tdmaLocalStart = localStart;
+	tdmaRemoteStart = remoteStart;
+	tdmaMissed = 0;
+	tdmaStats.beacons++;
+}
+
+/**
+  * @brief  Ends the slot of node, packets not sent yet wait in TX queue for next slot.
+  *
+  * @param	NONE.
+  * @retval NONE.
+  */
+void tdmaCloseSlot()
+{
+	tdmaSlotOpen = 0;
+	switchRole(NRF24_RECEIVER);
+}
@@ -0,0 +1,81 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_tdma.h
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Header file of TDMA slot scheduler over nrf24L01p.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NRF24L01P_TDMA_H
+#define __NRF24L01P_TDMA_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p.h>
+
+#ifndef NRF24_TDMA_BEACON_LATENCY
+#define NRF24_TDMA_BEACON_LATENCY 350 //us, from timestamp of collector to IRQ of node: upload, 130us settling and time on air at 1Mbps
+#endif
+
+#ifndef NRF24_TDMA_BEACON_AIRTIME
+#define NRF24_TDMA_BEACON_AIRTIME 200 //us, collector waits this long after CE pulse before it listens again
+#endif
+
+#ifndef NRF24_TDMA_MAX_MISSED
+#define NRF24_TDMA_MAX_MISSED 4 //frames a node keeps its slot without hearing a beacon
+#endif
+
+#define NRF24_TDMA_BEACON_SIZE 12 //bytes of beacon packet
+
+/* Exported types ------------------------------------------------------------*/
+
+/** 
+  * @brief	TDMA Role. Collector sends beacons and receives, nodes send in their slot.
+  */
+typedef enum {NRF24_TDMA_OFF, NRF24_TDMA_COLLECTOR, NRF24_TDMA_NODE} NRF24_TdmaRole;
+
+/** 
+  * @brief	TDMA Counters. Since tdmaStartCollector() or tdmaStartNode().
+  */
+typedef struct {
+    unsigned int beacons; //sent by collector or received by node
+    unsigned int missed; //beacons node has not heard in time
+    unsigned int slots; //slots node has used
+    long drift; //us per frame that the clock of node runs ahead of collector
+} NRF24_TdmaStats;
+
+/* Exported functions --------------------------------------------------------*/
+
+/* TDMA functions ************************************************************/
+void tdmaStartCollector(unsigned char slots, unsigned int slotTime, unsigned int guard);
+void tdmaStartNode(unsigned char slot);
+void tdmaStop();
+void tdmaService();
+bool tdmaSynced();
+unsigned char tdmaGetFrame();
+void tdmaGetStats(NRF24_TdmaStats *stats);
+
+#endif
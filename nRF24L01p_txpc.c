@@ -0,0 +1,236 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_txpc.c
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Closed loop TX power control over nrf24L01p driver.
+  *    
+  *         This file provides firmware functions to manage the following 
+  *         functionalities of transmitters
+  *           + TX power control functions
+  @verbatim     
+  ==============================================================================      
+                        ##### How to use this driver #####
+  ============================================================================== 
+  [..]
+   (#) Enable auto acknowledge, keep one NRF24_TxpcLink for every
+	   destination and call txpcInit() with the delivery target in percent.
+	   Links start at 0dBm.
+
+   (#) Before sending to a destination call txpcApply() of its link, then
+	   send by txEnqueue() and call txpcService() of the same link in main
+	   loop. Time and packets at each power level are in levelTime and
+	   levelPackets of the link (time needs setTimestampSource()).
+
+     *** Algorithm ***    
+     =================================== 
+    [..]
+	  Each window of NRF24_TXPC_WINDOW packets is judged:
+	  (+) Delivery below target, or more retransmits than packets: one
+	      step up at once.
+	  (+) Every packet delivered with few retransmits: good window. After
+	      downWindows good windows in a row, one step down.
+	  (+) A step up right after a step down doubles downWindows, so a link
+	      on the edge between two levels does not oscillate.
+  
+  @endverbatim
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <mega88a.h>
+#include <nRF24L01p.h>
+#include <nRF24L01p_txpc.h>
+#include <string.h>
+
+/* Private function prototypes -----------------------------------------------*/
+void txpcEndWindow(NRF24_TxpcLink *link);
+void txpcSetLevel(NRF24_TxpcLink *link, NRF24_TXPower level);
+
+/** @defgroup nrf24L01p_txpc TX power control functions
+ *  @brief   TX power control functions
+ *
+@verbatim
+ ===============================================================================
+					##### TX power control functions  #####
+ ===============================================================================
+    [..]
+    Counters of TX lanes are read like nRF24L01p_rate.c does, so packets
+    sent to a link have to be serviced before txpcApply() of another link.
+    Retransmits are only known for one packet per TX interrupt, they are
+    scaled to all packets of the window. RPD is not used: it is reset when
+    PTX leaves RX after the ACK, long before txpcService() could read it.
+    [..]
+
+@endverbatim
+  * @{
+  */
+
+/**
+  * @brief  Starts control of a link at 0dBm.
+  *
+  * @param	link: State of the link.
+  * @param	target: Delivery to keep, in percent.
+  * @retval NONE.
+  */
+void txpcInit(NRF24_TxpcLink *link, unsigned char target)
+{
+	NRF24_LaneStats high;
+	NRF24_LaneStats bulk;
+
+	memset(link, 0, sizeof(NRF24_TxpcLink));
+	link->level = NRF24_0dBm;
+	link->target = target;
+	link->downWindows = NRF24_TXPC_DOWN_WINDOWS;
+
+	getLaneStats(NRF24_LANE_HIGH, &high);
+	getLaneStats(NRF24_LANE_BULK, &bulk);
+	link->lastDelivered = high.delivered + bulk.delivered;
+	link->lastFailed = high.failed + bulk.failed;
+	link->lastRetries = high.retries + bulk.retries;
+	link->lastObserved = high.observed + bulk.observed;
+	link->lastTime = getTimestamp();
+}
+
+/**
+  * @brief  Sets TX power of the link, before packets are sent to it.
+  *
+  * @param	link: State of the link.
+  * @retval NONE.
+  */
+void txpcApply(NRF24_TxpcLink *link)
+{
+	NRF24_LaneStats high;
+	NRF24_LaneStats bulk;
+
+	setTXPower(link->level);
+
+	//packets of other links are not counted
+	getLaneStats(NRF24_LANE_HIGH, &high);
+	getLaneStats(NRF24_LANE_BULK, &bulk);
+	link->lastDelivered = high.delivered + bulk.delivered;
+	link->lastFailed = high.failed + bulk.failed;
+	link->lastRetries = high.retries + bulk.retries;
+	link->lastObserved = high.observed + bulk.observed;
+	link->lastTime = getTimestamp();
+}
+
+/**
+  * @brief  Counts results of packets sent to the link and changes its power. Has to be called in main loop.
+  *
+  * @param	link: State of the link.
+  * @retval NONE.
+  */
+void txpcService(NRF24_TxpcLink *link)
+{
+	NRF24_LaneStats high;
+	NRF24_LaneStats bulk;
+	unsigned int delivered;
+	unsigned int failed;
+	unsigned long now = getTimestamp();
+
+	getLaneStats(NRF24_LANE_HIGH, &high);
+	getLaneStats(NRF24_LANE_BULK, &bulk);
+	delivered = high.delivered + bulk.delivered - link->lastDelivered;
+	failed = high.failed + bulk.failed - link->lastFailed;
+	link->retries += high.retries + bulk.retries - link->lastRetries;
+	link->observed += high.observed + bulk.observed - link->lastObserved;
+	link->lastDelivered += delivered;
+	link->lastFailed += failed;
+	link->lastRetries = high.retries + bulk.retries;
+	link->lastObserved = high.observed + bulk.observed;
+
+	link->levelTime[link->level] += now - link->lastTime;
+	link->lastTime = now;
+	link->levelPackets[link->level] += delivered + failed;
+
+	link->delivered += delivered;
+	link->failed += failed;
+
+	if(link->delivered+link->failed >= NRF24_TXPC_WINDOW)
+		txpcEndWindow(link);
+}
+
+/**
+  * @brief  Decides about power of the link at end of a window.
+  *
+  * @param	link: State of the link.
+  * @retval NONE.
+  */
+void txpcEndWindow(NRF24_TxpcLink *link)
+{
+	unsigned int packets = link->delivered + link->failed;
+	unsigned char delivery = ((unsigned long)link->delivered*100) / packets;
+	unsigned long retries = link->retries;
+
+	if(link->observed>0 && link->observed<packets) //only last packet of each TX interrupt is observed
+		retries = retries * packets / link->observed;
+
+	if(delivery<link->target || retries>packets) //link is weak
+	{
+		link->goodWindows = 0;
+		if(link->level<NRF24_0dBm)
+		{
+			if(link->triedDown==1 && link->downWindows<NRF24_TXPC_MAX_DOWN_WINDOWS)
+				link->downWindows *= 2; //that level was not enough, wait longer before trying again
+			txpcSetLevel(link, link->level+1);
+		}
+	}
+	else if(link->failed==0 && retries<=packets/8) //link has margin
+	{
+		link->goodWindows++;
+		if(link->goodWindows>=link->downWindows && link->level>NRF24_m18dBm)
+		{
+			link->goodWindows = 0;
+			txpcSetLevel(link, link->level-1);
+			link->triedDown = 1;
+		}
+	}
+	else
+	{
+		link->goodWindows = 0;
+		link->triedDown = 0; //current level is stable
+	}
+
+	link->delivered = 0;
+	link->failed = 0;
+	link->retries = 0;
+	link->observed = 0;
+}
+
+/**
+  * @brief  Changes TX power of the link.
+  *
+  * @param	link: State of the link.
+  * @param	level: New power level.
+  * @retval NONE.
+  */
+void txpcSetLevel(NRF24_TxpcLink *link, NRF24_TXPower level)
+{
+	link->level = level;
+	link->triedDown = 0;
+	link->changes++;
+	setTXPower(level);
+}
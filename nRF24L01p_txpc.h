@@ -0,0 +1,83 @@
+/**
+  ******************************************************************************
+  * @file    nRF24L01p_txpc.h
+  * @author  Saleh Mehdikhani <saleh.mehdikhani@gmail.com>, www.nooby.ir
+  * @version V1.0.0
+  * @date    18-Oct-2026
+  * @brief   Header file of closed loop TX power control over nrf24L01p.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (C) 2016 Saleh Mehdikhani <saleh.mehdikhani@gmail.com>
+  *
+  * This program is free software; you can redistribute it and/or
+  * modify it under the terms of the GNU General Public License
+  * version 3 as published by the Free Software Foundation.
+  * https://www.gnu.org/licenses/gpl-3.0.en.html
+  *
+  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NRF24L01P_TXPC_H
+#define __NRF24L01P_TXPC_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <nRF24L01p.h>
+
+#ifndef NRF24_TXPC_WINDOW
+#define NRF24_TXPC_WINDOW 32 //packets per decision
+#endif
+
+#ifndef NRF24_TXPC_DOWN_WINDOWS
+#define NRF24_TXPC_DOWN_WINDOWS 4 //good windows before one step down, doubled each time a step down fails
+#endif
+
+#ifndef NRF24_TXPC_MAX_DOWN_WINDOWS
+#define NRF24_TXPC_MAX_DOWN_WINDOWS 64
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+
+/** 
+  * @brief	Power Control Link. State of one link, the application keeps one per destination.
+  */
+typedef struct {
+    NRF24_TXPower level; //current TX power of the link
+    unsigned char target; //delivery in percent the link has to keep
+    unsigned int delivered; //counters of current window
+    unsigned int failed;
+    unsigned int retries; //of observed packets, see NRF24_LaneStats
+    unsigned int observed; //packets whose retransmits are known
+    unsigned char goodWindows; //windows in a row that allow a step down
+    unsigned char downWindows; //good windows needed for next step down
+    bool triedDown; //last change was a step down
+    unsigned int lastDelivered; //lane counters at last txpcService()
+    unsigned int lastFailed;
+    unsigned int lastRetries;
+    unsigned int lastObserved;
+    unsigned long lastTime; //time of last txpcService()
+    unsigned long levelTime[4]; //us spent at each level, indexed by NRF24_TXPower
+    unsigned int levelPackets[4]; //packets sent at each level
+    unsigned int changes; //power changes
+} NRF24_TxpcLink;
+
+/* Exported functions --------------------------------------------------------*/
+
+/* TX power control functions ************************************************/
+void txpcInit(NRF24_TxpcLink *link, unsigned char target);
+void txpcApply(NRF24_TxpcLink *link);
+void txpcService(NRF24_TxpcLink *link);
+
+#endif